@@ -0,0 +1,329 @@
+#include "Server.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <csignal>
+#include <fstream>
+
+/*
+ * Message throughput of a running server, to compare reactor counts.
+ *
+ * Opens the connections, registers them, then keeps WINDOW PINGs in flight
+ * on each and counts the PONGs for the given time. Run the server with
+ * "reactors N" and, so that neither limits the load, "flood_rate 0" and a
+ * class allowing the clones, e.g. "class 127.0.0.0/8 1000 1000".
+ *
+ * Given event backends, it compares them under the same load instead: for
+ * each one in turn it starts the server itself, in a child process with
+ * src/config/ircserv.config plus "reactor <backend>", "flood_rate 0" and a
+ * class for the clones, runs the load, stops the server with SIGINT and
+ * reads its rusage. Next to the rate it prints the server's user and
+ * system CPU time per message, all PONGs counted; the system time is what
+ * the syscalls of the backend cost.
+ *
+ * Usage: bench/load_bench <port> <password> [connections] [seconds] [threads]
+ * 			[uring|epoll|poll ...]
+ */
+
+bool server_shutdown = false;
+
+#define WINDOW 16	// PINGs in flight per connection
+
+struct load_conn
+{
+	int			fd;
+	bool		registered;
+	size_t		in_flight;
+	std::string	input;
+};
+
+static std::atomic<bool>	counting(false);
+static std::atomic<bool>	stopping(false);
+static std::atomic<size_t>	registered(0);
+static std::atomic<size_t>	pongs(0);
+static std::atomic<size_t>	served(0);	// PONGs, warm up included
+
+static int	connectTo(int port)
+{
+	struct sockaddr_in	addr;
+	int					fd = socket(AF_INET, SOCK_STREAM, 0);
+	int					one = 1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (fd == FAILURE || connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == FAILURE)
+	{
+		std::perror("connect");
+		std::exit(1);
+	}
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	return (fd);
+}
+
+static void	sendAll(int fd, std::string const &data)
+{
+	size_t	sent = 0;
+	ssize_t	len;
+
+	while (sent < data.size())
+	{
+		if ((len = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL)) == FAILURE)
+		{
+			std::perror("send");
+			std::exit(1);
+		}
+		sent += len;
+	}
+}
+
+static void	refill(load_conn &conn)
+{
+	std::string	pings;
+
+	for (; conn.in_flight < WINDOW; conn.in_flight++)
+		pings += "PING :load\r\n";
+	if (pings.empty() == false)
+		sendAll(conn.fd, pings);
+}
+
+/**
+ * @brief Counts the replies of one connection, and sends a PING for each
+ * 		  PONG once it is registered.
+ */
+static void	handleInput(load_conn &conn)
+{
+	char	buf[16384];
+	ssize_t	len;
+	size_t	eol;
+
+	while ((len = recv(conn.fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+		conn.input.append(buf, len);
+	if (len == 0)
+	{
+		std::fprintf(stderr, "connection closed by the server\n");
+		std::exit(1);
+	}
+	while ((eol = conn.input.find("\r\n")) != std::string::npos)
+	{
+		std::string	line = conn.input.substr(0, eol);
+
+		conn.input.erase(0, eol + 2);
+		if (conn.registered == false && line.find(" 001 ") != std::string::npos)
+		{
+			conn.registered = true;
+			registered++;
+		}
+		else if (line.find(" PONG ") != std::string::npos && conn.in_flight > 0)
+		{
+			conn.in_flight--;
+			served++;
+			if (counting)
+				pongs++;
+		}
+	}
+	if (conn.registered && stopping == false)
+		refill(conn);
+}
+
+static void	runThread(int port, std::string const &password, size_t first, size_t count)
+{
+	std::vector<load_conn>	conns(count);
+	int						epfd = epoll_create1(0);
+	struct epoll_event		events[64];
+	int						ready;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		struct epoll_event	ev;
+		char				nick[16];
+
+		conns[i].fd = connectTo(port);
+		conns[i].registered = false;
+		conns[i].in_flight = 0;
+		ev.events = EPOLLIN;
+		ev.data.u64 = i;
+		epoll_ctl(epfd, EPOLL_CTL_ADD, conns[i].fd, &ev);
+		std::snprintf(nick, sizeof(nick), "ld%05zu", first + i);
+		sendAll(conns[i].fd, "PASS " + password + "\r\nNICK " + nick + "\r\nUSER " + nick + " 0 * :" + nick + "\r\n");
+	}
+	while (stopping == false)
+	{
+		if ((ready = epoll_wait(epfd, events, 64, 100)) == FAILURE && errno != EINTR)
+			break ;
+		for (int i = 0; i < ready; i++)
+			handleInput(conns[events[i].data.u64]);
+	}
+	for (size_t i = 0; i < count; i++)
+		close(conns[i].fd);
+	close(epfd);
+}
+
+/**
+ * @brief Runs the load on a server already listening.
+ *
+ * @return size_t The PONGs counted in the given time
+ */
+static size_t	runLoad(int port, std::string const &password, size_t total, double seconds, size_t threads)
+{
+	std::vector<std::thread>	workers;
+
+	counting = false;
+	stopping = false;
+	registered = 0;
+	pongs = 0;
+	served = 0;
+	for (size_t i = 0; i < threads; i++)
+	{
+		size_t	first = total * i / threads;
+
+		workers.push_back(std::thread(runThread, port, password, first, total * (i + 1) / threads - first));
+	}
+	while (registered < total)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	std::this_thread::sleep_for(std::chrono::milliseconds(500)); // warm up
+	counting = true;
+	std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+	counting = false;
+	stopping = true;
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+	return (pongs.load());
+}
+
+static void	stopServer(int signal)
+{
+	(void)signal;
+	server_shutdown = true;
+}
+
+/**
+ * @brief Runs a server with the given backend in a child process, as main()
+ * 		  of the server does, until SIGINT. Its output goes to /dev/null,
+ * 		  its errors (e.g. io_uring falling back to epoll) are kept.
+ *
+ * @return pid_t The child, FAILURE if fork() failed
+ */
+static pid_t	startServer(std::string const &port, std::string const &password, std::string const &backend, size_t clones)
+{
+	char	settings[] = "/tmp/load_bench.XXXXXX";
+	pid_t	pid;
+
+	std::fflush(stdout); // or the child writes what is buffered again
+	pid = fork();
+
+	if (pid != 0)
+		return (pid);
+	if (std::freopen("/dev/null", "w", stdout) == NULL)
+		_exit(1);
+	signal(SIGINT, stopServer);
+	{
+		time_t			rawtime = time(NULL);
+		Server			server(port, password, localtime(&rawtime));
+		int				fd = mkstemp(settings);
+		std::ofstream	overrides(settings);
+
+		close(fd);
+		overrides << "reactor " << backend << "\nflood_rate 0\n"
+			<< "class 127.0.0.0/8 " << clones << ' ' << clones << "\nmax_clients " << clones + 16 << std::endl;
+		server.readSettingsFile(SETTINGS_FILE);
+		server.readSettingsFile(settings);
+		unlink(settings);
+		server.setHints();
+		if (server.fillServinfo(const_cast<char *>(port.c_str())) == FAILURE || server.launchServer() == FAILURE)
+			_exit(1);
+		server.manageServerLoop();
+	}
+	_exit(0);
+}
+
+/**
+ * @brief Waits up to 5 s for the child to listen on port.
+ */
+static bool	waitForServer(pid_t pid, int port)
+{
+	struct sockaddr_in	addr;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	for (int tries = 0; tries < 500; tries++)
+	{
+		int	fd = socket(AF_INET, SOCK_STREAM, 0);
+		int	status = connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+
+		close(fd);
+		if (status == SUCCESS)
+			return (true);
+		if (waitpid(pid, NULL, WNOHANG) == pid)
+			return (false);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	return (false);
+}
+
+static double	cpuMicroseconds(struct timeval const &time)
+{
+	return (time.tv_sec * 1e6 + time.tv_usec);
+}
+
+/**
+ * @brief The same load on a server per backend, one after the other.
+ */
+static int	compareBackends(int argc, char **argv, size_t total, double seconds, size_t threads)
+{
+	int	port = std::atoi(argv[1]);
+
+	std::printf("%zu connections, %zu client threads, %.1f s per backend\n", total, threads, seconds);
+	std::printf("%-8s %12s %14s %14s\n", "backend", "msg/s", "user us/msg", "sys us/msg");
+	for (int i = 6; i < argc; i++) // the backends, after [threads]
+	{
+		pid_t			pid = startServer(argv[1], argv[2], argv[i], total);
+		struct rusage	usage;
+		int				status;
+		size_t			counted;
+
+		if (pid == FAILURE || waitForServer(pid, port) == false)
+		{
+			std::fprintf(stderr, "%s: the server did not start\n", argv[i]);
+			return (1);
+		}
+		counted = runLoad(port, argv[2], total, seconds, threads);
+		kill(pid, SIGINT);
+		if (wait4(pid, &status, 0, &usage) == FAILURE || served == 0)
+			return (1);
+		std::printf("%-8s %12.0f %14.2f %14.2f\n", argv[i], counted / seconds,
+			cpuMicroseconds(usage.ru_utime) / served, cpuMicroseconds(usage.ru_stime) / served);
+	}
+	return (0);
+}
+
+int	main(int argc, char **argv)
+{
+	if (argc < 3)
+	{
+		std::fprintf(stderr, "usage: %s <port> <password> [connections] [seconds] [threads] [uring|epoll|poll ...]\n", argv[0]);
+		return (1);
+	}
+	int		port = std::atoi(argv[1]);
+	size_t	total = (argc > 3 ? strtoul(argv[3], NULL, 10) : 200);
+	double	seconds = (argc > 4 ? std::atof(argv[4]) : 5);
+	size_t	threads = (argc > 5 ? strtoul(argv[5], NULL, 10) : 2);
+
+	threads = std::max<size_t>(1, std::min(threads, total));
+	if (argc > 6)
+		return (compareBackends(argc, argv, total, seconds, threads));
+	runLoad(port, argv[2], total, seconds, threads);
+	std::printf("%zu connections, %zu client threads, %.1f s: %zu PONGs, %.0f msg/s\n",
+		total, threads, seconds, pongs.load(), pongs.load() / seconds);
+	return (0);
+}
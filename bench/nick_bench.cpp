@@ -0,0 +1,79 @@
+#include "ClientTable.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+/*
+ * Nickname lookups with many users connected.
+ *
+ * "scan" is how NICK, PRIVMSG and KILL used to find a nickname: a walk
+ * over every client comparing getNickname(). "index" is
+ * ClientTable::findByNickname(), the casemapped hash index they use now.
+ * Half the lookups hit a connected user (PRIVMSG), half miss (a free
+ * nickname on NICK).
+ *
+ * Usage: bench/nick_bench [users] [lookups]
+ */
+
+bool server_shutdown = false;
+
+static std::string	nickname(size_t i)
+{
+	char	buf[16];
+
+	std::snprintf(buf, sizeof(buf), "u%06zu", i % 1000000);
+	return (buf);
+}
+
+static Client	*scan(ClientTable &clients, std::string const &name)
+{
+	for (ClientTable::iterator it = clients.begin(); it != clients.end(); it++)
+	{
+		if ((*it)->getNickname() == name)
+			return (*it);
+	}
+	return (NULL);
+}
+
+template <typename F>
+static double	nsPerLookup(std::vector<std::string> const &names, size_t count, F lookup)
+{
+	std::chrono::steady_clock::time_point	start = std::chrono::steady_clock::now();
+	size_t									found = 0;
+
+	for (size_t i = 0; i < count; i++)
+		found += (lookup(names[i % names.size()]) != NULL);
+	std::chrono::duration<double, std::nano>	elapsed = std::chrono::steady_clock::now() - start;
+	if (found != (count + 1) / 2)
+		std::printf("(found %zu of %zu)\n", found, count);
+	return (elapsed.count() / count);
+}
+
+int	main(int argc, char **argv)
+{
+	size_t						users = (argc > 1 ? strtoul(argv[1], NULL, 10) : 100000);
+	size_t						lookups = (argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000);
+	ClientTable					clients;
+	std::vector<std::string>	names;
+	std::streambuf				*out = std::cout.rdbuf(NULL); // Client logs its constructor
+
+	std::chrono::steady_clock::time_point	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < users; i++)
+		clients.setNickname(clients.insert(i + 4), nickname(i));
+	std::chrono::duration<double, std::nano>	fill = std::chrono::steady_clock::now() - start;
+
+	std::srand(42);
+	for (size_t i = 0; i < 4096; i++)
+	{
+		names.push_back(nickname(std::rand() % users));		// hit
+		names.push_back(nickname(users + std::rand() % 1000));	// miss
+	}
+	std::printf("%zu users, insert + setNickname %.1f ns each\n", users, fill.count() / users);
+	std::printf("scan   %12.1f ns/lookup\n", nsPerLookup(names, std::min<size_t>(lookups, 2000),
+		[&clients](std::string const &name) { return (scan(clients, name)); }));
+	std::printf("index  %12.1f ns/lookup\n", nsPerLookup(names, lookups,
+		[&clients](std::string const &name) { return (clients.findByNickname(name)); }));
+	std::cout.rdbuf(out);
+	std::cout.setstate(std::ios::badbit); // the destructors log too
+	return (0);
+}
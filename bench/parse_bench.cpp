@@ -0,0 +1,127 @@
+#include "Irc.hpp"
+#include "Commands.hpp"
+#include <chrono>
+#include <cstdio>
+
+/*
+ * Parse cost per line, before and after the single-pass tokenizer.
+ *
+ * "before" is parseCommand as it was: a copy of the line, find() for the
+ * command name, a copy of the rest, and the name compared to each command.
+ * "after" is what parseMessage does now: tokenizeMessage(), fillCommand()
+ * for the handlers still reading cmd_struct::message, and lookupCommand().
+ *
+ * Usage: bench/parse_bench [lines]
+ */
+
+bool server_shutdown = false;
+
+static const char	*legacy_commands[] = {
+	"INVITE", "JOIN", "KICK", "KILL", "LIST", "MODE", "NAMES", "NICK",
+	"NOTICE", "OPER", "PART", "PING", "PRIVMSG", "QUIT", "TOPIC", "USER"
+};
+
+static int	legacyParseCommand(std::string cmd_line, cmd_struct &cmd_infos)
+{
+	std::string copy = cmd_line;
+	if (cmd_line[0] == ':')
+		copy.erase(0, copy.find_first_of(' '));
+	cmd_infos.name.insert(0, copy, 0, copy.find_first_of(' '));
+
+	size_t prefix_length = cmd_line.find(cmd_infos.name, 0);
+	cmd_infos.prefix.assign(cmd_line, 0, prefix_length);
+
+	size_t msg_beginning = cmd_line.find(cmd_infos.name, 0) + cmd_infos.name.length();
+	cmd_infos.message = cmd_line.substr(msg_beginning, std::string::npos);
+	if (cmd_infos.message.find("\r") != std::string::npos)
+		cmd_infos.message.erase(cmd_infos.message.find("\r"), 1);
+
+	for (size_t i = 0; i < cmd_infos.name.size(); i++)
+		cmd_infos.name[i] = std::toupper(cmd_infos.name[i]);
+	return (SUCCESS);
+}
+
+static size_t	legacyFindCommand(std::string const &name)
+{
+	std::string	valid_cmds[16];
+	size_t		index = 0;
+
+	for (size_t i = 0; i < 16; i++)
+		valid_cmds[i] = legacy_commands[i];
+	while (index < 16 && name != valid_cmds[index])
+		index++;
+	return (index);
+}
+
+static std::vector<std::string>	makeLines(size_t count)
+{
+	static const char	*samples[] = {
+		"PRIVMSG #general :hello everyone, how is it going today?",
+		":alice!alice@host.example.org PRIVMSG bob :are you there?",
+		"PING :1700000000123",
+		"JOIN #general,#random key1,key2",
+		"MODE #general +o bob",
+		"@time=2024-01-01T00:00:00.000Z;msgid=abc :carol NOTICE #general :restarting in 5",
+		"TOPIC #general :Welcome to the general channel",
+		"KICK #general dave :flooding"
+	};
+	std::vector<std::string>	lines;
+
+	for (size_t i = 0; i < count; i++)
+		lines.push_back(samples[i % (sizeof(samples) / sizeof(*samples))]);
+	return (lines);
+}
+
+template <typename F>
+static double	nsPerLine(std::vector<std::string> const &lines, F parse)
+{
+	std::chrono::steady_clock::time_point	start = std::chrono::steady_clock::now();
+	size_t									sink = 0;
+
+	for (size_t i = 0; i < lines.size(); i++)
+		sink += parse(lines[i]);
+	std::chrono::duration<double, std::nano>	elapsed = std::chrono::steady_clock::now() - start;
+	if (sink == 0)
+		std::printf("(nothing parsed)\n");
+	return (elapsed.count() / lines.size());
+}
+
+static size_t	before(std::string const &line)
+{
+	std::string	copy(line.data(), line.size()); // the line as it was cut out of the buffer
+	cmd_struct	cmd_infos;
+
+	legacyParseCommand(copy, cmd_infos);
+	return (legacyFindCommand(cmd_infos.name) + 1);
+}
+
+static size_t	after(std::string const &line)
+{
+	str_view	view(line.data(), line.size());
+	cmd_struct	cmd_infos;
+
+	if (tokenizeMessage(view, cmd_infos.tokens) == FAILURE)
+		return (0);
+	fillCommand(view, cmd_infos);
+	return (lookupCommand(cmd_infos.tokens.command) != NULL);
+}
+
+static size_t	tokenizeOnly(std::string const &line)
+{
+	irc_message	msg;
+
+	return (tokenizeMessage(str_view(line.data(), line.size()), msg) == SUCCESS);
+}
+
+int	main(int argc, char **argv)
+{
+	size_t						count = (argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000);
+	std::vector<std::string>	lines = makeLines(count);
+
+	nsPerLine(lines, after); // warm up
+	std::printf("%zu lines\n", count);
+	std::printf("before (parseCommand + name search)        %8.1f ns/line\n", nsPerLine(lines, before));
+	std::printf("after  (tokenize + fillCommand + lookup)   %8.1f ns/line\n", nsPerLine(lines, after));
+	std::printf("       (tokenizeMessage alone)             %8.1f ns/line\n", nsPerLine(lines, tokenizeOnly));
+	return (0);
+}
@@ -0,0 +1,122 @@
+#include "Client.hpp"
+#include "TimerWheel.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+/*
+ * Input timelines under 1 to 16 producers.
+ *
+ * Each producer thread stands for a reactor shard reading one client: it
+ * writes bytes into the client's read buffer as recv() would, a span at a
+ * time, and frames the complete lines into its timeline
+ * (Client::frameInput). One consumer, the core, takes the lines of every
+ * client in turn with frontInput() / popInput(). A producer whose
+ * timeline or read buffer is full yields until the core pops, as a shard
+ * stalls until SHARD_RESUME. The rate is the number of lines through the
+ * timelines per second, all producers together.
+ *
+ * Usage: bench/timeline_bench [lines per producer] [max producers]
+ */
+
+bool server_shutdown = false;
+
+static const char	traffic[] =
+	"PRIVMSG #bench :hello there\r\n"
+	"PING :lag-check\r\n"
+	"@time=2024-01-01T00:00:00Z PRIVMSG alice :a somewhat longer line, with a tag\r\n"
+	"MODE #bench +o alice\r\n";
+
+static void	produce(Client *client, size_t lines, std::atomic<size_t> *done)
+{
+	RingBuffer	&readbuf = client->getReadBuffer();
+	size_t		framed = 0;
+	size_t		offset = 0;
+	bool		full;
+	char		*span;
+	size_t		span_len;
+
+	while (framed < lines)
+	{
+		while ((span_len = readbuf.writeSpan(&span)) > 0) // recv() into the free space
+		{
+			for (size_t i = 0; i < span_len; i++)
+			{
+				span[i] = traffic[offset];
+				offset = (offset + 1) % (sizeof(traffic) - 1);
+			}
+			readbuf.commit(span_len);
+		}
+		framed += client->frameInput(monotonicMs(), full);
+		if (full)
+			std::this_thread::yield(); // stalled until the core runs lines
+	}
+	done->fetch_add(1, std::memory_order_release);
+}
+
+static double	run(size_t producers, size_t lines, size_t &consumed)
+{
+	std::vector<Client*>		clients;
+	std::vector<std::thread>	threads;
+	std::atomic<size_t>			done(0);
+	timeline_entry				entry;
+
+	for (size_t i = 0; i < producers; i++)
+	{
+		clients.push_back(new Client(i + 4));
+		clients.back()->setShard(0); // the core pops, the producer releases
+	}
+	consumed = 0;
+
+	std::chrono::steady_clock::time_point	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < producers; i++)
+		threads.push_back(std::thread(produce, clients[i], lines, &done));
+	while (true)
+	{
+		bool	finished = (done.load(std::memory_order_acquire) == producers);
+		size_t	taken = 0;
+
+		for (size_t i = 0; i < producers; i++)
+		{
+			while (clients[i]->frontInput(entry))
+			{
+				taken++;
+				clients[i]->popInput();
+			}
+		}
+		consumed += taken;
+		if (finished && taken == 0)
+			break ;
+		if (taken == 0)
+			std::this_thread::yield();
+	}
+	std::chrono::duration<double>	elapsed = std::chrono::steady_clock::now() - start;
+
+	for (size_t i = 0; i < producers; i++)
+	{
+		threads[i].join();
+		delete clients[i];
+	}
+	return (elapsed.count());
+}
+
+int	main(int argc, char **argv)
+{
+	size_t			lines = (argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000);
+	size_t			max_producers = (argc > 2 ? strtoul(argv[2], NULL, 10) : 16);
+	std::streambuf	*out = std::cout.rdbuf(NULL); // Client logs its constructor
+
+	std::printf("%zu lines per producer, %u hardware threads\n", lines, std::thread::hardware_concurrency());
+	std::printf("producers %14s %12s\n", "lines/s", "ns/line");
+	for (size_t producers = 1; producers <= max_producers; producers *= 2)
+	{
+		size_t	consumed;
+		double	seconds = run(producers, lines, consumed);
+
+		std::printf("%9zu %14.0f %12.1f\n", producers, consumed / seconds, seconds * 1e9 / consumed);
+	}
+	std::cout.rdbuf(out);
+	return (0);
+}
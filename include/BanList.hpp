@@ -0,0 +1,59 @@
+#ifndef BANLIST_HPP
+# define BANLIST_HPP
+
+# include "Hostmask.hpp"
+# include <unordered_map>
+# include <stdint.h>
+
+/**
+ * @brief Ban masks of a channel, each with an optional expiry.
+ *
+ * 	Each mask is compiled once when added, and filed under its most
+ * 	selective literal part (host, then nick, then user): checking a client
+ * 	only looks at the masks filed under its own host, nick and user, plus
+ * 	the few masks that are wildcards in all three parts.
+ *
+ * 	Expiries are on the server clock (Server::getNow(), in milliseconds):
+ * 	every method that looks at them is given the current time.
+ *
+ * 	getVersion() changes whenever the set of effective bans changes (added,
+ * 	removed or expired), so the result of a check can be cached against it.
+ */
+class BanList
+{
+	private:
+		struct ban
+		{
+			Hostmask	mask;
+			uint64_t	expiry;		// 0 if never
+			int			bucket;		// Hostmask part it is filed under, PARTS if none
+		};
+		typedef std::unordered_multimap<std::string, ban*>	bucket_map;
+
+		std::map<std::string, ban>	_bans;		// by normalized mask
+		bucket_map					_buckets[Hostmask::PARTS];
+		std::vector<ban*>			_wildcards;
+		unsigned					_version;
+		uint64_t					_next_expiry;	// earliest expiry, 0 if none
+
+		bool	insert(std::string const &mask, uint64_t expiry);
+		void	unindex(ban *entry);
+		bool	matchBucket(int part, std::string const nuh[], uint64_t now) const;
+
+	public:
+		BanList();
+		BanList(BanList const &src);
+		~BanList();
+
+		BanList &operator=(BanList const &src);
+
+		bool						add(std::string const &mask, uint64_t now, time_t lifetime = 0);
+		bool						remove(std::string const &mask);
+		bool						matches(std::string const &nick, std::string const &user, std::string const &host, uint64_t now) const;
+		void						sweep(uint64_t now);
+		unsigned					getVersion(uint64_t now);
+		std::vector<std::string>	getMasks(uint64_t now) const;
+		size_t						size() const;
+};
+
+#endif
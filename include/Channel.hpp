@@ -2,20 +2,43 @@
 #define CHANNEL_HPP
 #include "Irc.hpp"
 #include "Client.hpp"
+#include "ClientTable.hpp"
+#include "Modes.hpp"
+#include "ExpiringSet.hpp"
+#include "BanList.hpp"
 
 class	Client;
 
+/* Per-channel flags of a member */
+# define MEMBER_OPERATOR	0x1
+# define MEMBER_BANNED		0x2		// cached result of the last ban check
+
+/**
+ * @brief What a channel knows about one of its members: which connection it
+ * 		  is, and its status in this channel only. The Client itself stays in
+ * 		  the server's ClientTable.
+ */
+struct channel_member
+{
+	client_handle	handle;
+	unsigned char	flags;
+	unsigned		ban_version;	// BanList version MEMBER_BANNED was computed for, 0 if none
+};
+
+/* Members of a channel, by fd */
+typedef std::map<int, channel_member>	member_list;
+
 class Channel
 {
 	private:
-		std::map<std::string, Client>	_clientList;
-		std::vector<std::string>		_kicked_users;
-		std::vector<std::string>		_banned_users;
-		std::vector<std::string>		_operators;
+		member_list						_members;
+		size_t							_operator_count;
+		ExpiringSet						_kicked_users;	// casemapped nicknames
+		BanList							_bans;
 		std::string 					_name;
 		std::string						_operatorPassword;
 		std::string						_topic;
-		std::string						_mode;
+		mode_set						_mode;
 		std::string						_channel_password;
 	public:
 		Channel(std::string const &name);
@@ -24,34 +47,34 @@ class Channel
 		/* Accessors */
 		std::string&					getName();
 		std::string&					getTopic() ;
-		std::string&					getMode() ;
 		std::string&					getChannelPassword() ;
-		std::vector<std::string>&		getOperators() ;
-		std::vector<std::string>&		getKickedUsers() ;
-		std::vector<std::string>&		getBannedUsers() ;
-		std::map <std::string, Client>&	getClientList();
+		member_list&					getMembers();
 		void							setTopic(std::string& newTopic);
 		void							setChannelPassword(std::string password);
-		bool							doesClientExist(std::string &clientName);
+		bool							doesClientExist(int client_fd);
 		/* Manage client in Channel */
-		void							addClientToChannel(Client &client);
+		void							addClientToChannel(client_handle handle);
 		void							printClientList();
-		void							removeClientFromChannel(std::string &clientName);
+		void							removeClientFromChannel(int client_fd);
 		/* Operators */
-		void							addFirstOperator(std::string operatorName);
-		void							removeOperator(std::string operatoName);
-		// void							addOperator(std::string operatorName);
-		bool							isOperator(std::string &operatorName);
-		void							printOperators(void);
+		void							addFirstOperator(int client_fd);
+		void							setOperator(int client_fd, bool is_operator);
+		bool							isOperator(int client_fd);
 		/* Modes */
-		void							addMode(std::string const mode);
-		void							removeMode(std::string const mode);
+		bool							hasMode(mode_set mode) const;
+		void							addMode(mode_set mode);
+		void							removeMode(mode_set mode);
+		std::string						getModeString() const;
 		void							removeChannelPassword();
 		/* Client status */
-		void							addToKicked(std::string &banned_name);
-		void							addToBanned(std::string &banned_name);
-		void							removeFromBanned(std::string &banned_name);
-		bool							isBanned(std::string &banned_name);
+		void							addToKicked(std::string &kicked_name, uint64_t now, time_t lifetime = 0);
+		bool							isKicked(std::string &kicked_name, uint64_t now);
+		void							sweepExpired(uint64_t now);
+		bool							addToBanned(std::string &banned_mask, uint64_t now, time_t lifetime = 0);
+		bool							removeFromBanned(std::string &banned_mask);
+		bool							isBanned(Client &client, uint64_t now);
+		void							forgetBanCheck(int client_fd);
+		std::vector<std::string>		getBanMasks(uint64_t now) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef CHANNELWORKER_HPP
+# define CHANNELWORKER_HPP
+
+# include "ClientTable.hpp"
+# include "Mailbox.hpp"
+# include <thread>
+
+class Server;
+
+/* A channel command handed to the worker owning its channel */
+struct channel_job
+{
+	client_handle	client;
+	std::string		line;	// copied: the timeline it came from is popped meanwhile
+	bool			failed;	// the handler threw, the core disconnects the client
+};
+
+/* What the workers of a batch report to the core */
+struct channel_batch
+{
+	MpscQueue<channel_job>	done;
+	std::atomic<size_t>		left;		// jobs handed over and not done yet
+	int						event_fd;	// written when left drops to 0
+};
+
+/**
+ * @brief Thread running the commands aimed at the channels it owns (see
+ * 		  Server::channelOwner): JOIN, PART, PRIVMSG, MODE, TOPIC and KICK.
+ *
+ * 	The core gathers the jobs of a loop iteration, then hands each worker
+ * 	its share through a lock-free queue and waits for the whole batch (see
+ * 	Server::runChannelJobs). While it waits, a channel is only touched by
+ * 	its owner, so busy channels owned by different workers run in parallel;
+ * 	nicknames and the channel index are only read. What is shared between
+ * 	the channels is locked: the send queues and the channel lists of the
+ * 	clients. The socket side of the replies is left to the core, which owns
+ * 	the reactor (see deferWrite).
+ *
+ * 	The same threads run the slices of the heavy commands while the core
+ * 	waits for events (see TaskScheduler), and post each one back to it.
+ */
+class ChannelWorker
+{
+	private:
+		unsigned					_index;
+		Server						&_server;
+		channel_batch				&_batch;
+		Mailbox						&_core;
+		MpscQueue<channel_job>		_jobs;
+		int							_wake_fd;
+		std::vector<client_handle>	_deferred_writes;
+		std::thread					_thread;
+		std::atomic<bool>			_running;
+
+		static thread_local ChannelWorker	*_current;
+
+		ChannelWorker(ChannelWorker const &src);
+		ChannelWorker &operator=(ChannelWorker const &src);
+
+		void	run();
+		void	runJob(channel_job &job);
+		void	runTasks();
+		void	reportDone();
+
+	public:
+		ChannelWorker(unsigned index, Server &server, channel_batch &batch, Mailbox &core);
+		~ChannelWorker();
+
+		static ChannelWorker	*current();
+
+		int		start();
+		void	stop();
+		void	push(channel_job const &job);
+		void	wake();
+		void	deferWrite(Client &client);
+		std::vector<client_handle>	&getDeferredWrites();
+};
+
+#endif
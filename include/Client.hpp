@@ -2,23 +2,69 @@
 # define CLIENT_HPP
 
 #include "Irc.hpp"
+#include "RingBuffer.hpp"
+#include "InputTimeline.hpp"
+#include "Modes.hpp"
+#include "IpAddress.hpp"
+#include "LagCompensation.hpp"
+#include <deque>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <sys/uio.h>
+#include <stdint.h>
+
+/* Serialized reply, shared by every send queue it has been fanned out to */
+typedef std::shared_ptr<const std::string>	shared_buffer;
 
 class Client
 {
 	private:
 		int				_client_fd;
-		std::string		_readbuf;
-		std::string		_sendbuf;
+		int				_shard;			// reactor thread owning the socket, -1 without threads
+		RingBuffer		_readbuf;
+		InputTimeline	_timeline;		// lines framed out of _readbuf, waiting to run
+		std::mutex		_sendq_lock;	// the shard writes the queue the core fills
+		std::deque<shared_buffer>	_sendq;
+		size_t			_send_offset;	// bytes of _sendq.front() already written to the socket
+		size_t			_sendq_size;	// bytes queued and not written yet
+		size_t			_sendq_peak;	// highest _sendq_size so far
+		size_t			_sendq_soft;	// above it, bulk replies are cut short
+		size_t			_sendq_hard;	// above it, the client is disconnected
+		bool			_sendq_exceeded;
+		bool			_write_interest;
 		bool			_to_deconnect;
 		std::string		_nickname;
 		std::string		_old_nickname;
 		std::string		_username;
 		std::string		_realname;
-		std::string		_mode;
+		ip_address		_address;		// of the peer, as returned by getpeername()
+		std::string		_hostname;		// _address in text form, for hostmasks
+		mode_set		_mode;
+		std::set<std::string>	_joined_channels;	// names of the channels it is a member of
+		std::mutex		_joined_lock;	// channel workers may change it from two channels at once
 		bool			_connexion_password;
 		bool			_registrationDone;
 		bool			_welcomeSent;
 		bool			_hasAllInfo;
+		uint64_t		_last_activity;	// coarse clock (ms) of the last bytes received
+		uint64_t		_ping_sent;		// when the server PINGed it, 0 if not waiting for an answer
+		int				_deficit;		// command cost it may still run this round (DRR)
+		unsigned long	_budget_round;	// round _deficit was last refilled in
+		bool			_backlogged;	// waits in Server::_backlog
+		bool			_unread_input;	// the socket may hold more than the read buffer could take
+		std::string		_pending_input;	// received, but the read buffer could not take it yet
+		LagCompensation	_flood;			// token bucket of its commands
+		bool			_throttled;		// a TIMER_THROTTLE will resume it
+		int				_worker;		// channel worker its commands were handed to, -1 if none
+		bool			_task_pending;	// a LIST or NAMES of its is still running (see SlicedTask)
+		std::atomic<bool>	_write_deferred;	// got replies from a channel worker
+		// Signals between the core and the shard, each posted once until taken
+		std::atomic<bool>	_input_signaled;	// SHARD_INPUT
+		std::atomic<bool>	_flush_signaled;	// SHARD_FLUSH
+		std::atomic<bool>	_input_stalled;		// SHARD_RESUME awaited: its input was full
+		bool			_close_signaled;		// SHARD_CLOSE
 	
 	public:
 		Client(int client_fd);
@@ -27,10 +73,27 @@ class Client
 		// Server infos
 		int				getClientFd()const;
 		void			setNickname(std::string const &nickname);
-		std::string&	getReadBuffer();
-		void			setReadBuffer(std::string const &buf);
-		std::string&	getSendBuffer();
-		void			setSendBuffer(std::string const &buf);
+		RingBuffer&		getReadBuffer();
+		InputTimeline&	getTimeline();
+		size_t			frameInput(uint64_t now, bool &full);
+		bool			frontInput(timeline_entry &entry);
+		void			popInput();
+		void			clearInput();
+		void			setSendBuffer(shared_buffer const &buf);
+		int				getSendIovec(struct iovec *iov, int iovcnt)const;
+		void			consumeSendBuffer(size_t len);
+		void			dropSendBuffer();
+		size_t			getSendqSize()const;
+		size_t			getSendqPeak()const;
+		void			setSendqLimits(size_t soft, size_t hard);
+		size_t			getSendqHard()const;
+		size_t			getSendqSoft()const;
+		bool			isSendqCongested()const;
+		bool			isSendqExceeded()const;
+		void			setSendqExceeded(bool exceeded);
+		bool			hasPendingData()const;
+		bool			hasWriteInterest()const;
+		void			setWriteInterest(bool interest);
 		bool&			getDeconnexionStatus();
 		void			setDeconnexionStatus(bool status);
 		// Client Registration infos
@@ -41,9 +104,15 @@ class Client
 		std::string		getUsername()const;
 		void			setRealname(std::string const &realname);
 		std::string		getRealname()const;
-		std::string&	getMode();
-		void			addMode(std::string const mode);
-		void			removeMode(std::string const mode);
+		void			setAddress(ip_address const &address);
+		ip_address const	&getAddress()const;
+		std::string const	&getHostname()const;
+		bool			hasMode(mode_set mode)const;
+		void			addMode(mode_set mode);
+		void			removeMode(mode_set mode);
+		std::string		getModeString()const;
+		std::set<std::string>&	getJoinedChannels();
+		std::mutex&		getJoinedLock();
 		bool&			getConnexionPassword();
 		void			setConnexionPassword(bool boolean);
 		bool&			isRegistrationDone();
@@ -52,6 +121,43 @@ class Client
 		void			setWelcomeSent(bool boolean);
 		bool&			hasAllInfo();
 		void			sethasAllInfo(bool boolean);
+		// Liveness
+		uint64_t		getLastActivity()const;
+		void			setLastActivity(uint64_t now);
+		uint64_t		getPingSent()const;
+		void			setPingSent(uint64_t now);
+		// Command budget
+		void			refillBudget(unsigned long round, int quantum);
+		bool			hasBudget()const;
+		void			spendBudget(unsigned cost);
+		bool			isBacklogged()const;
+		void			setBacklogged(bool backlogged);
+		bool			hasUnreadInput()const;
+		void			setUnreadInput(bool unread);
+		std::string&	getPendingInput();
+		// Reactor threads
+		int				getShard()const;
+		void			setShard(int shard);
+		std::mutex&		getSendqLock();
+		bool			signalInput();
+		void			takeInputSignal();
+		bool			signalFlush();
+		void			takeFlushSignal();
+		void			setInputStalled();
+		bool			takeInputStalled();
+		bool			isCloseSignaled()const;
+		void			setCloseSignaled();
+		// Flood control
+		LagCompensation&	getFlood();
+		bool			isThrottled()const;
+		void			setThrottled(bool throttled);
+		// Channel workers
+		int				getWorker()const;
+		void			setWorker(int worker);
+		bool			hasTaskPending()const;
+		void			setTaskPending(bool pending);
+		bool			deferWrite();
+		bool			takeDeferredWrite();
 		
 		void			printClient()const;
 		int				is_valid()const;
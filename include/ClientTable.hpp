@@ -0,0 +1,69 @@
+#ifndef CLIENTTABLE_HPP
+# define CLIENTTABLE_HPP
+
+# include "Client.hpp"
+# include <unordered_map>
+
+/**
+ * @brief Identifies a connection rather than a fd: once the client leaves,
+ * 		  its fd may be handed to a new client, but the slot generation
+ * 		  changes so an old handle no longer finds anything.
+ */
+struct client_handle
+{
+	int			fd;
+	unsigned	generation;
+};
+
+std::string	casemapNickname(std::string const &nickname);
+
+/**
+ * @brief Clients of the server, in a table indexed by their fd.
+ *
+ * 	fds are small dense integers, so a lookup is a bounds check and an array
+ * 	access. Each Client is allocated once and never moves until it is erased.
+ * 	The live clients are also kept in a dense list, which is what the
+ * 	iterators walk; erase() swaps the last one into the hole, so iteration
+ * 	order is not stable.
+ *
+ * 	Nicknames are indexed too, under their casemapped form, so finding a
+ * 	client by nickname does not walk every client. The index is only kept
+ * 	right if nicknames are changed through setNickname().
+ */
+class ClientTable
+{
+	private:
+		struct slot
+		{
+			Client		*client;
+			unsigned	generation;	// bumped each time the slot is freed
+			size_t		live_index;	// position of client in _live
+		};
+
+		std::vector<slot>		_slots;
+		std::vector<Client*>	_live;
+		std::unordered_map<std::string, Client*>	_nicknames;	// casemapped nickname -> owner
+
+		ClientTable(ClientTable const &src);
+		ClientTable &operator=(ClientTable const &src);
+
+	public:
+		typedef std::vector<Client*>::iterator	iterator;
+
+		ClientTable();
+		~ClientTable();
+
+		Client*			insert(int fd);
+		void			erase(int fd);
+		Client*			find(int fd) const;
+		Client*			find(client_handle const &handle) const;
+		client_handle	getHandle(int fd) const;
+		Client*			findByNickname(std::string const &nickname) const;
+		bool			setNickname(Client *client, std::string const &nickname);
+		size_t			size() const;
+		size_t			capacity() const;
+		iterator		begin();
+		iterator		end();
+};
+
+#endif
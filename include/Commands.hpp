@@ -3,7 +3,7 @@
 
 # include "Irc.hpp"
 # include "Server.hpp"
-# define VALID_LEN 16
+# include "IrcMessage.hpp"
 
 class Server;
 
@@ -12,35 +12,58 @@ struct cmd_struct
 	std::string	prefix;
 	std::string	name;
 	std::string	message;
+	irc_message	tokens;
 };
 
-int			parseCommand(std::string cmd_line, cmd_struct &cmd_infos);
+typedef void	(*cmd_handler)(Server *server, int const client_fd, cmd_struct &cmd_infos);
+
+# define CMD_NEEDS_REGISTRATION		0x1	// ERR_NOTREGISTERED before the welcome
+# define CMD_BEFORE_REGISTRATION	0x2	// ERR_ALREADYREGISTERED after it
+
+/* Entry of the dispatch table built at compile time in dispatch.cpp */
+struct command_spec
+{
+	const char	*name;
+	cmd_handler	handler;
+	size_t		min_params;	// ERR_NEEDMOREPARAMS below this
+	int			flags;
+	unsigned	cost;		// weight of the command for flood control
+};
+
+int			parseCommand(str_view cmd_line, cmd_struct &cmd_infos);
+void		fillCommand(str_view cmd_line, cmd_struct &cmd_infos);
 void		addToClientBuffer(Server *server, int const client_fd, std::string reply);
+void		addToClientBuffer(Server *server, int const client_fd, shared_buffer const &reply);
+void		addToCoMembersBuffer(Server *server, Client &client, shared_buffer const &reply);
+shared_buffer	makeSharedBuffer(std::string const &reply);
 Client&		retrieveClient(Server *server, int const client_fd);
-std::string	getListOfMembers(std::string client, Channel &channel);
+std::string	getListOfMembers(Server *server, Client &client, Channel &channel);
 std::string	getChannelName(std::string msg_to_parse);
 std::string	findNickname(std::string msg_to_parse);
-bool		isAlreadyUsed(Server *server, int client_fd, std::string new_nickname);
 std::string	getReason(std::string msg_to_parse);
 Client*		getClient(Server *server, int const client_fd);
 std::string	getSymbol(Channel &channel);
 
-void	invite(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	join(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	kick(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	kill(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	list(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	modeFunction(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	names(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	nick(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	notice(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	oper(Server *server, int const client_fd, cmd_struct cmd_infos);
-int		pass(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	part(Server *server, int const client_fd, cmd_struct cmd_infos);
-int		ping(Server *server, int const client_fd, cmd_struct &cmd);
-void	privmsg(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	quit(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	topic(Server *server, int const client_fd, cmd_struct cmd_infos);
-void	user(Server *server, int const client_fd, cmd_struct cmd_infos);
+void	invite(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	join(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	kick(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	kline(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	kill(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	list(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	modeFunction(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	names(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	nick(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	notice(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	oper(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	pass(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	part(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	ping(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	pong(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	privmsg(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	quit(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	stats(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	topic(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	unkline(Server *server, int const client_fd, cmd_struct &cmd_infos);
+void	user(Server *server, int const client_fd, cmd_struct &cmd_infos);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef CONNECTIONCOUNTS_HPP
+# define CONNECTIONCOUNTS_HPP
+
+# include "IpAddress.hpp"
+# include <unordered_map>
+
+/**
+ * @brief Number of connections currently open from each address and, for
+ * 		  IPv6, from each /64 (a single host usually owns a whole /64, so
+ * 		  counting addresses alone would not limit it).
+ *
+ * 	Both counts are O(1) hash lookups on the 16-byte address. An entry is
+ * 	dropped when its count falls back to 0, the tables only ever hold the
+ * 	addresses connected right now.
+ */
+class ConnectionCounts
+{
+	private:
+		typedef std::unordered_map<ip_address, unsigned, ip_address_hash>	count_map;
+
+		count_map	_per_address;
+		count_map	_per_prefix;	// IPv6 only, keyed by the /64
+
+	public:
+		ConnectionCounts();
+		~ConnectionCounts();
+
+		unsigned	perAddress(ip_address const &ip) const;
+		unsigned	perPrefix(ip_address const &ip) const;
+		void		add(ip_address const &ip);
+		void		remove(ip_address const &ip);
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef EPOLLREACTOR_HPP
+#define EPOLLREACTOR_HPP
+
+#include "Reactor.hpp"
+
+#ifdef __linux__
+# include <sys/epoll.h>
+
+# define EPOLL_MAX_EVENTS 256
+
+/**
+ * @brief Edge-triggered backend built on epoll(7).
+ * 		  wait() only visits the descriptors the kernel reports as ready, so
+ * 		  the cost of a wakeup no longer depends on the number of connections.
+ */
+class EpollReactor : public Reactor
+{
+	private:
+		int							_epoll_fd;
+		std::vector<epoll_event>	_events;
+
+		static uint32_t	toEpollEvents(int events);
+
+	public:
+		EpollReactor();
+		~EpollReactor();
+
+		bool		isValid() const;
+		const char*	getName() const;
+		bool		isEdgeTriggered() const;
+		int			add(int fd, int events);
+		int			modify(int fd, int events);
+		int			remove(int fd);
+		int			wait(std::vector<reactor_event> &ready, int timeout_ms);
+};
+
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef EXPIRINGSET_HPP
+# define EXPIRINGSET_HPP
+
+# include "Irc.hpp"
+# include <unordered_map>
+# include <stdint.h>
+
+/**
+ * @brief Hashed set of strings whose entries may carry an expiry time.
+ *
+ * 	Times are those of the server clock (Server::getNow(), in milliseconds),
+ * 	given by the caller: the set never reads the clock itself.
+ *
+ * 	Lookups are O(1) on average. An expired entry is dropped when it is
+ * 	looked up, and the whole set is swept whenever it has doubled in size
+ * 	since the previous sweep, so entries nobody asks about again do not
+ * 	pile up either.
+ */
+class ExpiringSet
+{
+	private:
+		std::unordered_map<std::string, uint64_t>	_entries;	// key -> expiry, 0 if never
+		size_t										_sweep_at;	// size triggering the next sweep
+
+	public:
+		ExpiringSet();
+		~ExpiringSet();
+
+		bool	insert(std::string const &key, uint64_t now, time_t lifetime = 0);
+		bool	erase(std::string const &key);
+		bool	contains(std::string const &key, uint64_t now);
+		size_t	size() const;
+		void	sweep(uint64_t now);
+};
+
+#endif
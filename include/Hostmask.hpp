@@ -0,0 +1,59 @@
+#ifndef HOSTMASK_HPP
+# define HOSTMASK_HPP
+
+# include "Irc.hpp"
+# include "StrView.hpp"
+
+/**
+ * @brief Glob pattern ('*' and '?') compiled once into the literal segments
+ * 		  found between its stars.
+ *
+ * 	Matching anchors the first segment at the start and the last one at the
+ * 	end, then looks for each middle segment left to right from where the
+ * 	previous one ended: the leftmost occurrence is always the best choice,
+ * 	so a mismatch never has to go back to an earlier star.
+ */
+class Glob
+{
+	private:
+		std::vector<std::string>	_segments;
+		bool						_star_first;	// pattern starts with '*'
+		bool						_star_last;		// pattern ends with '*'
+		bool						_has_star;
+		bool						_has_wildcard;	// '*' or '?'
+
+	public:
+		Glob();
+		Glob(std::string const &pattern);
+
+		bool	isLiteral() const;
+		bool	matches(str_view str) const;
+};
+
+/**
+ * @brief A nick!user@host mask, casemapped and split into its three parts.
+ * 		  Incomplete masks are completed the usual way: "nick" means
+ * 		  "nick!*@*" and "user@host" means "*!user@host".
+ */
+class Hostmask
+{
+	public:
+		enum { NICK, USER, HOST, PARTS };
+
+	private:
+		std::string	_mask;			// completed, casemapped
+		std::string	_parts[PARTS];
+		Glob		_globs[PARTS];
+
+	public:
+		Hostmask(std::string const &mask);
+
+		std::string const	&str() const;
+		std::string const	&part(int index) const;
+		bool				isLiteral(int index) const;
+		bool				matches(std::string const &nick, std::string const &user, std::string const &host) const;
+
+		static std::string	normalize(std::string const &mask);
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef INPUTTIMELINE_HPP
+# define INPUTTIMELINE_HPP
+
+# include "Irc.hpp"
+# include "IrcMessage.hpp"
+# include <atomic>
+# include <stdint.h>
+
+/* One line of a client, as the side running the commands sees it */
+struct timeline_entry
+{
+	uint64_t			time;		// coarse clock (ms) it was framed at
+	str_view			line;		// without "\r\n", valid until the line is popped
+	bool				too_long;	// stands for a line RingBuffer dropped (LINE_TOO_LONG)
+	bool				has_command;
+	irc_message			tokens;		// the line split, if it holds a command
+	const command_spec	*spec;		// of its command, NULL if unknown
+};
+
+/**
+ * @brief Lines of one client waiting to be run, in the order they arrived,
+ * 		  each stamped with the time it was framed.
+ *
+ * 	It is a single-producer single-consumer ring of records: the side
+ * 	reading the socket (the reactor shard, or the core without shards)
+ * 	appends with append(), the core reads with front() or a cursor and
+ * 	releases with pop(). Each index is written by one side only and
+ * 	published with release/acquire, so the two run on different threads
+ * 	without a lock. A line is run once: it stays at the front until pop(),
+ * 	even if its command has to wait (throttled client).
+ *
+ * 	A record holds no bytes: it points to the line where it lies in the
+ * 	client's RingBuffer, which keeps it until the producer sees it popped
+ * 	(pinnedFrom()). Nothing is copied on the way in or out, except a line
+ * 	wrapping around the end of the read buffer, which is made contiguous
+ * 	for whoever reads it. The producer also splits each line and looks
+ * 	its command up as it appends it, and keeps the tokens as offsets: the
+ * 	core gets commands ready to run. The records are allocated with the
+ * 	first line.
+ */
+class InputTimeline
+{
+	private:
+		struct record
+		{
+			uint64_t			time;
+			size_t				pin;		// read buffer position kept while it waits
+			str_view			first;		// the line in the read buffer,
+			str_view			second;		// second is empty unless it wraps
+			bool				too_long;
+			bool				has_command;
+			packed_message		tokens;
+			const command_spec	*spec;
+		};
+
+		size_t				_record_count;
+		std::vector<record>	_records;
+		std::string			_linear;	// consumer only, front() of a wrapped line
+		std::atomic<size_t>	_head;		// next record to run, moved by the consumer
+		std::atomic<size_t>	_tail;		// next record to fill, moved by the producer
+
+		InputTimeline(InputTimeline const &src);
+		InputTimeline &operator=(InputTimeline const &src);
+
+		record	&nextRecord(uint64_t time, size_t pin);
+		void	toEntry(record const &rec, timeline_entry &entry, std::string &linear) const;
+
+	public:
+		/**
+		 * @brief Walks the lines waiting when it was made, from the first
+		 * 		  framed at or after a given time, oldest first. It only
+		 * 		  reads: lines are released by pop(), and the cursor must
+		 * 		  not outlive the next pop().
+		 */
+		class cursor
+		{
+			friend class InputTimeline;
+
+			private:
+				InputTimeline const	*_timeline;
+				size_t				_pos;
+				size_t				_end;
+				std::string			_linear;	// a wrapped line made contiguous
+
+			public:
+				bool	next(timeline_entry &entry);
+				size_t	remaining() const;
+		};
+
+		InputTimeline(size_t records = TIMELINE_RECORDS);
+		~InputTimeline();
+
+		// Producer
+		bool	full() const;
+		void	append(uint64_t time, size_t pin, str_view line, str_view first, str_view second);
+		void	appendTooLong(uint64_t time, size_t pin);
+		size_t	pinnedFrom(size_t none) const;
+		// Consumer
+		bool	front(timeline_entry &entry);
+		void	pop();
+		cursor	since(uint64_t time) const;
+		void	clear();
+		size_t	size() const;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef IPADDRESS_HPP
+# define IPADDRESS_HPP
+
+# include "Irc.hpp"
+
+/**
+ * @brief IPv4 or IPv6 address as 16 bytes in network order. IPv4 addresses
+ * 		  are stored IPv4-mapped (::ffff:a.b.c.d), so both families share the
+ * 		  same trees; an IPv4 prefix length is shifted by 96 accordingly.
+ */
+struct ip_address
+{
+	unsigned char	bytes[16];
+
+	bool	isV4() const;
+	bool	bit(unsigned index) const;
+	bool	operator==(ip_address const &other) const;
+};
+
+struct ip_address_hash
+{
+	size_t	operator()(ip_address const &ip) const;
+};
+
+# define IP_ADDRESS_BITS 128
+# define IPV4_MAPPED_PREFIX 96
+# define IPV6_SITE_PREFIX 64	// smallest range handed to an IPv6 subscriber
+
+bool		sockaddrToAddress(struct sockaddr const *addr, ip_address &ip);
+int			acceptSocket(int listen_socket, ip_address &address);
+void		maskAddress(ip_address &ip, unsigned prefix_len);
+bool		parseCidr(std::string const &cidr, ip_address &ip, unsigned &prefix_len);
+std::string	addressToString(ip_address const &ip);
+std::string	cidrToString(ip_address const &ip, unsigned prefix_len);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef IRCMESSAGE_HPP
+# define IRCMESSAGE_HPP
+
+# include "StrView.hpp"
+# include <stdint.h>
+# define MSG_MAX_PARAMS 15
+
+struct command_spec;
+
+/* One line split by tokenizeMessage(), every field points into the line */
+struct irc_message
+{
+	str_view	tags;
+	str_view	prefix;
+	str_view	command;
+	str_view	params[MSG_MAX_PARAMS];
+	size_t		param_count;
+	bool		has_trailing;	// the last param was the ':' trailing one
+};
+
+/* irc_message as offsets into its line, for the lines stored until they run */
+struct packed_message
+{
+	uint16_t	fields[3 + MSG_MAX_PARAMS][2];	// offset and size of tags, prefix, command, params
+	uint8_t		param_count;
+	bool		has_trailing;
+};
+
+int					tokenizeMessage(str_view line, irc_message &msg);
+void				packMessage(str_view line, irc_message const &msg, packed_message &packed);
+void				unpackMessage(str_view line, packed_message const &packed, irc_message &msg);
+const command_spec	*findCommand(str_view name);
+const command_spec	*lookupCommand(str_view command);
+
+#endif
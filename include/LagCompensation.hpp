@@ -1,49 +1,36 @@
-#pragma once
-
-#include "Server.hpp"
-#include <deque>
-#include <map>
-#include <atomic>
-
-#ifdef __linux__
-#include <linux/futex.h>
-#else
-#include <pthread.h>
-#endif
-
-struct TickRecord {
-    int client_fd;
-    std::string message;
-    double timestamp;
+#ifndef LAGCOMPENSATION_HPP
+# define LAGCOMPENSATION_HPP
+
+# include <stdint.h>
+
+/**
+ * @brief Token bucket limiting the rate at which one client runs commands.
+ *
+ * 	The bucket holds up to 'burst' tokens and gains 'rate' of them per
+ * 	second; a command takes as many tokens as its cost in the dispatch table.
+ * 	A client may thus send a burst of commands at once, then one every
+ * 	1 / rate second on average. The state is two integers refilled lazily
+ * 	from the coarse clock when a command comes in, so it costs O(1) per
+ * 	client and is only ever touched by the thread running the client.
+ *
+ * 	Tokens are counted in thousandths, so one millisecond at rate 'rate'
+ * 	adds exactly 'rate' of them.
+ */
+class LagCompensation
+{
+	private:
+		uint64_t	_tokens;		// thousandths of a token
+		uint64_t	_last_refill;	// coarse clock (ms)
+
+		void	refill(uint64_t now, unsigned rate, unsigned burst);
+
+	public:
+		LagCompensation();
+		~LagCompensation();
+
+		void		reset(uint64_t now, unsigned burst);
+		bool		consume(unsigned cost, uint64_t now, unsigned rate, unsigned burst);
+		uint64_t	readyAt(unsigned cost, unsigned rate, unsigned burst) const;
 };
 
-class LagCompensation {
-private:
-    LagCompensation() = default;
-    ~LagCompensation() = default;
-    LagCompensation(const LagCompensation&) = delete;
-    LagCompensation& operator=(const LagCompensation&) = delete;
-
-    std::map<int, std::deque<TickRecord> > message_logs;
-    double getCurrentTime();
-
-#ifdef __linux__
-    // Linux-specific futex functions
-    void futex_wait(std::atomic<int>& futex_var, int expected);
-    void futex_wake(std::atomic<int>& futex_var);
-#else
-    // macOS alternative using pthread
-    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
-    pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
-
-    void futex_wait(std::atomic<int>& futex_var, int expected);
-    void futex_wake(std::atomic<int>& futex_var);
 #endif
-
-public:
-    static LagCompensation& getInstance();
-    void logClientMessage(int client_fd, const std::string& message);
-    std::deque<TickRecord> getValidMessages(int client_fd);
-    void clearOldRecords();
-    void processClientMessage(Server* server, int client_fd, const std::string& message);
-};
@@ -8,9 +8,39 @@
 #define BREAK 2
 
 #define BACKLOG 10
-#define MAX_CLIENT_NB 4
 #define BUF_SIZE_MSG 4096
+#define SEND_IOV_MAX 64		// queued replies flushed by a single writev()
+#define RECV_BUF_SIZE 16384	// per client at most, power of two holding a full tagged line
+#define RECV_BUF_MIN 1024	// what it starts from, power of two holding a full untagged line
+#define RECVQ_MAX (8 * RECV_BUF_SIZE)	// input a client may have waiting on top of it
+#define TIMELINE_RECORDS 32	// framed lines a client may have waiting to run, power of two
+#define MSG_MAX_LEN 512		// RFC 1459 line limit, CRLF included
+#define MSG_MAX_TAGGED_LEN (8191 + MSG_MAX_LEN)	// IRCv3: tags get 8191 more bytes
+#define KICK_LIFETIME 600	// seconds a kicked user stays unable to talk to the channel
+#define TIMER_TICK_MS 1000	// resolution of the timer wheel
+#define SWEEP_INTERVAL 60	// seconds between two sweeps of the expired kicks and bans
+#define TASK_SLICE 200		// channels a LIST (members a NAMES) goes through per loop iteration
+
+/*		SETTINGS (defaults, see src/config/ircserv.config)		*/
+#define SETTINGS_FILE "src/config/ircserv.config"
+#define DEFAULT_REACTOR "epoll"
+#define DEFAULT_REACTORS 1
+#define MAX_REACTORS 64
+#define DEFAULT_CHANNEL_WORKERS 0
+#define MAX_CHANNEL_WORKERS 64
+#define DEFAULT_MAX_CLIENTS 1000
+#define DEFAULT_MAX_PER_ADDRESS 10
+#define DEFAULT_MAX_PER_PREFIX 20
+#define DEFAULT_SENDQ_SOFT 65536		// bytes queued before bulk replies stop
+#define DEFAULT_SENDQ_HARD 524288		// bytes queued before the client is dropped
+#define DEFAULT_PING_INTERVAL 120		// seconds of silence before the server PINGs
+#define DEFAULT_PING_TIMEOUT 60			// seconds left to answer it
+#define DEFAULT_REGISTRATION_TIMEOUT 30	// seconds to complete PASS/NICK/USER
+#define DEFAULT_COMMAND_BUDGET 10		// command cost a client may run per loop iteration
+#define DEFAULT_FLOOD_RATE 10			// command cost a client may run per second
+#define DEFAULT_FLOOD_BURST 40			// command cost it may run at once
 
 /*		MESSAGE		*/
-#define ERR_FULL_SERV "[Server] You cannot join, the server is already full"
+#define ERR_FULL_SERV "The server is full"
+#define ERR_TOO_MANY_CLONES "Too many connections from your host"
 #endif
\ No newline at end of file
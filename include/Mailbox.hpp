@@ -0,0 +1,69 @@
+#ifndef MAILBOX_HPP
+# define MAILBOX_HPP
+
+# include "ClientTable.hpp"
+# include "IpAddress.hpp"
+# include "MpscQueue.hpp"
+
+class SlicedTask;
+
+/* What a message asks of its receiver */
+enum shard_message_type
+{
+	// reactor shard -> core
+	SHARD_ACCEPTED,	// fd was accepted from address, on 'shard'
+	SHARD_INPUT,	// the timeline of 'client' has lines to run
+	SHARD_CLOSED,	// the shard let go of fd: the core may close it
+	// channel worker -> core
+	WORKER_SLICE,	// a slice of 'task' ran on worker 'shard'
+	// core -> reactor shard
+	SHARD_ADD,		// fd was admitted, the shard owns it from now on
+	SHARD_FLUSH,	// the send queue of 'client' has replies
+	SHARD_CLOSE,	// flush, then let go of the connection
+	SHARD_RESUME,	// the timeline of 'client' has room again
+	SHARD_STOP
+};
+
+struct shard_message
+{
+	shard_message_type	type;
+	int					fd;
+	client_handle		client;
+	Client				*target;	// SHARD_ADD: the Client, which outlives SHARD_CLOSED
+	ip_address			address;	// SHARD_ACCEPTED
+	unsigned			shard;		// SHARD_ACCEPTED, WORKER_SLICE: the worker
+	SlicedTask			*task;		// WORKER_SLICE
+};
+
+/**
+ * @brief Queue of messages between threads, with an eventfd to wake up the
+ * 		  receiver. Any thread may post; one thread receives.
+ *
+ * 	Messages are batched: the receiver drains the whole queue at once, and
+ * 	the eventfd is only written by the first post after the receiver was
+ * 	woken up, so a burst costs one wakeup. Nothing is locked: the queue is
+ * 	an MpscQueue, and the flag saying a wakeup is pending is swapped
+ * 	atomically by both sides.
+ */
+class Mailbox
+{
+	private:
+		MpscQueue<shard_message>	_queue;
+		std::atomic<bool>			_signaled;	// the eventfd was written since the last receive
+		int							_event_fd;
+
+		Mailbox(Mailbox const &src);
+		Mailbox &operator=(Mailbox const &src);
+
+	public:
+		Mailbox();
+		~Mailbox();
+
+		int		open();
+		int		getFd() const;
+		void	post(shard_message const &message);
+		void	receive(std::vector<shard_message> &messages);
+		int		wait(int timeout_ms);
+};
+
+#endif
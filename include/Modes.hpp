@@ -0,0 +1,47 @@
+#ifndef MODES_HPP
+# define MODES_HPP
+
+# include <string>
+
+/* Modes of a channel or a user, one bit per mode letter */
+typedef unsigned int	mode_set;
+
+/* Channel modes */
+# define CMODE_KEY			0x1		// k
+# define CMODE_PRIVATE		0x2		// p
+# define CMODE_SECRET		0x4		// s
+# define CMODE_TOPIC		0x8		// t
+
+/* User modes */
+# define UMODE_INVISIBLE	0x1		// i
+# define UMODE_OPERATOR		0x2		// o
+
+/**
+ * @brief Mode types as advertised by CHANMODES=A,B,C,D:
+ * 		  A - list (always a parameter), B - setting (always a parameter),
+ * 		  C - setting (parameter only when set), D - flag (no parameter).
+ */
+enum mode_type
+{
+	MODE_TYPE_A,
+	MODE_TYPE_B,
+	MODE_TYPE_C,
+	MODE_TYPE_D
+};
+
+struct mode_spec
+{
+	char		letter;
+	mode_type	type;
+	mode_set	bit;		// 0 if the mode is not stored in the set (e.g. channel 'o', held per member)
+};
+
+const mode_spec	*findChannelMode(char letter);
+const mode_spec	*findUserMode(char letter);
+bool			modeTakesParam(mode_spec const &spec, bool adding);
+std::string		channelModeString(mode_set modes);
+std::string		userModeString(mode_set modes);
+std::string		channelModeLetters(bool param_only);
+std::string		userModeLetters();
+
+#endif
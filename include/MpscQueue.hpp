@@ -0,0 +1,77 @@
+#ifndef MPSCQUEUE_HPP
+# define MPSCQUEUE_HPP
+
+# include <atomic>
+# include <utility>
+
+/**
+ * @brief Unbounded queue any thread may push to and a single thread pops
+ * 		  from, without a lock.
+ *
+ * 	The nodes form a list from the oldest to the newest. A producer swaps
+ * 	its node in as the newest with one atomic exchange, then links the
+ * 	previous newest to it: pushing never waits on another thread. The
+ * 	consumer walks the links from a dummy node, which is the last node it
+ * 	popped. Between the exchange and the link a push is not visible yet, so
+ * 	pop() only promises what was pushed before the consumer was told about
+ * 	it (an eventfd write, an atomic counter...).
+ */
+template <typename T>
+class MpscQueue
+{
+	private:
+		struct node
+		{
+			std::atomic<node*>	next;
+			T					value;
+
+			node() : next(NULL), value() {}
+			explicit node(T const &v) : next(NULL), value(v) {}
+		};
+
+		std::atomic<node*>	_newest;	// moved by the producers
+		node				*_oldest;	// dummy before the next value, consumer only
+
+		MpscQueue(MpscQueue const &src);
+		MpscQueue &operator=(MpscQueue const &src);
+
+	public:
+		MpscQueue()
+		{
+			_oldest = new node();
+			_newest.store(_oldest, std::memory_order_relaxed);
+		}
+
+		~MpscQueue()
+		{
+			while (_oldest != NULL)
+			{
+				node	*next = _oldest->next.load(std::memory_order_relaxed);
+
+				delete _oldest;
+				_oldest = next;
+			}
+		}
+
+		void	push(T const &value)
+		{
+			node	*entry = new node(value);
+			node	*previous = _newest.exchange(entry, std::memory_order_acq_rel);
+
+			previous->next.store(entry, std::memory_order_release);
+		}
+
+		bool	pop(T &value)
+		{
+			node	*next = _oldest->next.load(std::memory_order_acquire);
+
+			if (next == NULL)
+				return (false);
+			value = std::move(next->value);
+			delete _oldest;
+			_oldest = next; // becomes the dummy
+			return (true);
+		}
+};
+
+#endif
@@ -1,8 +1,7 @@
 #ifndef NUMERICAL_REPLIES_HPP
 #define NUMERICAL_REPLIES_HPP
 
-// void	sendServerRpl(int const client_fd, std::string reply);
-void	sendServerRpl(int const client_fd, std::string client_buffer);
+void	logServerRpl(int const client_fd, std::string const &client_buffer);
 
 # define user_id(nickname, username) (":" + nickname + "!" + username + "@localhost")
 # define RPL_YOURHOST(client, servername, version) (":localhost 002 " + client + " :Your host is " + servername + " (localhost), running version " + version + "\r\n")
@@ -10,6 +9,9 @@ void	sendServerRpl(int const client_fd, std::string client_buffer);
 # define RPL_MYINFO(client, servername, version, user_modes, chan_modes, chan_param_modes) (":localhost 004 " + client + " " + servername + " " + version + " " + user_modes + " " + chan_modes + " " + chan_param_modes + "\r\n")
 # define RPL_ISUPPORT(client, tokens) (":localhost 005 " + client + " " + tokens " :are supported by this server\r\n")
 # define ERR_UNKNOWNCOMMAND(client, command) (":localhost 421 " + client + " " + command + " :Unknown command\r\n")
+# define ERR_NOTREGISTERED(client) (":localhost 451 " + client + " :You have not registered\r\n")
+# define RPL_TRYAGAIN(client, command) (":localhost 263 " + client + " " + command + " :Please wait a while and try again.\r\n")
+# define ERR_INPUTTOOLONG(client) (":localhost 417 " + client + " :Input line was too long\r\n")
 
 // INVITE
 # define ERR_NEEDMOREPARAMS(client, command) (":localhost 461 " + client + " " + command + " :Not enough parameters.\r\n")
@@ -32,6 +34,9 @@ void	sendServerRpl(int const client_fd, std::string client_buffer);
 # define ERR_NOPRIVILEGES(client) ("481 " + client + " :Permission Denied- You're not an IRC operator\r\n")
 # define RPL_KILL(user_id, killed, comment) (user_id + " KILL " + killed + " " + comment + "\r\n")
 
+// KLINE
+# define RPL_SERVERNOTICE(client, text) (":localhost NOTICE " + client + " :" + text + "\r\n")
+
 // MODE
 /* user mode */
 #define MODE_USERMSG(client, mode) (":" + client + " MODE " + client + " :" + mode + "\r\n")
@@ -44,11 +49,14 @@ void	sendServerRpl(int const client_fd, std::string client_buffer);
 #define RPL_CHANNELMODEIS(client, channel, mode) (":localhost 324 " + client + " #" + channel + " " + mode + "\r\n")
 #define RPL_CHANNELMODEISWITHKEY(client, channel, mode, password) (":localhost 324 " + client + " #" + channel + " " + mode + " " + password + "\r\n")
 #define ERR_CHANOPRIVSNEEDED(client, channel) (":localhost 482 " + client + " #" + channel + " :You're not channel operator\r\n")
+#define RPL_BANLIST(client, channel, mask) (":localhost 367 " + client + " #" + channel + " " + mask + "\r\n")
+#define RPL_ENDOFBANLIST(client, channel) (":localhost 368 " + client + " #" + channel + " :End of channel ban list\r\n")
 #define ERR_INVALIDMODEPARAM(client, channel, mode, password) ("696 " + client + " #" + channel + " " + mode + " " + password + " : password must only contained alphabetic character\r\n")
 
 // NAMES
 # define RPL_NAMREPLY(client, symbol, channel, list_of_nicks) (":localhost 353 " + client + " " + symbol + " #" + channel + " :" + list_of_nicks + "\r\n")
 # define RPL_ENDOFNAMES(client, channel) (":localhost 366 " + client + " #" + channel + " :End of /NAMES list.\r\n")
+# define RPL_ENDOFALLNAMES(client) (":localhost 366 " + client + " * :End of /NAMES list.\r\n")
 
 // NICK
 # define ERR_NONICKNAMEGIVEN(client) (":localhost 431 " + client + " :There is no nickname.\r\n")
@@ -67,18 +75,27 @@ void	sendServerRpl(int const client_fd, std::string client_buffer);
 # define ERR_PASSWDMISMATCH(client) (":localhost 464 " + client + " :Password incorrect.\r\n")
 
 // PING
+# define RPL_PING(token) (":localhost PING :" + token + "\r\n")
 # define RPL_PONG(user_id, token) (user_id + " PONG " + token + "\r\n")
 
 // QUIT
 # define RPL_QUIT(user_id, reason) (user_id + " QUIT :Quit: " + reason + "\r\n")
 # define RPL_ERROR(user_id, reason) (user_id + " ERROR :" + reason + "\r\n")
+# define ERR_CLOSINGLINK(host, reason) ("ERROR :Closing Link: " + host + " (" + reason + ")\r\n")
 
 // PRIVMSG
 # define ERR_NOSUCHNICK(client, target) ("401 " + client + " " + target + " :No such nick/channel\r\n")
 # define ERR_NORECIPIENT(client) ("411 " + client + " :No recipient given PRIVMSG\r\n")
 # define ERR_NOTEXTTOSEND(client) ("412 " + client + " :No text to send\r\n")
+# define ERR_CANNOTSENDTOCHAN(client, channel) ("404 " + client + " #" + channel + " :Cannot send to channel\r\n")
 # define RPL_PRIVMSG(nick, username, message) (":" + nick + "!" + username + "@localhost PRIVMSG" + message + "\r\n")
 
+// STATS
+# define RPL_STATSLINKINFO(client, link, sendq, peak, soft, hard, recvq, recent) (":localhost 211 " + client + " " + link + " " + std::to_string(sendq) + " " + std::to_string(peak) + " " + std::to_string(soft) + " " + std::to_string(hard) + " " + std::to_string(recvq) + " " + std::to_string(recent) + "\r\n")
+# define RPL_STATSILINE(client, mask, per_address, per_prefix) (":localhost 215 " + client + " I " + mask + " * " + std::to_string(per_address) + " " + std::to_string(per_prefix) + "\r\n")
+# define RPL_STATSKLINE(client, mask, reason) (":localhost 216 " + client + " K " + mask + " * * :" + reason + "\r\n")
+# define RPL_ENDOFSTATS(client, query) (":localhost 219 " + client + " " + query + " :End of /STATS report\r\n")
+
 // TOPIC
 # define RPL_TOPIC(client, channel, topic) (":localhost 332 " + client + " #" + channel + " " + topic + "\r\n")
 # define RPL_NOTOPIC(client, channel) (":localhost 331 " + client + " #" + channel + " :No topic is set\r\n")
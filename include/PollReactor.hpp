@@ -0,0 +1,30 @@
+#ifndef POLLREACTOR_HPP
+#define POLLREACTOR_HPP
+
+#include "Reactor.hpp"
+
+/**
+ * @brief Portable level-triggered backend built on poll(2).
+ * 		  Kept as the fallback when epoll is unavailable or not wanted.
+ */
+class PollReactor : public Reactor
+{
+	private:
+		std::vector<pollfd>	_fds;
+		std::vector<int>	_index;	// fd -> position in _fds, -1 if not registered
+
+		static short		toPollEvents(int events);
+
+	public:
+		PollReactor();
+		~PollReactor();
+
+		const char*	getName() const;
+		bool		isEdgeTriggered() const;
+		int			add(int fd, int events);
+		int			modify(int fd, int events);
+		int			remove(int fd);
+		int			wait(std::vector<reactor_event> &ready, int timeout_ms);
+};
+
+#endif
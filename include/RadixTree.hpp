@@ -0,0 +1,143 @@
+#ifndef RADIXTREE_HPP
+# define RADIXTREE_HPP
+
+# include "IpAddress.hpp"
+
+/**
+ * @brief Binary radix tree over 128-bit addresses mapping CIDR prefixes to
+ * 		  values, IPv4 and IPv6 alike (see ip_address).
+ *
+ * 	Each level of the tree tests one bit of the address, so a lookup walks
+ * 	at most 128 nodes whatever the number of prefixes stored, and returns the
+ * 	value of the longest prefix containing the address. Nodes live in one
+ * 	vector and refer to each other by index; erasing a prefix only clears
+ * 	its value, the path is reused if the prefix comes back.
+ */
+template <typename T>
+class RadixTree
+{
+	private:
+		struct node
+		{
+			int		child[2];	// index in _nodes, 0 if none (the root is never a child)
+			bool	has_value;
+			T		value;
+		};
+
+		std::vector<node>	_nodes;
+		size_t				_size;
+
+		int	newNode()
+		{
+			node	empty;
+
+			empty.child[0] = empty.child[1] = 0;
+			empty.has_value = false;
+			_nodes.push_back(empty);
+			return (_nodes.size() - 1);
+		}
+
+		template <typename F>
+		void	visit(int index, ip_address &prefix, unsigned depth, F &callback) const
+		{
+			node const	&current = _nodes[index];
+
+			if (current.has_value)
+				callback(prefix, depth, current.value);
+			for (int bit = 0; bit < 2; bit++)
+			{
+				if (current.child[bit] == 0)
+					continue ;
+				if (bit)
+					prefix.bytes[depth / 8] |= (1 << (7 - depth % 8));
+				visit(current.child[bit], prefix, depth + 1, callback);
+				prefix.bytes[depth / 8] &= ~(1 << (7 - depth % 8));
+			}
+		}
+
+	public:
+		RadixTree() : _size(0)	{ newNode(); }
+
+		/**
+		 * @brief Maps the prefix to value, replacing its previous value.
+		 *
+		 * @return true if the prefix was not in the tree
+		 */
+		bool	insert(ip_address const &prefix, unsigned prefix_len, T const &value)
+		{
+			int	index = 0;
+
+			for (unsigned depth = 0; depth < prefix_len; depth++)
+			{
+				int bit = prefix.bit(depth);
+
+				if (_nodes[index].child[bit] == 0)
+				{
+					int child = newNode(); // may move _nodes
+					_nodes[index].child[bit] = child;
+				}
+				index = _nodes[index].child[bit];
+			}
+
+			bool	added = (_nodes[index].has_value == false);
+
+			_nodes[index].has_value = true;
+			_nodes[index].value = value;
+			if (added)
+				_size++;
+			return (added);
+		}
+
+		/**
+		 * @return false if the prefix was not in the tree
+		 */
+		bool	erase(ip_address const &prefix, unsigned prefix_len)
+		{
+			int	index = 0;
+
+			for (unsigned depth = 0; depth < prefix_len && index != -1; depth++)
+				index = _nodes[index].child[prefix.bit(depth)] ? _nodes[index].child[prefix.bit(depth)] : -1;
+			if (index == -1 || _nodes[index].has_value == false)
+				return (false);
+			_nodes[index].has_value = false;
+			_nodes[index].value = T();
+			_size--;
+			return (true);
+		}
+
+		/**
+		 * @brief Value of the longest prefix containing ip, NULL if none does.
+		 */
+		T const	*find(ip_address const &ip) const
+		{
+			T const	*found = NULL;
+			int		index = 0;
+
+			for (unsigned depth = 0; ; depth++)
+			{
+				if (_nodes[index].has_value)
+					found = &_nodes[index].value;
+				if (depth == IP_ADDRESS_BITS || _nodes[index].child[ip.bit(depth)] == 0)
+					break ;
+				index = _nodes[index].child[ip.bit(depth)];
+			}
+			return (found);
+		}
+
+		/**
+		 * @brief Calls callback(prefix, prefix_len, value) for every prefix
+		 * 		  stored, in address order.
+		 */
+		template <typename F>
+		void	forEach(F callback) const
+		{
+			ip_address	prefix;
+
+			memset(prefix.bytes, 0, sizeof(prefix.bytes));
+			visit(0, prefix, 0, callback);
+		}
+
+		size_t	size() const	{ return (_size); }
+};
+
+#endif
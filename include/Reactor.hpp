@@ -0,0 +1,67 @@
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include "Irc.hpp"
+#include <sys/uio.h>
+
+/**
+ * @brief One ready descriptor reported by Reactor::wait().
+ * 		  'events' is a mask of Reactor::READ / WRITE / ERROR for readiness
+ * 		  backends. Completion backends also report:
+ * 		  - ACCEPTED: 'result' is the fd of the new connection;
+ * 		  - RECEIVED: 'data' holds 'result' bytes already read from 'fd'
+ * 		    ('result' is 0 on end of file, -errno on failure).
+ */
+struct reactor_event
+{
+	int			fd;
+	int			events;
+	const char	*data;
+	int			result;
+};
+
+/**
+ * @brief Event demultiplexer used by Server::manageServerLoop.
+ *
+ * 	The server registers the listening socket and every client socket once,
+ * 	changes the interest mask with modify() (e.g. to ask for WRITE while a
+ * 	send buffer is pending) and calls wait() to retrieve only the descriptors
+ * 	that are ready. The concrete backend is picked at startup (see create()).
+ *
+ * 	Edge-triggered backends only report a descriptor again after new activity,
+ * 	so callers must drain reads/accepts until EAGAIN: every socket handed to a
+ * 	Reactor is expected to be non-blocking.
+ *
+ * 	Replies always go through sendv(), so completion backends can batch them.
+ */
+class Reactor
+{
+	public:
+		enum
+		{
+			READ		= 0x01,
+			WRITE		= 0x02,
+			ERROR		= 0x04,
+			EXCLUSIVE	= 0x08,	// wake a single waiter (shared listening sockets), add() only
+			LISTEN		= 0x10,	// fd is a listening socket, add() only
+			ACCEPTED	= 0x20,
+			RECEIVED	= 0x40,
+			NOTIFY		= 0x80	// fd is an eventfd, reported READ, add() only
+		};
+
+		virtual ~Reactor() {}
+
+		virtual const char*	getName() const = 0;
+		virtual bool		isEdgeTriggered() const = 0;
+		virtual int			add(int fd, int events) = 0;
+		virtual int			modify(int fd, int events) = 0;
+		virtual int			remove(int fd) = 0;
+		virtual int			wait(std::vector<reactor_event> &ready, int timeout_ms) = 0;
+		virtual ssize_t		sendv(int fd, const struct iovec *iov, int iovcnt);
+
+		static Reactor*		create(std::string const &backend);
+};
+
+int		setNonBlocking(int fd);
+
+#endif
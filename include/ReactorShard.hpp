@@ -0,0 +1,70 @@
+#ifndef REACTORSHARD_HPP
+# define REACTORSHARD_HPP
+
+# include "Mailbox.hpp"
+# include "Reactor.hpp"
+# include <thread>
+
+/**
+ * @brief Reactor thread owning the sockets of a share of the connections.
+ *
+ * 	Each shard listens on its own SO_REUSEPORT socket, so the kernel spreads
+ * 	new connections over the shards, and runs its own Reactor over the
+ * 	connections it accepted. It does their system calls and their framing:
+ * 	accept(), recv() into the read buffer, lines into the InputTimeline,
+ * 	and writev() of the send queue.
+ *
+ * 	Nicknames, channels and commands belong to the core thread (the Server
+ * 	loop), which the shards only reach through Mailboxes (see
+ * 	shard_message_type): a shard asks the core to admit what it accepted,
+ * 	tells it when a timeline has lines, and the core tells the shard which
+ * 	connections have replies or must be closed. The core alone creates and
+ * 	deletes Clients; a shard drops its pointer when it sends SHARD_CLOSED.
+ */
+class ReactorShard
+{
+	private:
+		struct connection
+		{
+			Client			*client;	// NULL if the fd is not this shard's
+			client_handle	handle;
+			bool			stalled;	// waits for SHARD_RESUME
+			bool			want_write;
+			bool			closing;	// let go once the send queue is empty
+			int				interest;	// Reactor events registered for the fd
+		};
+
+		unsigned				_index;
+		int						_listen_fd;
+		Reactor					*_reactor;
+		Mailbox					_inbox;
+		Mailbox					&_core;
+		std::vector<connection>	_connections;	// indexed by fd
+		std::thread				_thread;
+		uint64_t				_now;
+		bool					_running;
+
+		ReactorShard(ReactorShard const &src);
+		ReactorShard &operator=(ReactorShard const &src);
+
+		void		run();
+		void		acceptClients();
+		void		handleMessage(shard_message const &message);
+		connection	*findConnection(int fd, client_handle const &handle);
+		void		readInput(int fd);
+		size_t		frameInput(connection &conn, bool &full);
+		void		flush(int fd);
+		void		updateInterest(int fd);
+		void		detach(int fd);
+		void		postToCore(shard_message_type type, int fd, client_handle handle);
+
+	public:
+		ReactorShard(unsigned index, int listen_fd, Mailbox &core);
+		~ReactorShard();
+
+		int			start(std::string const &backend);
+		void		stop();
+		Mailbox&	getInbox();
+};
+
+#endif
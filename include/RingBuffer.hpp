@@ -0,0 +1,67 @@
+#ifndef RINGBUFFER_HPP
+# define RINGBUFFER_HPP
+
+# include "Irc.hpp"
+# include "StrView.hpp"
+
+/**
+ * @brief Bounded receive buffer of a client.
+ *
+ * 	recv() writes straight into the free space returned by writeSpan(), and
+ * 	nextLine() cuts the received bytes into lines. Only the bytes that arrived
+ * 	since the previous call are scanned for a terminator, and lines are handed
+ * 	out as views into the buffer. A line wrapping around the end of the
+ * 	storage is the only one copied, to make it contiguous. The bytes of the
+ * 	lines handed out stay in place until release(), so a line whose command
+ * 	has to wait does not need a copy of its own (see InputTimeline).
+ *
+ * 	The storage is only allocated with the first bytes received, at
+ * 	RECV_BUF_MIN, and doubles when it is full, up to the capacity; once every
+ * 	line is released it goes back to RECV_BUF_MIN. It only moves while no
+ * 	line handed out is kept, so the bytes of a kept line stay where they
+ * 	are until it is released. An idle client costs little, one sending
+ * 	bursts or tagged lines gets room for them.
+ *
+ * 	A line longer than MSG_MAX_LEN (MSG_MAX_TAGGED_LEN when it starts with
+ * 	IRCv3 tags) is reported once as LINE_TOO_LONG and dropped up to its
+ * 	terminator, so the buffer stays bounded.
+ */
+class RingBuffer
+{
+	private:
+		std::vector<char>	_buf;
+		size_t				_mask;
+		size_t				_capacity;	// _buf.size() it may grow to
+		size_t				_keep;		// first byte not released
+		size_t				_head;		// first unread byte
+		size_t				_tail;		// end of the received bytes
+		size_t				_scan;		// bytes before it contain no '\n'
+		bool				_discarding;// dropping the end of a line too long
+		std::string			_linear;	// copy of the last line that wrapped
+		size_t				_line_begin;	// of the last line handed out
+		size_t				_line_len;
+
+		size_t		lineLimit() const;
+		str_view	makeView(size_t begin, size_t len);
+		void		resize(size_t size);
+		bool		isKeeping() const;
+
+	public:
+		enum { NO_LINE, LINE, LINE_TOO_LONG };
+
+		RingBuffer(size_t capacity = RECV_BUF_SIZE);
+		~RingBuffer();
+
+		size_t		size() const;
+		size_t		available() const;
+		size_t		writeSpan(char **span);
+		void		commit(size_t len);
+		size_t		write(const char *data, size_t len);
+		int			nextLine(str_view &line);
+		void		lastLineParts(str_view &first, str_view &second) const;
+		size_t		position() const;
+		void		release(size_t upto);
+		void		clear();
+};
+
+#endif
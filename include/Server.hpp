@@ -3,13 +3,24 @@
 
 #include "Irc.hpp"
 #include "Client.hpp"
+#include "ClientTable.hpp"
 #include "Channel.hpp"
+#include "Reactor.hpp"
+#include "RadixTree.hpp"
+#include "ConnectionCounts.hpp"
+#include "TimerWheel.hpp"
+#include "ReactorShard.hpp"
+#include "ChannelWorker.hpp"
+#include "TaskScheduler.hpp"
 #include <iostream>
 #include <fstream>
 #include <csignal>
 
 extern bool	server_shutdown;
 
+struct cmd_struct;
+struct command_spec;
+
 struct server_op
 {
 	std::string name;
@@ -17,18 +28,60 @@ struct server_op
 	std::string	password;
 };
 
+/* Clone limits applied at accept time to the addresses of a CIDR range */
+struct connection_class
+{
+	unsigned	max_per_address;
+	unsigned	max_per_prefix;		// per IPv6 /64, same as above for IPv4
+	size_t		sendq_soft;			// bytes, see Client::isSendqCongested
+	size_t		sendq_hard;
+};
+
+/* Tunables read from src/config/ircserv.config, defaults from Macro.hpp */
+struct server_settings
+{
+	std::string			reactor;
+	unsigned			reactors;		// threads, see ReactorShard
+	unsigned			channel_workers;	// threads, see ChannelWorker
+	size_t				max_clients;
+	connection_class	default_class;	// for the addresses outside every class
+	unsigned			ping_interval;			// seconds
+	unsigned			ping_timeout;
+	unsigned			registration_timeout;
+	int					command_budget;
+	unsigned			flood_rate;		// command cost per second, 0 for no limit
+	unsigned			flood_burst;
+};
+
 class Server
 {
 	private:
 		struct addrinfo					_hints;
 		struct addrinfo					*_servinfo;
 		int								_server_socket_fd;
-		std::map<const int, Client>		_clients;
+		ClientTable						_clients;
 		std::map<std::string, Channel>	_channels;
 		std::string						_port;
 		std::string						_password;
 		std::string						_datetime;
 		std::vector<server_op>			_irc_operators;
+		server_settings					_settings;
+		Reactor							*_reactor;	// NULL with reactor shards
+		std::vector<ReactorShard*>		_shards;
+		Mailbox							_mailbox;	// from the shards and the channel workers to the core
+		RadixTree<std::string>			_klines;	// banned prefixes and their reason
+		RadixTree<connection_class>		_classes;
+		ConnectionCounts				_connections;
+		TimerWheel						_timers;
+		uint64_t						_now;	// coarse clock (ms), read once per loop iteration
+		std::vector<client_handle>		_slow_clients;	// went past their hard sendq limit
+		std::deque<client_handle>		_backlog;	// clients with commands left over from a round
+		unsigned long					_round;		// loop iterations so far
+		std::vector<ChannelWorker*>		_workers;
+		std::vector<std::vector<channel_job> >	_channel_jobs;	// per worker, gathered until runChannelJobs
+		channel_batch					_batch;
+		TaskScheduler					_scheduler;	// deals the slices out to the workers
+		std::vector<SlicedTask*>		_tasks;		// heavy commands still running
 	
 	public:
 		// Constructor & destructor
@@ -43,26 +96,73 @@ class Server
 		std::string							getDatetime() const;
  		void								setDatetime(struct tm *timeinfo);
 		std::map<std::string, Channel>& 	getChannels();
-		std::map<const int, Client>&		getClients();
+		ClientTable&						getClients();
 		std::vector<server_op>&				getIrcOperators(); 
+		server_settings&					getSettings();
+		Reactor*							getReactor();
+		RadixTree<std::string>&				getKlines();
+		RadixTree<connection_class>&		getClasses();
+		connection_class const&				getConnectionClass(ip_address const &address);
+		uint64_t							getNow() const;
+		TaskScheduler&						getScheduler();
 		
 		// Running Server functions
 		int 		readFromConfigFile(char *filename);
+		int			readSettingsFile(const char *filename);
+		int			addKline(std::string const &cidr, std::string const &reason);
+		int			addConnectionClass(std::string const &cidr, std::istream &fields);
 		int			fillServinfo(char *port);
+		int			openListener(bool shared);
 		int			launchServer();
+		int			launchShards();
 		int			manageServerLoop();
-		int			handlePolloutEvent(std::vector<pollfd>& poll_fds, std::vector<pollfd>::iterator &it, const int current_fd);
-		int			handlePollerEvent(std::vector<pollfd>& poll_fds, std::vector<pollfd>::iterator &it);
+		int			manageCoreLoop();
+		int			waitTimeout() const;
+		void		releaseState();
+		void		handleShardMessage(shard_message const &message);
+		void		acceptNewClients();
+		void		admitClient(int client_sock);
+		void		admitClient(int client_sock, ip_address const &address, int shard = -1);
+		int			handlePollinEvent(const int current_fd);
+		int			handleReceivedData(const int current_fd, const char *data, int len);
+		void		processReadBuffer(const int current_fd);
+		void		feedReadBuffer(Client &client, const char *data, size_t len);
+		void		checkPendingInput(Client &client);
+		void		deferCommands(Client &client);
+		void		throttleClient(Client &client, unsigned cost);
+		void		runBacklog();
+		int			launchWorkers();
+		int			channelOwner(Client &client, const command_spec *spec, cmd_struct &cmd_infos);
+		void		dispatchChannelCommand(Client &client, int worker, str_view line);
+		void		runChannelJobs();
+		void		flushDeferredWrites();
+		void		flushDeferredWrite(Client &client);
+		void		waitBatch();
+		void		scheduleTask(Client &client, SlicedTask *task);
+		void		runTaskSlices();
+		void		resumeTask(SlicedTask *task, unsigned worker);
+		void		finishTask(SlicedTask *task);
+		int			handlePolloutEvent(const int current_fd);
+		int			handlePollerEvent(const int current_fd);
+		void		updateClock();
+		int			nextTimerTimeout() const;
+		void		runTimers();
+		void		runTimer(timer const &entry);
+		void		scheduleTimer(timer_type type, client_handle client, uint64_t when);
 
 		
 		// Manage Clients functions
-		void		addClient(int client_socket, std::vector<pollfd> &poll_fds);
-		// void 		delClient(std::vector<pollfd> &poll_fds, int current_fd);
-		void 		delClient(std::vector<pollfd> &poll_fds, std::vector<pollfd>::iterator &it, int current_fd);
-		void 		fillClients(std::map<const int, Client> &client_list, int client_fd, std::string cmd);
+		void		addClient(int client_socket, ip_address const &address, int shard = -1);
+		void 		delClient(int current_fd);
+		void		updateWriteInterest(Client &client);
+		void		signalShard(Client &client);
+		void		postToShard(Client &client, shard_message_type type);
+		void		quitClient(Client &client, std::string const &reason);
+		void		sendqExceeded(Client &client);
+		void		dropSlowClients();
 		// Parsing & Commands functions
-		void		parseMessage(const int client_fd, std::string message);
-		void		execCommand(int const client_fd, std::string cmd_line);
+		unsigned	parseMessage(const int client_fd, timeline_entry const &entry);
+		void		execCommand(int const client_fd, cmd_struct &cmd_infos);
 		// Display functions
 		void		printChannel(std::string &channelName);
 		void		printOper(std::string &channelName);
@@ -73,6 +173,8 @@ class Server
 		};
 		void	addChannel(std::string &channelName);
 		void	addClientToChannel(std::string &channelName, Client &client);
+		void	removeClientFromChannel(std::string const &channelName, Client &client);
+		void	removeClientFromAllChannels(Client &client);
 
 };
 
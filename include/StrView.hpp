@@ -0,0 +1,24 @@
+#ifndef STRVIEW_HPP
+# define STRVIEW_HPP
+
+# include <string>
+# include <cstring>
+
+/**
+ * @brief Non-owning view over characters stored elsewhere, std::string_view
+ * 		  being C++17. It is only valid as long as the buffer it points into.
+ */
+struct str_view
+{
+	const char	*data;
+	size_t		size;
+
+	str_view() : data(NULL), size(0) {}
+	str_view(const char *str, size_t len) : data(str), size(len) {}
+	str_view(std::string const &str) : data(str.data()), size(str.size()) {}
+
+	bool		empty() const	{ return (size == 0); }
+	std::string	str() const		{ return (std::string(data, size)); }
+};
+
+#endif
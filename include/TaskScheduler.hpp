@@ -0,0 +1,98 @@
+#ifndef TASKSCHEDULER_HPP
+# define TASKSCHEDULER_HPP
+
+# include "ClientTable.hpp"
+# include <atomic>
+# include <deque>
+# include <mutex>
+# include <pthread.h>
+
+class Server;
+
+/**
+ * @brief A command too heavy to run in one go (LIST, NAMES), cut into
+ * 		  slices of about TASK_SLICE channels or members. It keeps where it
+ * 		  stopped by name rather than by iterator: channels come and go
+ * 		  between two slices.
+ */
+class SlicedTask
+{
+	private:
+		client_handle	_client;
+		bool			_done;
+		bool			_failed;	// a slice threw
+
+		SlicedTask(SlicedTask const &src);
+		SlicedTask &operator=(SlicedTask const &src);
+
+	protected:
+		/**
+		 * @return true once the last reply is queued
+		 */
+		virtual bool	runSlice(Server &server, Client &client) = 0;
+
+	public:
+		explicit SlicedTask(client_handle client);
+		virtual ~SlicedTask();
+
+		client_handle	getClient() const;
+		bool			isDone() const;
+		bool			hasFailed() const;
+		void			run(Server &server);
+};
+
+/**
+ * @brief The running tasks waiting for their next slice, one deque per
+ * 		  channel worker, and the lock on the server state the slices read.
+ *
+ * 	The core deals a task out to a worker (see Server::scheduleTask) and
+ * 	gets it back after each slice, through its mailbox, to deal it out
+ * 	again (see Server::resumeTask): a task is in one deque at most, so its
+ * 	slices never run concurrently and its replies stay in order. A worker
+ * 	takes from the back of its own deque, and once it is empty, steals from
+ * 	the front of the others: a LIST of a large network on one worker does
+ * 	not leave the others idle. Each deque has its own lock, only contended
+ * 	while a worker steals from it.
+ *
+ * 	Slices run while the core waits for events, not in rounds it waits for.
+ * 	The core holds the state lock for writing from the moment it wakes up
+ * 	to its next wait; a worker only takes a task once it got the lock for
+ * 	reading, and drops it after the slice. The lock prefers writers: the
+ * 	core waits for the slices running when it wakes up, no new one starts.
+ * 	A worker never blocks on it, since the core may be waiting for its
+ * 	channel jobs meanwhile; it goes back to sleep, and the core wakes the
+ * 	workers up again once it lets go while tasks are queued.
+ */
+class TaskScheduler
+{
+	private:
+		struct task_deque
+		{
+			std::mutex				lock;
+			std::deque<SlicedTask*>	tasks;
+		};
+
+		std::vector<task_deque*>	_deques;
+		std::atomic<size_t>			_queued;	// tasks in the deques
+		pthread_rwlock_t			_state;
+		bool						_held;		// by the core
+
+		TaskScheduler(TaskScheduler const &src);
+		TaskScheduler &operator=(TaskScheduler const &src);
+
+	public:
+		TaskScheduler();
+		~TaskScheduler();
+
+		void	resize(size_t threads);
+		size_t	size() const;
+		void	push(size_t thread, SlicedTask *task);
+		bool	next(size_t thread, SlicedTask *&task);
+		// The server state
+		void	lockState();
+		size_t	unlockState();
+		bool	tryShareState();
+		void	unshareState();
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef TIMERWHEEL_HPP
+# define TIMERWHEEL_HPP
+
+# include "Irc.hpp"
+# include "ClientTable.hpp"
+# include <stdint.h>
+
+# define TIMER_WHEEL_BITS 6						// 64 slots per level
+# define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+# define TIMER_WHEEL_LEVELS 4						// 64^4 ticks ahead at most
+
+/* What the server does when a timer fires (see Server::runTimer) */
+enum timer_type
+{
+	TIMER_CLIENT,	// registration deadline, PING or ping timeout of 'client'
+	TIMER_SWEEP,	// drops the expired kicks and bans of every channel
+	TIMER_THROTTLE	// 'client' has tokens again for its held command
+};
+
+struct timer
+{
+	uint64_t		expiry;	// tick
+	timer_type		type;
+	client_handle	client;
+};
+
+/**
+ * @brief Hierarchical hashed timing wheel.
+ *
+ * 	Level 0 has one slot per tick; each slot of level n spans 64 slots of
+ * 	level n - 1. A timer goes in the coarsest slot that still tells its tick
+ * 	apart, and moves down a level whenever the wheel below wraps around, so
+ * 	scheduling is O(1) and advancing one tick costs O(timers due) plus the
+ * 	occasional cascade of a single slot.
+ *
+ * 	There is no cancellation: a timer keeps the handle of its client and the
+ * 	server checks, when it fires, that the client is still there and still
+ * 	needs it.
+ */
+uint64_t	monotonicMs();
+
+class TimerWheel
+{
+	private:
+		std::vector<timer>	_slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+		uint64_t			_now;	// last tick advanced to
+		size_t				_size;
+
+		void	place(timer const &entry);
+
+	public:
+		TimerWheel();
+		~TimerWheel();
+
+		void		schedule(timer entry);
+		void		advance(uint64_t tick, std::vector<timer> &expired);
+		uint64_t	now() const;
+		uint64_t	nextTick() const;
+		size_t		size() const;
+};
+
+#endif
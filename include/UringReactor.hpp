@@ -0,0 +1,120 @@
+#ifndef URINGREACTOR_HPP
+#define URINGREACTOR_HPP
+
+#include "Reactor.hpp"
+
+#ifdef __linux__
+# include <linux/io_uring.h>
+# include <deque>
+
+# define URING_ENTRIES		256
+# define URING_BUF_COUNT	256		// provided receive buffers
+# define URING_BUF_SIZE		BUF_SIZE_MSG
+# define URING_BUF_GROUP	0
+# define URING_SENDQ_MAX	65536	// bytes queued on one fd before sendv() reports EAGAIN
+
+/**
+ * @brief Completion-based backend built on io_uring (Linux >= 6.0). The
+ * 		  opcodes and the multishot recv are probed when the ring is set up,
+ * 		  so an older kernel makes it invalid and the server uses epoll.
+ *
+ * 	- the listening socket uses a single multishot accept: each new connection
+ * 	  is reported as an ACCEPTED event carrying the new fd;
+ * 	- every client socket uses a multishot recv that picks its buffer from a
+ * 	  group of provided buffers: data arrives as RECEIVED events, no recv() call;
+ * 	- an eventfd (NOTIFY) uses a one-shot IORING_OP_POLL_ADD, re-armed after
+ * 	  each READ event it reports;
+ * 	- sendv() copies the reply and queues an IORING_OP_SEND; all queued
+ * 	  operations are submitted together by the next wait(), so one
+ * 	  io_uring_enter() replaces the poll + recv + send syscalls of a wakeup.
+ *
+ * 	Received data stays valid until the next wait(), when its buffer is given
+ * 	back to the kernel.
+ */
+class UringReactor : public Reactor
+{
+	private:
+		struct fd_state
+		{
+			bool					registered;
+			bool					listening;
+			bool					notify;
+			bool					want_write;
+			bool					sending;
+			unsigned				gen;		// bumped on remove(), stale completions are dropped
+			size_t					queued;		// bytes accepted by sendv() and not yet sent
+			std::deque<std::string>	sendq;
+		};
+
+		struct send_op
+		{
+			int			fd;
+			unsigned	gen;
+			std::string	data;
+			size_t		offset;
+		};
+
+		int						_ring_fd;
+		struct io_uring_params	_params;
+		// submission queue
+		void					*_sq_ring;
+		size_t					_sq_ring_size;
+		unsigned				*_sq_head;
+		unsigned				*_sq_tail;
+		unsigned				*_sq_mask;
+		unsigned				*_sq_array;
+		struct io_uring_sqe		*_sqes;
+		size_t					_sqes_size;
+		unsigned				_sq_local_tail;	// entries prepared but not yet published
+		// completion queue
+		void					*_cq_ring;
+		size_t					_cq_ring_size;
+		unsigned				*_cq_head;
+		unsigned				*_cq_tail;
+		unsigned				*_cq_mask;
+		struct io_uring_cqe		*_cqes;
+		// provided buffers
+		char					*_buf_base;
+		std::vector<unsigned short>	_to_recycle;
+
+		std::vector<fd_state>	_fds;
+		std::vector<int>		_write_interest;
+		std::vector<send_op*>	_sends;			// in-flight sends, indexed by slot
+		std::vector<size_t>		_free_sends;
+		std::vector<size_t>		_unsubmitted;	// sends the full submission queue could not take
+
+		bool					setupRing();
+		bool					setupBuffers();
+		bool					probeSupport();
+		struct io_uring_sqe*	getSqe();
+		int						submit(unsigned min_complete, int timeout_ms);
+		void					recycleBuffers();
+		void					armAccept(int fd);
+		void					armRecv(int fd);
+		void					armPoll(int fd);
+		void					cancel(int fd, int op);
+		void					submitSend(size_t slot);
+		void					submitPendingSends();
+		void					queueNextSend(int fd);
+		void					reap(std::vector<reactor_event> &ready);
+		void					handleCompletion(struct io_uring_cqe const &cqe, std::vector<reactor_event> &ready);
+		void					handleSendCompletion(size_t slot, int res, std::vector<reactor_event> &ready);
+		fd_state*				getState(int fd);
+
+	public:
+		UringReactor();
+		~UringReactor();
+
+		bool		isValid() const;
+		const char*	getName() const;
+		bool		isEdgeTriggered() const;
+		int			add(int fd, int events);
+		int			modify(int fd, int events);
+		int			remove(int fd);
+		int			wait(std::vector<reactor_event> &ready, int timeout_ms);
+		ssize_t		sendv(int fd, const struct iovec *iov, int iovcnt);
+};
+
+#endif
+
+#endif
@@ -2,129 +2,525 @@
 #include "Colors.hpp"
 #include "Commands.hpp"
 
-static int acceptSocket(int listenSocket)
+/**
+ * @brief Sends the reason of a refused connection, the client being still
+ * 		  unregistered this is all it will get before the socket is closed.
+ */
+static void	refuseClient(int client_socket, ip_address const &address, std::string const &reason)
 {
-	sockaddr_in client;
-	socklen_t addr_size = sizeof(sockaddr_in);
-	return (accept(listenSocket, (sockaddr *)&client, &addr_size));
-}
+	std::string	error = ERR_CLOSINGLINK(addressToString(address), reason);
 
-static void	tooManyClients(int client_socket)
-{
-	std::cout << RED << ERR_FULL_SERV << RESET << std::endl;
-	send(client_socket, ERR_FULL_SERV, strlen(ERR_FULL_SERV) + 1, 0);
+	std::cout << RED << "[Server] Refused client " << client_socket << ": " << reason << RESET << std::endl;
+	send(client_socket, error.data(), error.size(), MSG_NOSIGNAL);
 	close(client_socket);
 }
 
-static void print(std::string type, int client_socket, char *message)
+static void print(std::string type, int client_socket, std::string const &message)
 {
-	if (message)
-		std::cout  << type << client_socket << " << "\
-		 << BLUE << message << RESET << std::endl;
+	std::cout  << type << client_socket << " << "\
+	 << BLUE << message << RESET << std::endl;
 }
 
+/**
+ * @brief Main loop of the server. The Reactor only reports the descriptors
+ * 		  that are ready, so each wakeup costs O(ready fds) with the epoll
+ * 		  backend instead of a scan of every connection. The wait is bounded
+ * 		  by the next timer of the wheel (see runTimer), which then fires
+ * 		  once the events of the iteration have been handled (see
+ * 		  waitTimeout). With channel workers, the reactor also watches the
+ * 		  mailbox they post the slices they ran to.
+ */
 int Server::manageServerLoop()
 {
-	std::vector<pollfd> poll_fds;
-	pollfd server_poll_fd;
-
-	server_poll_fd.fd = _server_socket_fd;
-	server_poll_fd.events = POLLIN;
-
-	poll_fds.push_back(server_poll_fd);
+	std::vector<reactor_event>	events;
+	std::vector<shard_message>	messages;
 
+	_scheduler.lockState(); // the core owns the server state, except while it waits
+	updateClock();
+	runTimers(); // brings the wheel to the current tick before anything is scheduled
+	scheduleTimer(TIMER_SWEEP, client_handle(), _now + SWEEP_INTERVAL * 1000ULL);
+	if (_shards.empty() == false)
+		return (manageCoreLoop());
 	while (server_shutdown == false)
 	{
-		std::vector<pollfd> new_pollfds; // tmp struct hosting potential newly-created fds
+		releaseState();
+
+		int	status = _reactor->wait(events, waitTimeout());
 
-		if (poll((pollfd *)&poll_fds[0], (unsigned int)poll_fds.size(), -1) <= SUCCESS) // -1 == no timeout
+		_scheduler.lockState();
+		updateClock();
+		_round++; // every client gets a new command budget
+		if (status == FAILURE)
 		{
 			if (errno == EINTR)
 				break ;
-			std::cerr << RED << "[Server] Poll error" << RESET << std::endl;
-			throw ;
+			std::cerr << RED << "[Server] " << _reactor->getName() << " error" << RESET << std::endl;
+			return (FAILURE);
 		}
 
-		std::vector<pollfd>::iterator it = poll_fds.begin();
-		Client *client;
-		while (it != poll_fds.end())
+		for (size_t i = 0; i < events.size(); i++)
 		{
-			if (it->revents & POLLIN) // => If the event that occured is a POLLIN (aka "data is ready to recv() on this socket")
+			const int fd = events[i].fd;
+
+			if (fd == _server_socket_fd)
 			{
-				if (it->fd == _server_socket_fd)
-				{
-					int client_sock = acceptSocket(_server_socket_fd); // Accepts the socket and returns a dedicated fd for this new Client-Server connexion
-					if (client_sock == -1)
-					{
-						std::cerr << RED << "[Server] Accept() failed" << RESET << std::endl;
-						continue;
-					}
-					if (poll_fds.size() - 1 < MAX_CLIENT_NB)
-						addClient(client_sock, new_pollfds); // Beware, here we push the new client_socket in NEW_pollfds
-					else
-						tooManyClients(client_sock);
-					it++;
-				}
-				else // => If the dedicated fd for the Client/Server connection already exists
-				{
-					client = getClient(this, it->fd);
-					char message[BUF_SIZE_MSG];
-					int read_count;
-					
-					memset(message, 0, sizeof(message));
-					read_count = recv(it->fd, message, BUF_SIZE_MSG, 0); // Retrieves the Client's message
-
-					if (read_count <= FAILURE) // when recv returns an error
-					{
-						std::cerr << RED << "[Server] Recv() failed [456]" << RESET << std::endl;
-						delClient(poll_fds, it, it->fd);
-						break;
-					}
-					else if (read_count == 0) // when a client disconnects
-					{
-						std::cout << "[Server] A client just disconnected\n";
-						delClient(poll_fds, it, it->fd);
-						break ;
-					}
-					else
-					{
-						print("[Client] Message received from client ", it->fd, message);
-						client->setReadBuffer(message);
-						if (client->getReadBuffer().find("\r\n") != std::string::npos)
-						{
-							try 
-							{
-								parseMessage(it->fd, client->getReadBuffer());
-							}
-							catch(const std::exception& e) 
-							{ 
-								std::cout << "[SERVER] Caught exception : ";
-								std::cerr << e.what() << std::endl;
-								client->setDeconnexionStatus(true);
-								break ;
-							}
-						}
-						it++;
-					}
-				}
+				if (events[i].events & Reactor::ERROR)
+					return (handlePollerEvent(fd));
+				if (events[i].events & Reactor::ACCEPTED) // completion backends already accepted it
+					admitClient(events[i].result);
+				else
+					acceptNewClients();
+				continue ;
 			}
-			else if (it->revents & POLLOUT) // = "Alert me when I can send() data to this socket without blocking."
+			if (fd == _mailbox.getFd())
 			{
-				if (handlePolloutEvent(poll_fds, it, it->fd) == BREAK)
-					break;
-				it++;
+				_mailbox.receive(messages);
+				for (size_t j = 0; j < messages.size(); j++)
+					handleShardMessage(messages[j]);
+				continue ;
 			}
-			else if (it->revents & POLLERR)
+			if (events[i].events & Reactor::RECEIVED) // completion backends already read the data
 			{
-				if (handlePollerEvent(poll_fds, it) == BREAK)
-					break ;
-				else
-					return (FAILURE);
+				if (handleReceivedData(fd, events[i].data, events[i].result) == BREAK)
+					continue ;
 			}
-			else
-				it++;
+			if (events[i].events & Reactor::READ) // => "data is ready to recv() on this socket"
+			{
+				if (handlePollinEvent(fd) == BREAK)
+					continue ;
+			}
+			if (events[i].events & Reactor::WRITE) // = "Alert me when I can send() data to this socket without blocking."
+			{
+				if (handlePolloutEvent(fd) == BREAK)
+					continue ;
+			}
+			if (events[i].events & Reactor::ERROR)
+				handlePollerEvent(fd);
+		}
+		runBacklog();
+		runChannelJobs();
+		runTaskSlices();
+		runTimers();
+		dropSlowClients();
+	}
+	return (SUCCESS);
+}
+
+/**
+ * @brief Main loop with reactor shards: the sockets are theirs, the core
+ * 		  runs the commands, timers and everything else that touches
+ * 		  nicknames and channels, one batch of shard messages per iteration.
+ * 		  The wait is bounded the same way as manageServerLoop's.
+ */
+int Server::manageCoreLoop()
+{
+	std::vector<shard_message>	messages;
+
+	while (server_shutdown == false)
+	{
+		int	status;
+
+		releaseState();
+		status = _mailbox.wait(waitTimeout());
+		_scheduler.lockState();
+		if (status == FAILURE)
+		{
+			if (errno == EINTR)
+				break ;
+			std::cerr << RED << "[Server] Mailbox error" << RESET << std::endl;
+			return (FAILURE);
 		}
-		poll_fds.insert(poll_fds.end(), new_pollfds.begin(), new_pollfds.end()); // Add the range of NEW_pollfds in poll_fds (helps recalculating poll_fds.end() in the for loop)
+		updateClock();
+		_round++;
+		_mailbox.receive(messages);
+		for (size_t i = 0; i < messages.size(); i++)
+			handleShardMessage(messages[i]);
+		runBacklog();
+		runChannelJobs();
+		runTaskSlices();
+		runTimers();
+		dropSlowClients();
 	}
+	for (size_t i = 0; i < _shards.size(); i++)
+		_shards[i]->stop();
 	return (SUCCESS);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief How long the loop may sleep: until the next timer, not at all
+ * 		  while clients have commands left over from the previous iteration
+ * 		  (see processReadBuffer), or heavy commands have slices left that
+ * 		  the core runs itself (see runTaskSlices).
+ */
+int Server::waitTimeout() const
+{
+	if (_backlog.empty() && (_tasks.empty() || _workers.empty() == false))
+		return (nextTimerTimeout());
+	return (0);
+}
+
+/**
+ * @brief Lets go of the server state before the loop sleeps, and wakes up
+ * 		  as many workers as there are tasks waiting for a slice (they
+ * 		  steal from each other).
+ */
+void Server::releaseState()
+{
+	size_t	queued = _scheduler.unlockState();
+
+	for (size_t i = 0; i < queued && i < _workers.size(); i++)
+		_workers[i]->wake();
+}
+
+void Server::handleShardMessage(shard_message const &message)
+{
+	if (message.type == SHARD_ACCEPTED)
+		return (admitClient(message.fd, message.address, message.shard));
+	if (message.type == WORKER_SLICE)
+		return (resumeTask(message.task, message.shard));
+
+	Client	*client = _clients.find(message.client);
+
+	if (client == NULL)
+		return ;
+	if (message.type == SHARD_CLOSED)
+		delClient(message.fd);
+	else if (message.type == SHARD_INPUT && client->getDeconnexionStatus() == false)
+	{
+		client->takeInputSignal(); // before reading the timeline: later lines signal again
+		client->setLastActivity(_now);
+		processReadBuffer(message.fd);
+	}
+}
+
+/**
+ * @brief Accepts every pending connection on the listening socket. The socket
+ * 		  is non-blocking, so the loop stops on EAGAIN once the backlog is empty
+ * 		  (required by edge-triggered backends which only signal new arrivals).
+ */
+void Server::acceptNewClients()
+{
+	while (true)
+	{
+		ip_address	address;
+		int client_sock = acceptSocket(_server_socket_fd, address); // Accepts the socket and returns a dedicated fd for this new Client-Server connexion
+		if (client_sock == FAILURE)
+		{
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				std::cerr << RED << "[Server] Accept() failed" << RESET << std::endl;
+			if (errno == EINTR)
+				continue ;
+			return ;
+		}
+		admitClient(client_sock, address);
+	}
+}
+
+/**
+ * @brief Admits a connection accepted by the reactor itself (completion
+ * 		  backends), whose peer address is still to be looked up.
+ */
+void Server::admitClient(int client_sock)
+{
+	sockaddr_storage	addr;
+	socklen_t			len = sizeof(addr);
+	ip_address			address;
+
+	if (getpeername(client_sock, reinterpret_cast<sockaddr *>(&addr), &len) == FAILURE
+		|| sockaddrToAddress(reinterpret_cast<sockaddr *>(&addr), address) == false)
+	{
+		close(client_sock); // already reset by the peer
+		return ;
+	}
+	admitClient(client_sock, address);
+}
+
+/**
+ * @brief Decides, right after accept(), whether the connection gets a Client.
+ * 		  Every check is done before anything is allocated for it:
+ * 		  	- a K-lined address costs one lookup in the radix tree (at most
+ * 		  	  128 steps),
+ * 		  	- the global limit (max_clients),
+ * 		  	- the clone limits of its connection class, per address and per
+ * 		  	  IPv6 /64, counted in two hash tables.
+ */
+void Server::admitClient(int client_sock, ip_address const &address, int shard)
+{
+	std::string const		*kline = _klines.find(address);
+	connection_class const	&limits = getConnectionClass(address);
+
+	if (kline != NULL)
+		refuseClient(client_sock, address, "K-lined: " + *kline);
+	else if (_clients.size() >= _settings.max_clients)
+		refuseClient(client_sock, address, ERR_FULL_SERV);
+	else if (_connections.perAddress(address) >= limits.max_per_address
+		|| _connections.perPrefix(address) >= limits.max_per_prefix)
+		refuseClient(client_sock, address, ERR_TOO_MANY_CLONES);
+	else
+		addClient(client_sock, address, shard);
+}
+
+/**
+ * @brief Reads everything the client sent until recv() would block, straight
+ * 		  into the free space of its ring buffer, and parses the complete
+ * 		  lines as they come. Once the buffer is full and the client is out
+ * 		  of command budget, the rest stays in the socket: the client is
+ * 		  backlogged and runBacklog() reads it in a later round.
+ *
+ * @return int BREAK if the client has been deleted, SUCCESS otherwise
+ */
+int Server::handlePollinEvent(const int current_fd)
+{
+	Client *client = getClient(this, current_fd);
+	char	*span;
+	size_t	span_len;
+	int		read_count;
+
+	if (!client)
+		return (BREAK);
+	while (true)
+	{
+		span_len = client->getReadBuffer().writeSpan(&span);
+		if (span_len == 0) // full: make room before reading more
+		{
+			processReadBuffer(current_fd);
+			if (client->getDeconnexionStatus() == true || client->isSendqExceeded() == true)
+				return (SUCCESS); // what it sends after leaving is ignored
+			if (client->getReadBuffer().available() == 0)
+			{
+				client->setUnreadInput(true); // the edge was consumed: nobody will tell us again
+				deferCommands(*client);
+				return (SUCCESS);
+			}
+			continue ;
+		}
+		read_count = recv(current_fd, span, span_len, 0); // Retrieves the Client's message
+
+		if (read_count <= FAILURE) // when recv returns an error
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break ;
+			if (errno == EINTR)
+				continue ;
+			std::cerr << RED << "[Server] Recv() failed [456]" << RESET << std::endl;
+			delClient(current_fd);
+			return (BREAK);
+		}
+		else if (read_count == 0) // when a client disconnects
+		{
+			std::cout << "[Server] A client just disconnected\n";
+			delClient(current_fd);
+			return (BREAK);
+		}
+		print("[Client] Message received from client ", current_fd, std::string(span, read_count));
+		client->getReadBuffer().commit(read_count);
+		client->setLastActivity(_now);
+	}
+	processReadBuffer(current_fd);
+	return (SUCCESS);
+}
+
+/**
+ * @brief Same as handlePollinEvent for completion backends, which hand over
+ * 		  the bytes they received instead of a readiness notification.
+ *
+ * @param len Number of bytes in data, 0 on disconnection, -errno on failure
+ * @return int BREAK if the client has been deleted, SUCCESS otherwise
+ */
+int Server::handleReceivedData(const int current_fd, const char *data, int len)
+{
+	Client *client = getClient(this, current_fd);
+
+	if (!client)
+		return (BREAK);
+	if (len < 0)
+	{
+		std::cerr << RED << "[Server] Recv() failed [456]" << RESET << std::endl;
+		delClient(current_fd);
+		return (BREAK);
+	}
+	else if (len == 0)
+	{
+		std::cout << "[Server] A client just disconnected\n";
+		delClient(current_fd);
+		return (BREAK);
+	}
+	print("[Client] Message received from client ", current_fd, std::string(data, len));
+	client->setLastActivity(_now);
+	if (client->getPendingInput().empty() == false) // behind what already waits
+	{
+		client->getPendingInput().append(data, len);
+		checkPendingInput(*client);
+		return (SUCCESS);
+	}
+	feedReadBuffer(*client, data, len);
+	return (SUCCESS);
+}
+
+/**
+ * @brief Moves received bytes into the read buffer as its lines are run.
+ * 		  When the client runs out of command budget with a full buffer, the
+ * 		  rest cannot stay in the socket (completion backends have read it
+ * 		  already): it waits in the client's pending input for runBacklog().
+ */
+void Server::feedReadBuffer(Client &client, const char *data, size_t len)
+{
+	RingBuffer	&readbuf = client.getReadBuffer();
+
+	while (len > 0 && client.getDeconnexionStatus() == false && client.isSendqExceeded() == false)
+	{
+		size_t written = readbuf.write(data, len);
+
+		data += written;
+		len -= written;
+		processReadBuffer(client.getClientFd());
+		if (readbuf.available() == 0)
+			break ;
+	}
+	if (len == 0 || client.getDeconnexionStatus() == true || client.isSendqExceeded() == true)
+		return ; // what a leaving client sends is ignored
+	client.getPendingInput().append(data, len);
+	checkPendingInput(client);
+}
+
+/**
+ * @brief Pending input is only bounded by how fast the client sends, so a
+ * 		  client that keeps sending far more than its budget lets it run is
+ * 		  disconnected.
+ */
+void Server::checkPendingInput(Client &client)
+{
+	if (client.getPendingInput().size() > RECVQ_MAX)
+	{
+		client.getPendingInput().clear();
+		quitClient(client, "Excess Flood");
+	}
+	else
+		deferCommands(client);
+}
+
+/**
+ * @brief Runs the lines of the client while it has command budget left, from
+ * 		  the front of its timeline. Without a shard, the core frames them
+ * 		  out of the read buffer itself first; an unfinished line stays in
+ * 		  the buffer until the rest of it arrives. A line is released once
+ * 		  its command has run, so it runs exactly once, however many times
+ * 		  it had to wait.
+ *
+ * 	Commands are scheduled by deficit round robin: each loop iteration (a
+ * 	round), the client may run commands worth command_budget (the cost of
+ * 	each comes from the dispatch table). What is left waits in the buffer,
+ * 	and the client in the backlog, until the next round, so a client
+ * 	pipelining hundreds of commands only delays the others by one budget.
+ */
+void Server::processReadBuffer(const int current_fd)
+{
+	Client			*client = getClient(this, current_fd);
+	timeline_entry	entry;
+	unsigned		cost;
+	size_t			ran = 0;
+	bool			full;
+
+	client->refillBudget(_round, _settings.command_budget);
+	while (client->getDeconnexionStatus() == false && client->isSendqExceeded() == false
+		&& client->isThrottled() == false) // the TIMER_THROTTLE resumes it
+	{
+		if (client->hasBudget() == false)
+		{
+			deferCommands(*client);
+			break ;
+		}
+		if (client->frontInput(entry) == false)
+		{
+			if (client->getShard() != FAILURE || client->frameInput(_now, full) == 0)
+				break ;
+			continue ; // framed by the core, without a shard
+		}
+		ran++;
+		if (entry.too_long)
+		{
+			addToClientBuffer(this, current_fd, ERR_INPUTTOOLONG(client->getNickname()));
+			client->spendBudget(1);
+			client->popInput();
+			continue ;
+		}
+		try
+		{
+			if ((cost = parseMessage(current_fd, entry)) == 0)
+				break ; // held, the line stays at the front
+			client->spendBudget(cost);
+		}
+		catch(const std::exception& e)
+		{
+			std::cout << "[SERVER] Caught exception : ";
+			std::cerr << e.what() << std::endl;
+			client->setDeconnexionStatus(true);
+		}
+		client->popInput();
+	}
+	if (client->getDeconnexionStatus() == true) // what it sends after leaving is ignored
+		client->clearInput();
+	else if (client->getShard() != FAILURE && ran > 0 && client->takeInputStalled())
+		postToShard(*client, SHARD_RESUME); // its timeline has room again
+	updateWriteInterest(*client); // flushes the replies, then disconnects if needed
+}
+
+/**
+ * @brief Queues the client for the next round, once. A throttled client is
+ * 		  left out: its TIMER_THROTTLE queues it when its tokens are back.
+ */
+void Server::deferCommands(Client &client)
+{
+	if (client.isBacklogged() || client.isThrottled())
+		return ;
+	client.setBacklogged(true);
+	_backlog.push_back(_clients.getHandle(client.getClientFd()));
+}
+
+/**
+ * @brief Pauses a client that has no tokens for its next command, until
+ * 		  the bucket holds enough of them again. Nothing is dropped: the line
+ * 		  stays at the front of its timeline, those behind it wait there or
+ * 		  in the read buffer, and the client only gets lagged.
+ */
+void Server::throttleClient(Client &client, unsigned cost)
+{
+	uint64_t	ready = client.getFlood().readyAt(cost, _settings.flood_rate, _settings.flood_burst);
+
+	client.setThrottled(true);
+	scheduleTimer(TIMER_THROTTLE, _clients.getHandle(client.getClientFd()), ready);
+}
+
+/**
+ * @brief Gives their turn to the clients that had commands left over, in
+ * 		  the order they ran out of budget. Those still not done go back to
+ * 		  the end of the backlog.
+ */
+void Server::runBacklog()
+{
+	std::deque<client_handle>	backlog;
+
+	backlog.swap(_backlog);
+	for (size_t i = 0; i < backlog.size(); i++)
+	{
+		Client	*client = _clients.find(backlog[i]);
+
+		if (client == NULL)
+			continue ;
+		client->setBacklogged(false);
+		if (client->hasUnreadInput())
+		{
+			client->setUnreadInput(false);
+			handlePollinEvent(client->getClientFd());
+		}
+		else if (client->getPendingInput().empty() == false)
+		{
+			std::string	pending;
+
+			pending.swap(client->getPendingInput());
+			feedReadBuffer(*client, pending.data(), pending.size());
+		}
+		else
+			processReadBuffer(client->getClientFd());
+	}
+}
@@ -1,38 +1,68 @@
 #include "Server.hpp"
 #include "Colors.hpp"
 #include "Commands.hpp"
+#include <algorithm>
 
-int	Server::handlePolloutEvent(std::vector<pollfd>& poll_fds, std::vector<pollfd>::iterator &it, const int current_fd)
+/**
+ * @brief Writes the client's send queue, up to SEND_IOV_MAX replies per
+ * 		  writev(), until it is empty or the socket would block. A partial write keeps the rest queued (and the WRITE
+ * 		  interest armed) for the next time the socket becomes writable.
+ *
+ * @return int BREAK if the client has been deleted, SUCCESS otherwise
+ */
+int	Server::handlePolloutEvent(const int current_fd)
 {
 	Client *client = getClient(this, current_fd);
 	if (!client)
+	{
 		std::cout << "[Server] Did not found connection to client sorry" << std::endl;
-	else
+		return (BREAK);
+	}
+	while (client->hasPendingData())
 	{
-		sendServerRpl(current_fd, client->getSendBuffer());
-		if (client->getReadBuffer().find("\r\n"))
-			client->getReadBuffer().clear();
-		client->getSendBuffer().clear();
-		if (client->getDeconnexionStatus() == true)
+		iovec	replies[SEND_IOV_MAX];
+		int		count = client->getSendIovec(replies, SEND_IOV_MAX);
+
+		ssize_t sent = _reactor->sendv(current_fd, replies, count); // batched by completion backends
+		if (sent == FAILURE)
 		{
-			delClient(poll_fds, it, current_fd);
+			if (errno == EINTR)
+				continue ;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break ;
+			std::cerr << RED << "[Server] Send() failed" << RESET << std::endl;
+			delClient(current_fd);
 			return (BREAK);
 		}
+		for (size_t i = 0, logged = 0; logged < static_cast<size_t>(sent); i++)
+		{
+			size_t len = std::min(replies[i].iov_len, sent - logged);
+
+			logServerRpl(current_fd, std::string(static_cast<char *>(replies[i].iov_base), len));
+			logged += len;
+		}
+		client->consumeSendBuffer(sent);
+	}
+	if (client->hasPendingData() == false && client->getDeconnexionStatus() == true)
+	{
+		delClient(current_fd);
+		return (BREAK);
 	}
+	updateWriteInterest(*client);
 	return (SUCCESS);
 }
 
-int	Server::handlePollerEvent(std::vector<pollfd>& poll_fds, std::vector<pollfd>::iterator &it)
+int	Server::handlePollerEvent(const int current_fd)
 {
-	if (it->fd == _server_socket_fd)
+	if (current_fd == _server_socket_fd)
 	{
 		std::cerr << RED << "[Server] Listen socket error" << RESET << std::endl;
 		return (FAILURE);
 	}
 	else
 	{
-		delClient(poll_fds, it, it->fd);
+		if (getClient(this, current_fd) != NULL)
+			delClient(current_fd);
 		return (BREAK);
 	}
 }
-
@@ -0,0 +1,106 @@
+#include "Server.hpp"
+#include "Commands.hpp"
+
+/**
+ * @brief Reads the clock once for the whole loop iteration.
+ */
+void	Server::updateClock()
+{
+	_now = monotonicMs();
+}
+
+uint64_t	Server::getNow() const	{ return (_now); }
+
+void	Server::scheduleTimer(timer_type type, client_handle client, uint64_t when)
+{
+	timer	entry;
+
+	entry.expiry = (when + TIMER_TICK_MS - 1) / TIMER_TICK_MS; // never early
+	entry.type = type;
+	entry.client = client;
+	_timers.schedule(entry);
+}
+
+/**
+ * @brief How long Reactor::wait() may block before a timer is due, -1 if no
+ * 		  timer is pending.
+ */
+int		Server::nextTimerTimeout() const
+{
+	uint64_t	next = _timers.nextTick();
+
+	if (next == 0)
+		return (-1);
+	if (next * TIMER_TICK_MS <= _now)
+		return (0);
+	return (static_cast<int>(next * TIMER_TICK_MS - _now));
+}
+
+/**
+ * @brief Fires every timer due at _now.
+ */
+void	Server::runTimers()
+{
+	std::vector<timer>	expired;
+
+	_timers.advance(_now / TIMER_TICK_MS, expired);
+	for (size_t i = 0; i < expired.size(); i++)
+		runTimer(expired[i]);
+}
+
+/**
+ * @brief Each client has one timer, which plays three parts in turn:
+ * 		  - until the client registers, it is the registration deadline;
+ * 		  - then it fires once the client has been silent for ping_interval
+ * 		    seconds, and the server sends a PING;
+ * 		  - the client then has ping_timeout seconds to send anything.
+ * 		  Traffic does not move the timer: when it fires, it looks at the
+ * 		  last activity of the client and goes back to sleep if there was some.
+ * 		  A throttled client has a TIMER_THROTTLE besides (see throttleClient).
+ */
+void	Server::runTimer(timer const &entry)
+{
+	if (entry.type == TIMER_SWEEP)
+	{
+		for (std::map<std::string, Channel>::iterator it = _channels.begin(); it != _channels.end(); it++)
+			it->second.sweepExpired(_now);
+		scheduleTimer(TIMER_SWEEP, entry.client, _now + SWEEP_INTERVAL * 1000ULL);
+		return ;
+	}
+
+	Client	*client = _clients.find(entry.client);
+
+	if (client == NULL || client->getDeconnexionStatus() == true) // gone, or leaving already
+		return ;
+	if (entry.type == TIMER_THROTTLE)
+	{
+		client->setThrottled(false);
+		deferCommands(*client); // its held command runs in the next round
+		return ;
+	}
+	if (client->isRegistrationDone() == false)
+	{
+		quitClient(*client, "Registration timed out");
+		return ;
+	}
+	if (client->getPingSent() != 0)
+	{
+		if (client->getLastActivity() < client->getPingSent())
+		{
+			std::ostringstream	reason;
+
+			reason << "Ping timeout: " << (_now - client->getLastActivity()) / 1000 << " seconds";
+			quitClient(*client, reason.str());
+			return ;
+		}
+		client->setPingSent(0);
+	}
+
+	uint64_t	idle_deadline = client->getLastActivity() + _settings.ping_interval * 1000ULL;
+
+	if (_now < idle_deadline)
+		return (scheduleTimer(TIMER_CLIENT, entry.client, idle_deadline));
+	addToClientBuffer(this, client->getClientFd(), RPL_PING(std::string("localhost")));
+	client->setPingSent(_now);
+	scheduleTimer(TIMER_CLIENT, entry.client, _now + _settings.ping_timeout * 1000ULL);
+}
@@ -0,0 +1,291 @@
+#include "Server.hpp"
+#include "Commands.hpp"
+#include <sys/eventfd.h>
+#include <algorithm>
+
+int		Server::launchWorkers()
+{
+	if (_settings.channel_workers == 0)
+		return (SUCCESS);
+	_batch.event_fd = eventfd(0, EFD_CLOEXEC);
+	if (_batch.event_fd == FAILURE)
+	{
+		std::cerr << RED << "[Server] eventfd() failed" << RESET << std::endl;
+		return (FAILURE);
+	}
+	if (_shards.empty() // the workers post the slices they ran to the core
+		&& (_mailbox.open() == FAILURE || _reactor->add(_mailbox.getFd(), Reactor::READ | Reactor::NOTIFY) == FAILURE))
+	{
+		std::cerr << RED << "[Server] Mailbox registration failed" << RESET << std::endl;
+		return (FAILURE);
+	}
+	_scheduler.resize(_settings.channel_workers);
+	for (unsigned i = 0; i < _settings.channel_workers; i++)
+	{
+		_workers.push_back(new ChannelWorker(i, *this, _batch, _mailbox));
+		if (_workers.back()->start() == FAILURE)
+		{
+			std::cerr << RED << "[Server] Channel worker " << i << " failed to start" << RESET << std::endl;
+			return (FAILURE);
+		}
+	}
+	_channel_jobs.resize(_workers.size());
+	std::cout << YELLOW << "[Server] " << _workers.size() << " channel workers" << RESET << std::endl;
+	return (SUCCESS);
+}
+
+/**
+ * @brief Channel a JOIN, PART, PRIVMSG, MODE, TOPIC or KICK is aimed at,
+ * 		  if its handler cannot touch any other channel.
+ *
+ * 	Only the parsed parameters are looked at: the first one must be a
+ * 	single "#<name>" that the handlers, which still read cmd_infos.message,
+ * 	all read the same, and no other parameter may be one the handler could
+ * 	take for another channel. Anything else runs on the core.
+ */
+static bool	channelTarget(cmd_struct const &cmd_infos, std::string &name)
+{
+	irc_message const	&tokens = cmd_infos.tokens;
+	str_view			target = (tokens.param_count > 0 ? tokens.params[0] : str_view());
+	bool				has_alpha = false;
+
+	if (target.size < 2 || target.data[0] != '#'
+		|| (tokens.param_count == 1 && tokens.has_trailing)) // ":#name" is read differently
+		return (false);
+	for (size_t i = 1; i < target.size; i++)
+	{
+		if (isalnum(target.data[i]) == false && target.data[i] != '-' && target.data[i] != '_')
+			return (false);
+		has_alpha |= (isalpha(target.data[i]) != 0);
+	}
+	if (has_alpha == false)
+		return (false);
+	name.assign(target.data + 1, target.size - 1);
+	if (cmd_infos.name == "PRIVMSG" || cmd_infos.name == "MODE"
+		|| cmd_infos.name == "TOPIC" || cmd_infos.name == "KICK")
+		return (true);
+	if (cmd_infos.name == "JOIN") // a key would be read as a channel if the mode is gone
+		return (tokens.param_count == 1);
+	if (cmd_infos.name == "PART") // a reason without ':' would be read as channels
+		return (tokens.param_count == 1 || (tokens.param_count == 2 && tokens.has_trailing));
+	return (false);
+}
+
+/**
+ * @brief Channel worker the command goes to, FAILURE if the core runs it.
+ *
+ * 	A channel belongs to the worker its name hashes to. A JOIN creating a
+ * 	channel stays on the core: the channel index only changes while no
+ * 	worker runs. Channels are never erased from it, so one found here is
+ * 	still there when its worker runs the command (see addChannel).
+ */
+int		Server::channelOwner(Client &client, const command_spec *spec, cmd_struct &cmd_infos)
+{
+	std::string	name;
+
+	if (_workers.empty() || spec == NULL || client.isRegistrationDone() == false
+		|| cmd_infos.tokens.param_count < spec->min_params
+		|| channelTarget(cmd_infos, name) == false)
+		return (FAILURE);
+	if (cmd_infos.name == "JOIN" && _channels.find(name) == _channels.end())
+		return (FAILURE);
+	return (std::hash<std::string>()(name) % _workers.size());
+}
+
+/**
+ * @brief Hands the line to a channel worker at the end of the loop
+ * 		  iteration. Until then the client may only send more commands to
+ * 		  the same worker, which runs them in order (see parseMessage).
+ */
+void	Server::dispatchChannelCommand(Client &client, int worker, str_view line)
+{
+	channel_job	job;
+
+	job.client = _clients.getHandle(client.getClientFd());
+	job.line = line.str();
+	job.failed = false;
+	_channel_jobs[worker].push_back(job);
+	client.setWorker(worker);
+}
+
+/**
+ * @brief Runs the channel commands gathered during the loop iteration: each
+ * 		  worker gets its share in one go, and the core waits for all of
+ * 		  them, so nothing else touches the channels meanwhile. Then the
+ * 		  clients whose commands ran resume, and those who got replies are
+ * 		  flushed.
+ */
+void	Server::runChannelJobs()
+{
+	size_t		total = 0;
+	channel_job	job;
+
+	for (size_t i = 0; i < _channel_jobs.size(); i++)
+		total += _channel_jobs[i].size();
+	if (total == 0)
+		return ;
+	_batch.left.store(total, std::memory_order_release);
+	for (size_t i = 0; i < _channel_jobs.size(); i++)
+	{
+		if (_channel_jobs[i].empty())
+			continue ;
+		for (size_t j = 0; j < _channel_jobs[i].size(); j++)
+			_workers[i]->push(_channel_jobs[i][j]);
+		_channel_jobs[i].clear();
+		_workers[i]->wake();
+	}
+	waitBatch();
+	while (_batch.done.pop(job))
+	{
+		Client	*client = _clients.find(job.client);
+
+		if (client == NULL)
+			continue ;
+		if (job.failed)
+			client->setDeconnexionStatus(true);
+		if (client->getWorker() != FAILURE)
+		{
+			client->setWorker(FAILURE);
+			deferCommands(*client);
+		}
+		updateWriteInterest(*client);
+	}
+	flushDeferredWrites();
+}
+
+/**
+ * @brief Blocks until the workers are done with what they were handed.
+ */
+void	Server::waitBatch()
+{
+	uint64_t	count;
+
+	while (_batch.left.load(std::memory_order_acquire) != 0)
+	{
+		if (read(_batch.event_fd, &count, sizeof(count)) == FAILURE && errno != EINTR)
+			std::cerr << RED << "[Server] eventfd read failed" << RESET << std::endl;
+	}
+}
+
+/**
+ * @brief Flushes the clients that got replies from a worker during the
+ * 		  batch.
+ */
+void	Server::flushDeferredWrites()
+{
+	for (size_t i = 0; i < _workers.size(); i++)
+	{
+		std::vector<client_handle>	&writes = _workers[i]->getDeferredWrites();
+
+		for (size_t j = 0; j < writes.size(); j++)
+		{
+			Client	*client = _clients.find(writes[j]);
+
+			if (client != NULL && client->takeDeferredWrite())
+				flushDeferredWrite(*client);
+		}
+		writes.clear();
+	}
+}
+
+/**
+ * @brief What addToClientBuffer leaves to the core for the replies queued
+ * 		  by a channel worker.
+ */
+void	Server::flushDeferredWrite(Client &client)
+{
+	bool	exceeded;
+
+	if (client.isSendqExceeded())
+		return ;
+	{
+		std::lock_guard<std::mutex>	guard(client.getSendqLock());
+
+		exceeded = (client.getSendqSize() > client.getSendqHard());
+	}
+	if (exceeded)
+		return (sendqExceeded(client));
+	updateWriteInterest(client);
+}
+
+/**
+ * @brief Runs the first slice of a heavy command right away, which is all a
+ * 		  small network needs. If there is more, the rest runs one slice at
+ * 		  a time between the loop iterations (see runTaskSlices), and the
+ * 		  client's next commands wait for the last one, so its replies stay
+ * 		  in order.
+ */
+void	Server::scheduleTask(Client &client, SlicedTask *task)
+{
+	task->run(*this);
+	if (task->isDone())
+	{
+		delete task;
+		return ;
+	}
+	client.setTaskPending(true);
+	if (_workers.empty() == false)
+		_scheduler.push(_tasks.size() % _workers.size(), task);
+	_tasks.push_back(task);
+}
+
+/**
+ * @brief Runs one slice of every heavy command still running, between the
+ * 		  commands of two loop iterations: a large LIST no longer holds the
+ * 		  others up for the whole of it.
+ *
+ * 	With channel workers, the core does not run them: the workers do while
+ * 	it waits for events, and post each slice back (see TaskScheduler and
+ * 	resumeTask).
+ */
+void	Server::runTaskSlices()
+{
+	size_t	kept = 0;
+
+	if (_workers.empty() == false)
+		return ;
+	for (size_t i = 0; i < _tasks.size(); i++)
+	{
+		_tasks[i]->run(*this);
+		if (_tasks[i]->isDone())
+			finishTask(_tasks[i]);
+		else
+			_tasks[kept++] = _tasks[i];
+	}
+	_tasks.resize(kept);
+}
+
+/**
+ * @brief A worker ran a slice of the task: the core flushes its replies,
+ * 		  then deals it out again to the same worker, or ends it.
+ */
+void	Server::resumeTask(SlicedTask *task, unsigned worker)
+{
+	Client	*client = _clients.find(task->getClient());
+
+	if (client != NULL && client->takeDeferredWrite())
+		flushDeferredWrite(*client);
+	if (task->isDone() == false)
+		return (_scheduler.push(worker, task));
+	_tasks.erase(std::find(_tasks.begin(), _tasks.end(), task));
+	finishTask(task);
+}
+
+/**
+ * @brief Lets the client of a task that ran its last slice resume, and
+ * 		  deletes the task. The caller drops it from _tasks.
+ */
+void	Server::finishTask(SlicedTask *task)
+{
+	Client	*client = _clients.find(task->getClient());
+
+	if (client != NULL)
+	{
+		if (task->hasFailed())
+			client->setDeconnexionStatus(true);
+		client->setTaskPending(false);
+		deferCommands(*client);
+		updateWriteInterest(*client); // disconnects it if needed
+	}
+	delete task;
+}
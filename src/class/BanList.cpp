@@ -0,0 +1,198 @@
+#include "BanList.hpp"
+#include "ClientTable.hpp"
+#include <algorithm>
+
+BanList::BanList() : _version(1), _next_expiry(0) {}
+
+/* The buckets point into _bans: a copy rebuilds them around its own entries */
+BanList::BanList(BanList const &src) : _version(1), _next_expiry(0)
+{
+	*this = src;
+}
+
+BanList::~BanList() {}
+
+BanList	&BanList::operator=(BanList const &src)
+{
+	if (this == &src)
+		return (*this);
+	_bans.clear();
+	for (int i = 0; i < Hostmask::PARTS; i++)
+		_buckets[i].clear();
+	_wildcards.clear();
+	_next_expiry = 0;
+	for (std::map<std::string, ban>::const_iterator it = src._bans.begin(); it != src._bans.end(); it++)
+		insert(it->first, it->second.expiry);
+	_version++;
+	return (*this);
+}
+
+/**
+ * @brief Adds a ban on mask (completed to nick!user@host), for lifetime
+ * 		  seconds or until removed if lifetime is 0.
+ *
+ * @return false if the mask was already banned
+ */
+bool	BanList::add(std::string const &mask, uint64_t now, time_t lifetime)
+{
+	sweep(now);
+	if (insert(mask, lifetime > 0 ? now + lifetime * 1000ULL : 0) == false)
+		return (false);
+	_version++;
+	return (true);
+}
+
+bool	BanList::insert(std::string const &mask, uint64_t expiry)
+{
+	Hostmask	compiled(mask);
+	int			bucket = Hostmask::PARTS;
+
+	if (_bans.find(compiled.str()) != _bans.end())
+		return (false);
+	if (compiled.isLiteral(Hostmask::HOST))
+		bucket = Hostmask::HOST;
+	else if (compiled.isLiteral(Hostmask::NICK))
+		bucket = Hostmask::NICK;
+	else if (compiled.isLiteral(Hostmask::USER))
+		bucket = Hostmask::USER;
+
+	ban		entry = { compiled, expiry, bucket };
+	ban		*stored = &_bans.insert(std::make_pair(compiled.str(), entry)).first->second;
+
+	if (bucket == Hostmask::PARTS)
+		_wildcards.push_back(stored);
+	else
+		_buckets[bucket].insert(std::make_pair(compiled.part(bucket), stored));
+	if (expiry != 0 && (_next_expiry == 0 || expiry < _next_expiry))
+		_next_expiry = expiry;
+	return (true);
+}
+
+bool	BanList::remove(std::string const &mask)
+{
+	std::map<std::string, ban>::iterator it = _bans.find(Hostmask::normalize(mask));
+
+	if (it == _bans.end())
+		return (false);
+	unindex(&it->second);
+	_bans.erase(it);
+	_version++;
+	return (true);
+}
+
+void	BanList::unindex(ban *entry)
+{
+	if (entry->bucket == Hostmask::PARTS)
+	{
+		_wildcards.erase(std::find(_wildcards.begin(), _wildcards.end(), entry));
+		return ;
+	}
+
+	bucket_map	&bucket = _buckets[entry->bucket];
+	std::pair<bucket_map::iterator, bucket_map::iterator> range = bucket.equal_range(entry->mask.part(entry->bucket));
+
+	for (bucket_map::iterator it = range.first; it != range.second; it++)
+	{
+		if (it->second == entry)
+		{
+			bucket.erase(it);
+			return ;
+		}
+	}
+}
+
+/**
+ * @brief Drops the bans expired at now.
+ */
+void	BanList::sweep(uint64_t now)
+{
+	if (_next_expiry == 0 || now < _next_expiry)
+		return ;
+	_next_expiry = 0;
+
+	std::map<std::string, ban>::iterator it = _bans.begin();
+	while (it != _bans.end())
+	{
+		uint64_t expiry = it->second.expiry;
+
+		if (expiry != 0 && expiry <= now)
+		{
+			unindex(&it->second);
+			_bans.erase(it++);
+			continue ;
+		}
+		if (expiry != 0 && (_next_expiry == 0 || expiry < _next_expiry))
+			_next_expiry = expiry;
+		it++;
+	}
+	_version++;
+}
+
+bool	BanList::matchBucket(int part, std::string const nuh[], uint64_t now) const
+{
+	std::pair<bucket_map::const_iterator, bucket_map::const_iterator> range = _buckets[part].equal_range(nuh[part]);
+
+	for (bucket_map::const_iterator it = range.first; it != range.second; it++)
+	{
+		ban const	&entry = *it->second;
+
+		if (entry.expiry != 0 && entry.expiry <= now)
+			continue ;
+		if (entry.mask.matches(nuh[Hostmask::NICK], nuh[Hostmask::USER], nuh[Hostmask::HOST]))
+			return (true);
+	}
+	return (false);
+}
+
+/**
+ * @brief Whether any ban in effect matches nick!user@host. The three parts
+ * 		  are casemapped here.
+ */
+bool	BanList::matches(std::string const &nick, std::string const &user, std::string const &host, uint64_t now) const
+{
+	std::string	nuh[Hostmask::PARTS];
+
+	if (_bans.empty())
+		return (false);
+	nuh[Hostmask::NICK] = casemapNickname(nick);
+	nuh[Hostmask::USER] = casemapNickname(user);
+	nuh[Hostmask::HOST] = casemapNickname(host);
+	for (int part = 0; part < Hostmask::PARTS; part++)
+	{
+		if (matchBucket(part, nuh, now))
+			return (true);
+	}
+	for (size_t i = 0; i < _wildcards.size(); i++)
+	{
+		ban const	&entry = *_wildcards[i];
+
+		if (entry.expiry != 0 && entry.expiry <= now)
+			continue ;
+		if (entry.mask.matches(nuh[Hostmask::NICK], nuh[Hostmask::USER], nuh[Hostmask::HOST]))
+			return (true);
+	}
+	return (false);
+}
+
+/**
+ * @brief Changes whenever a ban is added, removed or expires.
+ */
+unsigned	BanList::getVersion(uint64_t now)
+{
+	sweep(now);
+	return (_version);
+}
+
+std::vector<std::string>	BanList::getMasks(uint64_t now) const
+{
+	std::vector<std::string>	masks;
+
+	for (std::map<std::string, ban>::const_iterator it = _bans.begin(); it != _bans.end(); it++)
+	{
+		if (it->second.expiry == 0 || it->second.expiry > now)
+			masks.push_back(it->first);
+	}
+	return (masks);
+}
+
+size_t	BanList::size() const	{ return (_bans.size()); }
@@ -1,9 +1,8 @@
 #include "Channel.hpp"
 
-Channel::Channel(std::string const &channelName): _name(channelName) 
+Channel::Channel(std::string const &channelName): _operator_count(0), _name(channelName), _mode(0) 
 {
-	_banned_users.clear();
-	_clientList.clear();
+	_members.clear();
 	_topic.clear();
 }
 
@@ -11,12 +10,8 @@ Channel::~Channel() {}
 
 std::string&						Channel::getName() 			{ return (_name); }
 std::string&						Channel::getTopic() 		{ return (_topic); }
-std::string&						Channel::getMode()			{ return (_mode); }
 std::string&						Channel::getChannelPassword()	{ return (_channel_password); }
-std::map <std::string, Client>&		Channel::getClientList()	{ return (_clientList); }
-std::vector<std::string>&			Channel::getBannedUsers()	{ return (_banned_users); }
-std::vector<std::string>&			Channel::getKickedUsers()	{ return (_kicked_users); }
-std::vector<std::string>&			Channel::getOperators() 	{ return (_operators); }
+member_list&						Channel::getMembers()		{ return (_members); }
 
 void		Channel::setTopic(std::string& newTopic)
 {
@@ -28,156 +23,182 @@ void		Channel::setChannelPassword(std::string password)
 	_channel_password = password;
 }
 
-bool		Channel::doesClientExist(std::string &clientName)
+bool		Channel::doesClientExist(int client_fd)
 {	
-	if (_clientList.size() == 0)
-		return (false);
-
-	std::map <std::string, Client>::iterator it = _clientList.find(clientName);
-	if (it == _clientList.end())
-		return (false);
-	return (true);
+	return (_members.find(client_fd) != _members.end());
 }
 
 void	Channel::printClientList()
 {
 	std::cout <<  "Here is the Client list of the Channel " << YELLOW << this->getName() << RESET << std::endl;
-	for (std::map <std::string, Client>::iterator it = _clientList.begin(); \
-		 it != _clientList.end(); it++)
-		std::cout << it->first << std::endl;
+	for (member_list::iterator it = _members.begin(); it != _members.end(); it++)
+		std::cout << "fd " << it->first << std::endl;
 }
 
 /**
- * @brief Removes a Client from the ClientList of the Channel.
- * 		  Also strips this Client of the Operator privileges.
+ * @brief Removes a Client from the members of the Channel, which also strips
+ * 		  it of the Operator privileges.
  * 
- * @param clientName 
+ * @param client_fd 
  */
-void	Channel::removeClientFromChannel(std::string &clientName)
+void	Channel::removeClientFromChannel(int client_fd)
 {
-	std::map <std::string, Client>::iterator it = this->_clientList.find(clientName);
-	if (it != _clientList.end())
-		this->_clientList.erase(it);
-	
-	// This function checks if the ClientName is present in the Operator list
-	// and if so, deletes it.
-	removeOperator(clientName); 
+	member_list::iterator it = _members.find(client_fd);
+	if (it == _members.end())
+		return ;
+	if (it->second.flags & MEMBER_OPERATOR)
+		_operator_count--;
+	_members.erase(it);
 }
 
-void	Channel::addClientToChannel(Client &client)
+void	Channel::addClientToChannel(client_handle handle)
 {
-	_clientList.insert(std::pair<std::string, Client>(client.getNickname(), client));
+	channel_member	member = { handle, 0, 0 };
+
+	_members.insert(std::make_pair(handle.fd, member));
 }
 
-void	Channel::addToKicked(std::string &kicked_name)
+/**
+ * @brief Remembers that the user was kicked, for lifetime seconds (0: until
+ * 		  the channel is gone). now is the server clock (Server::getNow()).
+ */
+void	Channel::addToKicked(std::string &kicked_name, uint64_t now, time_t lifetime)
 {
-	std::vector<std::string>::iterator it;
-	for (it = _kicked_users.begin(); it != _kicked_users.end(); it++)
+	if (_kicked_users.insert(casemapNickname(kicked_name), now, lifetime) == false)
 	{
-		if (*it == kicked_name)
-		{
-			std::cout << kicked_name << " is already kicked from the channel " << getName() << std::endl;
-			return ;
-		}
+		std::cout << kicked_name << " is already kicked from the channel " << getName() << std::endl;
+		return ;
 	}
-	_kicked_users.push_back(kicked_name);
 	std::cout << RED << kicked_name << " is now kicked from the channel " << getName() << RESET << std::endl;
 }
 
-void	Channel::addToBanned(std::string &banned_name)
+bool	Channel::isKicked(std::string &kicked_name, uint64_t now)
 {
-	std::vector<std::string>::iterator it;
-	for (it = _banned_users.begin(); it != _banned_users.end(); it++)
+	return (_kicked_users.contains(casemapNickname(kicked_name), now));
+}
+
+/**
+ * @brief Drops the kicks and bans that expired, which lookups alone would
+ * 		  only drop once somebody asks about them again.
+ */
+void	Channel::sweepExpired(uint64_t now)
+{
+	_kicked_users.sweep(now);
+	_bans.sweep(now);
+}
+
+bool	Channel::addToBanned(std::string &banned_mask, uint64_t now, time_t lifetime)
+{
+	if (_bans.add(banned_mask, now, lifetime) == false)
 	{
-		if (*it == banned_name)
-		{
-			std::cout << banned_name << " is already banned from the channel " << getName() << std::endl;
-			return ;
-		}
+		std::cout << banned_mask << " is already banned from the channel " << getName() << std::endl;
+		return (false);
 	}
-	_banned_users.push_back(banned_name);
-	std::cout << RED << banned_name << " is now banned from the channel " << getName() << RESET << std::endl;
+	std::cout << RED << banned_mask << " is now banned from the channel " << getName() << RESET << std::endl;
+	return (true);
 }
 
-void	Channel::removeFromBanned(std::string &banned_name)
+bool	Channel::removeFromBanned(std::string &banned_mask)
 {
-	std::vector<std::string>::iterator user;
-	for (user = _banned_users.begin(); user != _banned_users.end(); user++)
+	if (_bans.remove(banned_mask) == true)
 	{
-		if (*user == banned_name)
-		{
-			_banned_users.erase(user);
-			std::cout << banned_name << " is not banned anymore from the channel " << getName() << std::endl;
-			return ;
-		}
+		std::cout << banned_mask << " is not banned anymore from the channel " << getName() << std::endl;
+		return (true);
 	}
-	std::cout << "No need! " << banned_name << " has never been banned from the channel " << getName() << std::endl;
+	std::cout << "No need! " << banned_mask << " has never been banned from the channel " << getName() << std::endl;
+	return (false);
 }
 
-bool	Channel::isBanned(std::string &banned_name)
+/**
+ * @brief Checks the client against the ban masks. For a member, the result
+ * 		  is kept until the ban list changes or forgetBanCheck() is called
+ * 		  (its nickname changed), so talking in the channel does not match
+ * 		  every mask again.
+ */
+bool	Channel::isBanned(Client &client, uint64_t now)
 {
-	std::vector<std::string>::iterator user;
-	if (_banned_users.empty() == true)
-		return (false);
-	for (user = _banned_users.begin(); user != _banned_users.end(); user++)
+	member_list::iterator	it = _members.find(client.getClientFd());
+	unsigned				version = _bans.getVersion(now);
+	bool					banned;
+
+	if (it != _members.end() && it->second.ban_version == version)
+		return (it->second.flags & MEMBER_BANNED);
+	banned = _bans.matches(client.getNickname(), client.getUsername(), client.getHostname(), now);
+	if (it != _members.end())
 	{
-		if (*user == banned_name)
-			return (true);
+		it->second.ban_version = version;
+		if (banned)
+			it->second.flags |= MEMBER_BANNED;
+		else
+			it->second.flags &= ~MEMBER_BANNED;
 	}
-	return (false);	
+	return (banned);
 }
 
-void	Channel::addFirstOperator(std::string operatorName)
+void	Channel::forgetBanCheck(int client_fd)
 {
-	if (_operators.empty())
-		_operators.push_back(operatorName);
+	member_list::iterator it = _members.find(client_fd);
+
+	if (it != _members.end())
+		it->second.ban_version = 0;
 }
 
-void	Channel::removeOperator(std::string operatorName)
+std::vector<std::string>	Channel::getBanMasks(uint64_t now) const
 {
-	std::vector<std::string>::iterator it;
-	for (it = _operators.begin(); it != _operators.end(); it++)
-	{
-		if (*it == operatorName)
-			_operators.erase(it);
-	}
+	return (_bans.getMasks(now));
 }
 
-bool 	Channel::isOperator(std::string &operatorName)
+/**
+ * @brief Gives the Operator privileges to the member if the channel has no
+ * 		  operator left (e.g. its first member).
+ */
+void	Channel::addFirstOperator(int client_fd)
 {
-	std::vector<std::string>::iterator user;
-	if (_operators.empty())
-		return (false);
-	for (user = _operators.begin(); user != _operators.end(); user++)
-	{
-		if (*user == operatorName)
-			return (true);
-	}
-	return (false);
+	if (_operator_count == 0)
+		setOperator(client_fd, true);
 }
 
-void	Channel::printOperators(void)
+void	Channel::setOperator(int client_fd, bool is_operator)
 {
-	std::cout << "Print operators : \n";
-	std::vector<std::string>::iterator it;
-	for (it = _operators.begin(); it != _operators.end(); it++)
+	member_list::iterator it = _members.find(client_fd);
+	if (it == _members.end() || ((it->second.flags & MEMBER_OPERATOR) != 0) == is_operator)
+		return ;
+	if (is_operator)
 	{
-		std::cout << *it << std::endl;
+		it->second.flags |= MEMBER_OPERATOR;
+		_operator_count++;
 	}
+	else
+	{
+		it->second.flags &= ~MEMBER_OPERATOR;
+		_operator_count--;
+	}
+}
+
+bool 	Channel::isOperator(int client_fd)
+{
+	member_list::iterator it = _members.find(client_fd);
+	return (it != _members.end() && (it->second.flags & MEMBER_OPERATOR));
+}
+
+bool	Channel::hasMode(mode_set mode) const
+{
+	return ((_mode & mode) != 0);
+}
+
+void	Channel::addMode(mode_set mode)
+{
+	_mode |= mode;
 }
 
-void	Channel::addMode(std::string const mode)
+void	Channel::removeMode(mode_set mode)
 {
-	if (_mode.empty() == true)
-		_mode = "+" + mode;
-	else 
-		_mode += mode;
+	_mode &= ~mode;
 }
 
-void	Channel::removeMode(std::string const mode)
+std::string	Channel::getModeString() const
 {
-	size_t pos = _mode.find(mode);
-	_mode.erase(pos, 1);
+	return (channelModeString(_mode));
 }
 
 void	Channel::removeChannelPassword()
@@ -0,0 +1,177 @@
+#include "ChannelWorker.hpp"
+#include "Server.hpp"
+#include "Commands.hpp"
+#include <sys/eventfd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+
+thread_local ChannelWorker	*ChannelWorker::_current = NULL;
+
+ChannelWorker::ChannelWorker(unsigned index, Server &server, channel_batch &batch, Mailbox &core)
+: _index(index), _server(server), _batch(batch), _core(core), _wake_fd(FAILURE), _running(false)
+{
+}
+
+ChannelWorker::~ChannelWorker()
+{
+	stop();
+	if (_wake_fd != FAILURE)
+		close(_wake_fd);
+}
+
+/**
+ * @brief The worker running on this thread, NULL on the core.
+ */
+ChannelWorker	*ChannelWorker::current()	{ return (_current); }
+
+std::vector<client_handle>	&ChannelWorker::getDeferredWrites()	{ return (_deferred_writes); }
+
+int		ChannelWorker::start()
+{
+	sigset_t	blocked;
+	sigset_t	previous;
+
+	_wake_fd = eventfd(0, EFD_CLOEXEC);
+	if (_wake_fd == FAILURE)
+		return (FAILURE);
+	// SIGINT is for the core loop
+	sigemptyset(&blocked);
+	sigaddset(&blocked, SIGINT);
+	sigaddset(&blocked, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	_running = true;
+	_thread = std::thread(&ChannelWorker::run, this);
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	return (SUCCESS);
+}
+
+void	ChannelWorker::stop()
+{
+	if (_thread.joinable() == false)
+		return ;
+	_running = false;
+	wake();
+	_thread.join();
+}
+
+/**
+ * @brief Queues a job, which only runs once the worker is woken up.
+ */
+void	ChannelWorker::push(channel_job const &job)	{ _jobs.push(job); }
+
+void	ChannelWorker::wake()
+{
+	uint64_t	one = 1;
+
+	if (write(_wake_fd, &one, sizeof(one)) == FAILURE)
+		std::cerr << "[Worker " << _index << "] eventfd write failed" << std::endl;
+}
+
+void	ChannelWorker::run()
+{
+	channel_job	job;
+	uint64_t	count;
+
+	_current = this;
+	while (true)
+	{
+		if (read(_wake_fd, &count, sizeof(count)) == FAILURE)
+		{
+			if (errno == EINTR)
+				continue ;
+			std::cerr << RED << "[Worker " << _index << "] eventfd read failed" << RESET << std::endl;
+			return ;
+		}
+		if (_running == false)
+			return ;
+		while (_jobs.pop(job))
+			runJob(job);
+		runTasks();
+	}
+}
+
+/**
+ * @brief Runs slices for as long as there are tasks queued and the core
+ * 		  lets go of the server state. A slice only replies to the client
+ * 		  of its task, which the core flushes when it gets the task back:
+ * 		  its deferred writes are dropped here.
+ */
+void	ChannelWorker::runTasks()
+{
+	TaskScheduler	&scheduler = _server.getScheduler();
+	SlicedTask		*task;
+	shard_message	message;
+
+	message.type = WORKER_SLICE;
+	message.fd = FAILURE;
+	message.target = NULL;
+	message.shard = _index;
+	while (scheduler.tryShareState())
+	{
+		size_t	writes = _deferred_writes.size();
+
+		if (scheduler.next(_index, task) == false)
+		{
+			scheduler.unshareState();
+			return ;
+		}
+		task->run(_server);
+		_deferred_writes.resize(writes);
+		scheduler.unshareState();
+		message.client = task->getClient();
+		message.task = task;
+		_core.post(message);
+	}
+}
+
+/**
+ * @brief Runs the command as the core would have, then reports it.
+ */
+void	ChannelWorker::runJob(channel_job &job)
+{
+	Client	*client = _server.getClients().find(job.client);
+
+	if (client != NULL && client->getDeconnexionStatus() == false) // else it left in the meantime
+	{
+		cmd_struct	cmd_infos;
+
+		try
+		{
+			if (parseCommand(job.line, cmd_infos) == SUCCESS)
+				_server.execCommand(job.client.fd, cmd_infos);
+		}
+		catch(const std::exception& e)
+		{
+			std::cerr << "[Worker " << _index << "] Caught exception : " << e.what() << std::endl;
+			job.failed = true;
+		}
+	}
+	_batch.done.push(job);
+	reportDone();
+}
+
+/**
+ * @brief Counts a job as done. The last one of the batch wakes
+ * 		  the core up.
+ */
+void	ChannelWorker::reportDone()
+{
+	if (_batch.left.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		uint64_t	one = 1;
+
+		if (write(_batch.event_fd, &one, sizeof(one)) == FAILURE)
+			std::cerr << "[Worker " << _index << "] eventfd write failed" << std::endl;
+	}
+}
+
+/**
+ * @brief Remembers that the client got replies, once per batch: the core
+ * 		  checks its send queue limits and flushes it after the batch.
+ */
+void	ChannelWorker::deferWrite(Client &client)
+{
+	if (client.deferWrite())
+		_deferred_writes.push_back(_server.getClients().getHandle(client.getClientFd()));
+}
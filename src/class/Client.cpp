@@ -1,8 +1,12 @@
 #include "Client.hpp"
+#include <algorithm>
 
 Client::Client(int client_fd)
-: _client_fd(client_fd), _to_deconnect(false), _connexion_password(false),\
- _registrationDone(false), _welcomeSent(false), _hasAllInfo(false)
+: _client_fd(client_fd), _shard(-1), _send_offset(0), _sendq_size(0), _sendq_peak(0), _sendq_soft(DEFAULT_SENDQ_SOFT),\
+ _sendq_hard(DEFAULT_SENDQ_HARD), _sendq_exceeded(false), _write_interest(false), _to_deconnect(false), _mode(0), _connexion_password(false),\
+ _registrationDone(false), _welcomeSent(false), _hasAllInfo(false), _last_activity(0), _ping_sent(0),\
+ _deficit(0), _budget_round(0), _backlogged(false), _unread_input(false), _throttled(false), _worker(-1), _task_pending(false), _write_deferred(false),\
+ _input_signaled(false), _flush_signaled(false), _input_stalled(false), _close_signaled(false)
 {
 	std::cout << YELLOW << "Client constructor for Client #" << client_fd << RESET << std::endl;
 }
@@ -13,13 +17,14 @@ Client::~Client()
 }
 
 int				Client::getClientFd() const { return (_client_fd); }
-std::string&	Client::getSendBuffer()  	{ return (_sendbuf); }
-std::string&	Client::getReadBuffer()  	{ return (_readbuf); }
+RingBuffer&		Client::getReadBuffer()  	{ return (_readbuf); }
+InputTimeline&	Client::getTimeline()  	{ return (_timeline); }
 std::string&	Client::getNickname()  		{ return (_nickname); }
 std::string&	Client::getOldNickname()  	{ return (_old_nickname); }
 std::string 	Client::getUsername() const { return (_username); }
 std::string		Client::getRealname() const { return (_realname); }
-std::string&	Client::getMode()			{ return (_mode); }
+std::set<std::string>&	Client::getJoinedChannels()	{ return (_joined_channels); }
+std::mutex&		Client::getJoinedLock()		{ return (_joined_lock); }
 
 bool&			Client::getConnexionPassword()	{ return (_connexion_password); }
 bool&			Client::isRegistrationDone() 	{ return (_registrationDone); }
@@ -27,14 +32,182 @@ bool&			Client::isWelcomeSent()			{ return (_welcomeSent); }
 bool&			Client::hasAllInfo() 			{ return (_hasAllInfo); }
 bool&			Client::getDeconnexionStatus()	{ return (_to_deconnect); }
 
-void	Client::setReadBuffer(std::string const &buf)
+/**
+ * @brief Frames the complete lines of the read buffer into the timeline, as
+ * 		  long as it has room for them, stamped with now. The read buffer
+ * 		  keeps their bytes until the core has run them: it is released up
+ * 		  to the oldest line still waiting. Only the side reading the socket
+ * 		  calls it (the producer of the timeline): the shard, or the core
+ * 		  without shards.
+ *
+ * @param full Set if nothing more can be framed or received before the
+ * 		  core pops lines: the timeline or the read buffer is full
+ * @return size_t Number of lines framed
+ */
+size_t	Client::frameInput(uint64_t now, bool &full)
 {
-	_readbuf += buf;
+	str_view	line;
+	str_view	first;
+	str_view	second;
+	size_t		count = 0;
+	size_t		pin;
+	int			status;
+
+	while ((full = _timeline.full()) == false)
+	{
+		pin = _readbuf.position();
+		if ((status = _readbuf.nextLine(line)) == RingBuffer::NO_LINE)
+			break ;
+		if (status == RingBuffer::LINE_TOO_LONG) // nothing of it is kept
+			_timeline.appendTooLong(now, _readbuf.position());
+		else
+		{
+			_readbuf.lastLineParts(first, second);
+			_timeline.append(now, pin, line, first, second);
+		}
+		count++;
+	}
+	_readbuf.release(_timeline.pinnedFrom(_readbuf.position()));
+	if (_readbuf.available() == 0)
+		full = true;
+	return (count);
+}
+
+/**
+ * @brief The next line to run, from the front of the timeline.
+ *
+ * @return false if no complete line is waiting
+ */
+bool	Client::frontInput(timeline_entry &entry)
+{
+	return (_timeline.front(entry));
+}
+
+/**
+ * @brief Releases the line from frontInput() once its command has run.
+ * 		  Without a shard the core is the producer too, and frees its
+ * 		  bytes right away.
+ */
+void	Client::popInput()
+{
+	_timeline.pop();
+	if (_shard == FAILURE)
+		_readbuf.release(_timeline.pinnedFrom(_readbuf.position()));
+}
+
+/**
+ * @brief Drops every line received and not run yet (the client leaves).
+ */
+void	Client::clearInput()
+{
+	_timeline.clear();
+	if (_shard == FAILURE)
+		_readbuf.clear();
+}
+
+/**
+ * @brief Queues a reference to buf: a line fanned out to a whole channel is
+ * 		  serialized once and shared by the queues of all its members.
+ */
+void	Client::setSendBuffer(shared_buffer const &buf)
+{
+	if (buf && buf->empty() == false)
+	{
+		_sendq.push_back(buf);
+		_sendq_size += buf->size();
+		_sendq_peak = std::max(_sendq_peak, _sendq_size);
+	}
+}
+
+bool	Client::hasPendingData() const		{ return (_sendq.empty() == false); }
+
+bool	Client::hasWriteInterest() const	{ return (_write_interest); }
+
+void	Client::setWriteInterest(bool interest)
+{
+	_write_interest = interest;
+}
+
+/**
+ * @brief Describes the unsent part of the send queue for writev(), starting
+ * 		  after what a previous partial write already sent.
+ *
+ * @return int Number of entries filled, at most iovcnt
+ */
+int		Client::getSendIovec(struct iovec *iov, int iovcnt) const
+{
+	std::deque<shared_buffer>::const_iterator	it = _sendq.begin();
+	size_t										offset = _send_offset;
+	int											count = 0;
+
+	for (; it != _sendq.end() && count < iovcnt; it++, count++)
+	{
+		iov[count].iov_base = const_cast<char *>((*it)->data()) + offset;
+		iov[count].iov_len = (*it)->size() - offset;
+		offset = 0;
+	}
+	return (count);
+}
+
+/**
+ * @brief Marks len more bytes of the send queue as written and releases the
+ * 		  buffers that have been sent completely.
+ */
+void	Client::consumeSendBuffer(size_t len)
+{
+	_sendq_size -= std::min(len, _sendq_size);
+	while (len > 0 && _sendq.empty() == false)
+	{
+		size_t left = _sendq.front()->size() - _send_offset;
+
+		if (len < left)
+		{
+			_send_offset += len;
+			return ;
+		}
+		len -= left;
+		_send_offset = 0;
+		_sendq.pop_front();
+	}
+}
+
+/**
+ * @brief Forgets every queued reply, except the one a partial write already
+ * 		  started (cutting it would garble the line the client receives).
+ */
+void	Client::dropSendBuffer()
+{
+	if (_send_offset > 0)
+		_sendq.erase(_sendq.begin() + 1, _sendq.end());
+	else
+		_sendq.clear();
+	_sendq_size = _sendq.empty() ? 0 : _sendq.front()->size() - _send_offset;
 }
 
-void	Client::setSendBuffer(std::string const &buf)
+size_t	Client::getSendqSize() const	{ return (_sendq_size); }
+size_t	Client::getSendqPeak() const	{ return (_sendq_peak); }
+size_t	Client::getSendqSoft() const	{ return (_sendq_soft); }
+size_t	Client::getSendqHard() const	{ return (_sendq_hard); }
+bool	Client::isSendqExceeded() const	{ return (_sendq_exceeded); }
+
+void	Client::setSendqLimits(size_t soft, size_t hard)
+{
+	_sendq_soft = soft;
+	_sendq_hard = hard;
+}
+
+/**
+ * @brief Whether the client reads too slowly for more than the replies it
+ * 		  asked for one by one: bulk replies (e.g. LIST) stop here.
+ */
+bool	Client::isSendqCongested() const
 {
-	_sendbuf += buf;
+	return (_sendq_size >= _sendq_soft);
+}
+
+void	Client::setSendqExceeded(bool exceeded)
+{
+	_sendq_exceeded = exceeded;
 }
 
 void	Client::setDeconnexionStatus(bool status)
@@ -63,18 +236,34 @@ void	Client::setRealname(std::string const &realname)
 	_realname = realname;
 }
 
-void	Client::addMode(std::string const mode)
+void	Client::setAddress(ip_address const &address)
+{
+	_address = address;
+	_hostname = addressToString(address);
+}
+
+ip_address const	&Client::getAddress() const	{ return (_address); }
+
+std::string const	&Client::getHostname() const	{ return (_hostname); }
+
+bool	Client::hasMode(mode_set mode) const
+{
+	return ((_mode & mode) != 0);
+}
+
+void	Client::addMode(mode_set mode)
+{
+	_mode |= mode;
+}
+
+void	Client::removeMode(mode_set mode)
 {
-	if (_mode.empty() == true)
-		_mode = "+" + mode;
-	else 
-		_mode += mode;
+	_mode &= ~mode;
 }
 
-void	Client::removeMode(std::string const mode)
+std::string	Client::getModeString() const
 {
-	size_t pos = _mode.find(mode);
-	_mode.erase(pos, 1);
+	return (userModeString(_mode));
 }
 
 void	Client::setConnexionPassword(bool boolean)
@@ -97,6 +286,120 @@ void	Client::sethasAllInfo(bool boolean)
 	_hasAllInfo = boolean;
 }
 
+uint64_t	Client::getLastActivity() const	{ return (_last_activity); }
+uint64_t	Client::getPingSent() const		{ return (_ping_sent); }
+
+void	Client::setLastActivity(uint64_t now)
+{
+	_last_activity = now;
+}
+
+void	Client::setPingSent(uint64_t now)
+{
+	_ping_sent = now;
+}
+
+/**
+ * @brief Gives the client its quantum once per round of the server loop.
+ * 		  A debt (commands run over budget) is carried over, an unused
+ * 		  budget is not: a quiet client cannot save up for a burst.
+ */
+void	Client::refillBudget(unsigned long round, int quantum)
+{
+	if (_budget_round == round)
+		return ;
+	_budget_round = round;
+	_deficit = std::min(_deficit, 0) + quantum;
+}
+
+bool	Client::hasBudget() const	{ return (_deficit > 0); }
+
+void	Client::spendBudget(unsigned cost)
+{
+	_deficit -= static_cast<int>(cost);
+}
+
+bool	Client::isBacklogged() const	{ return (_backlogged); }
+bool	Client::hasUnreadInput() const	{ return (_unread_input); }
+std::string&	Client::getPendingInput()	{ return (_pending_input); }
+
+void	Client::setBacklogged(bool backlogged)
+{
+	_backlogged = backlogged;
+}
+
+void	Client::setUnreadInput(bool unread)
+{
+	_unread_input = unread;
+}
+
+int		Client::getShard() const	{ return (_shard); }
+std::mutex&	Client::getSendqLock()	{ return (_sendq_lock); }
+
+void	Client::setShard(int shard)
+{
+	_shard = shard;
+}
+
+/*
+ * Each signal is raised by one side and taken by the other. Raising returns
+ * true only if it was down, so a burst of input or replies costs a single
+ * message; taking it first means anything raised afterwards is seen.
+ */
+bool	Client::signalInput()		{ return (_input_signaled.exchange(true, std::memory_order_acq_rel) == false); }
+void	Client::takeInputSignal()	{ _input_signaled.exchange(false, std::memory_order_acq_rel); }
+bool	Client::signalFlush()		{ return (_flush_signaled.exchange(true, std::memory_order_acq_rel) == false); }
+void	Client::takeFlushSignal()	{ _flush_signaled.exchange(false, std::memory_order_acq_rel); }
+bool	Client::isCloseSignaled() const	{ return (_close_signaled); }
+void	Client::setCloseSignaled()	{ _close_signaled = true; }
+
+/**
+ * @brief The shard stops reading until the core has run some lines. Both
+ * 		  sides fence between their own update and their check of the other
+ * 		  side's, so at least one of them sees the other and no wakeup is
+ * 		  lost (see ReactorShard::readInput and Server::processReadBuffer).
+ */
+void	Client::setInputStalled()
+{
+	_input_stalled.store(true);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+bool	Client::takeInputStalled()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	return (_input_stalled.exchange(false));
+}
+
+LagCompensation&	Client::getFlood()	{ return (_flood); }
+bool	Client::isThrottled() const	{ return (_throttled); }
+
+void	Client::setThrottled(bool throttled)
+{
+	_throttled = throttled;
+}
+
+int		Client::getWorker() const	{ return (_worker); }
+
+void	Client::setWorker(int worker)
+{
+	_worker = worker;
+}
+
+bool	Client::hasTaskPending() const	{ return (_task_pending); }
+
+void	Client::setTaskPending(bool pending)
+{
+	_task_pending = pending;
+}
+
+/*
+ * Raised by the channel workers that queue replies for the client, taken by
+ * the core after the batch: only the first worker records the client.
+ */
+bool	Client::deferWrite()		{ return (_write_deferred.exchange(true, std::memory_order_acq_rel) == false); }
+bool	Client::takeDeferredWrite()	{ return (_write_deferred.exchange(false, std::memory_order_acq_rel)); }
+
 void	Client::printClient()const
 {
 	std::cout << "Print client" << std::endl;
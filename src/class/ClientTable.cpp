@@ -0,0 +1,145 @@
+#include "ClientTable.hpp"
+#include <algorithm>
+
+ClientTable::ClientTable() {}
+
+ClientTable::~ClientTable()
+{
+	for (size_t i = 0; i < _live.size(); i++)
+		delete _live[i];
+}
+
+/**
+ * @brief Creates the Client of a newly accepted fd.
+ *
+ * @return Client* NULL if the fd is invalid or already in use
+ */
+Client*			ClientTable::insert(int fd)
+{
+	if (fd < 0)
+		return (NULL);
+	if (static_cast<size_t>(fd) >= _slots.size())
+	{
+		slot	empty = { NULL, 0, 0 };
+
+		_slots.resize(std::max(static_cast<size_t>(fd) + 1, _slots.size() * 2), empty);
+	}
+
+	slot &entry = _slots[fd];
+
+	if (entry.client != NULL)
+		return (NULL);
+	entry.client = new Client(fd);
+	entry.live_index = _live.size();
+	_live.push_back(entry.client);
+	return (entry.client);
+}
+
+void			ClientTable::erase(int fd)
+{
+	Client *client = find(fd);
+
+	if (client == NULL)
+		return ;
+
+	slot	&entry = _slots[fd];
+	Client	*last = _live.back();
+
+	_live[entry.live_index] = last;
+	_slots[last->getClientFd()].live_index = entry.live_index;
+	_live.pop_back();
+	if (findByNickname(client->getNickname()) == client)
+		_nicknames.erase(casemapNickname(client->getNickname()));
+	entry.client = NULL;
+	entry.generation++;
+	delete client;
+}
+
+Client*			ClientTable::find(int fd) const
+{
+	if (fd < 0 || static_cast<size_t>(fd) >= _slots.size())
+		return (NULL);
+	return (_slots[fd].client);
+}
+
+/**
+ * @brief Same as find(fd), unless the connection the handle was taken from
+ * 		  has been closed since.
+ */
+Client*			ClientTable::find(client_handle const &handle) const
+{
+	Client *client = find(handle.fd);
+
+	if (client == NULL || _slots[handle.fd].generation != handle.generation)
+		return (NULL);
+	return (client);
+}
+
+client_handle	ClientTable::getHandle(int fd) const
+{
+	client_handle handle = { fd, 0 };
+
+	if (find(fd) != NULL)
+		handle.generation = _slots[fd].generation;
+	return (handle);
+}
+
+size_t			ClientTable::size() const	{ return (_live.size()); }
+
+/**
+ * @brief One past the highest fd the table has a slot for: walking the fds
+ * 		  below it with find() visits every client, in a stable order.
+ */
+size_t			ClientTable::capacity() const	{ return (_slots.size()); }
+
+ClientTable::iterator	ClientTable::begin()	{ return (_live.begin()); }
+
+ClientTable::iterator	ClientTable::end()		{ return (_live.end()); }
+
+Client*			ClientTable::findByNickname(std::string const &nickname) const
+{
+	std::unordered_map<std::string, Client*>::const_iterator it;
+
+	it = _nicknames.find(casemapNickname(nickname));
+	if (it == _nicknames.end())
+		return (NULL);
+	return (it->second);
+}
+
+/**
+ * @brief Gives a nickname to a client, releasing its previous one, unless
+ * 		  another client already holds it (ignoring case).
+ *
+ * @return false if the nickname is in use, nothing is changed then
+ */
+bool			ClientTable::setNickname(Client *client, std::string const &nickname)
+{
+	std::string	key = casemapNickname(nickname);
+	Client		*&owner = _nicknames[key];
+
+	if (owner != NULL && owner != client)
+		return (false);
+	if (owner == NULL && findByNickname(client->getNickname()) == client)
+		_nicknames.erase(casemapNickname(client->getNickname()));
+	owner = client;
+	client->setNickname(nickname);
+	return (true);
+}
+
+/**
+ * @brief Lower-cases a nickname the way RFC 1459 compares them: {|}~ are
+ * 		  the lower-case forms of [\]^.
+ */
+std::string		casemapNickname(std::string const &nickname)
+{
+	std::string	folded(nickname);
+
+	for (size_t i = 0; i < folded.size(); i++)
+	{
+		char c = folded[i];
+
+		if (c >= 'A' && c <= '^')
+			folded[i] = c + ('a' - 'A');
+	}
+	return (folded);
+}
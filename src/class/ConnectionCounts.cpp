@@ -0,0 +1,57 @@
+#include "ConnectionCounts.hpp"
+
+ConnectionCounts::ConnectionCounts() {}
+
+ConnectionCounts::~ConnectionCounts() {}
+
+static ip_address	sitePrefix(ip_address const &ip)
+{
+	ip_address	prefix = ip;
+
+	maskAddress(prefix, IPV6_SITE_PREFIX);
+	return (prefix);
+}
+
+static unsigned	count(std::unordered_map<ip_address, unsigned, ip_address_hash> const &counts, ip_address const &key)
+{
+	std::unordered_map<ip_address, unsigned, ip_address_hash>::const_iterator it = counts.find(key);
+
+	return (it == counts.end() ? 0 : it->second);
+}
+
+static void	decrement(std::unordered_map<ip_address, unsigned, ip_address_hash> &counts, ip_address const &key)
+{
+	std::unordered_map<ip_address, unsigned, ip_address_hash>::iterator it = counts.find(key);
+
+	if (it != counts.end() && --it->second == 0)
+		counts.erase(it);
+}
+
+unsigned	ConnectionCounts::perAddress(ip_address const &ip) const
+{
+	return (count(_per_address, ip));
+}
+
+/**
+ * @return the connections from the /64 of ip, or from ip itself for IPv4
+ */
+unsigned	ConnectionCounts::perPrefix(ip_address const &ip) const
+{
+	if (ip.isV4())
+		return (perAddress(ip));
+	return (count(_per_prefix, sitePrefix(ip)));
+}
+
+void	ConnectionCounts::add(ip_address const &ip)
+{
+	_per_address[ip]++;
+	if (ip.isV4() == false)
+		_per_prefix[sitePrefix(ip)]++;
+}
+
+void	ConnectionCounts::remove(ip_address const &ip)
+{
+	decrement(_per_address, ip);
+	if (ip.isV4() == false)
+		decrement(_per_prefix, sitePrefix(ip));
+}
@@ -0,0 +1,98 @@
+#include "EpollReactor.hpp"
+
+#ifdef __linux__
+
+EpollReactor::EpollReactor()
+: _epoll_fd(epoll_create1(EPOLL_CLOEXEC)), _events(EPOLL_MAX_EVENTS) {}
+
+EpollReactor::~EpollReactor()
+{
+	if (_epoll_fd != FAILURE)
+		close(_epoll_fd);
+}
+
+bool		EpollReactor::isValid() const			{ return (_epoll_fd != FAILURE); }
+
+const char*	EpollReactor::getName() const			{ return ("epoll"); }
+
+bool		EpollReactor::isEdgeTriggered() const	{ return (true); }
+
+/**
+ * @brief Every registration is edge-triggered (EPOLLET): the server drains
+ * 		  each ready socket until EAGAIN, so there is no need for the kernel
+ * 		  to report it again on the next wait() while data is still pending.
+ */
+uint32_t	EpollReactor::toEpollEvents(int events)
+{
+	uint32_t epoll_events = EPOLLET | EPOLLRDHUP;
+
+	if (events & READ)
+		epoll_events |= EPOLLIN;
+	if (events & WRITE)
+		epoll_events |= EPOLLOUT;
+	return (epoll_events);
+}
+
+int			EpollReactor::add(int fd, int events)
+{
+	epoll_event	event;
+
+	memset(&event, 0, sizeof(event));
+	event.events = toEpollEvents(events);
+	// EPOLLEXCLUSIVE cannot be combined with EPOLL_CTL_MOD later on, so it is
+	// only meant for listening sockets shared between several epoll instances.
+	if (events & EXCLUSIVE)
+		event.events |= EPOLLEXCLUSIVE;
+	event.data.fd = fd;
+	if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) == FAILURE)
+		return (FAILURE);
+	return (SUCCESS);
+}
+
+int			EpollReactor::modify(int fd, int events)
+{
+	epoll_event	event;
+
+	memset(&event, 0, sizeof(event));
+	event.events = toEpollEvents(events);
+	event.data.fd = fd;
+	if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &event) == FAILURE)
+		return (FAILURE);
+	return (SUCCESS);
+}
+
+int			EpollReactor::remove(int fd)
+{
+	if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, NULL) == FAILURE)
+		return (FAILURE);
+	return (SUCCESS);
+}
+
+int			EpollReactor::wait(std::vector<reactor_event> &ready, int timeout_ms)
+{
+	ready.clear();
+
+	int count = epoll_wait(_epoll_fd, _events.data(), _events.size(), timeout_ms);
+	if (count == FAILURE)
+		return (FAILURE);
+
+	for (int i = 0; i < count; i++)
+	{
+		reactor_event	event;
+
+		event.fd = _events[i].data.fd;
+		event.events = 0;
+		event.data = NULL;
+		event.result = 0;
+		if (_events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))
+			event.events |= READ;
+		if (_events[i].events & EPOLLOUT)
+			event.events |= WRITE;
+		if (_events[i].events & EPOLLERR)
+			event.events |= ERROR;
+		ready.push_back(event);
+	}
+	return (SUCCESS);
+}
+
+#endif
@@ -0,0 +1,63 @@
+#include "ExpiringSet.hpp"
+#include <algorithm>
+
+static const size_t	min_sweep = 64;	// below this size, the set is never swept
+
+ExpiringSet::ExpiringSet() : _sweep_at(min_sweep) {}
+
+ExpiringSet::~ExpiringSet() {}
+
+/**
+ * @brief Adds key, or renews it if it is already there.
+ *
+ * @param lifetime Seconds before the entry expires, 0 to keep it until erased
+ * @return true if key was not in the set
+ */
+bool	ExpiringSet::insert(std::string const &key, uint64_t now, time_t lifetime)
+{
+	uint64_t	expiry = (lifetime > 0) ? now + lifetime * 1000ULL : 0;
+	bool		added = (contains(key, now) == false);
+
+	_entries[key] = expiry;
+	if (_entries.size() >= _sweep_at)
+		sweep(now);
+	return (added);
+}
+
+bool	ExpiringSet::erase(std::string const &key)
+{
+	return (_entries.erase(key) > 0);
+}
+
+bool	ExpiringSet::contains(std::string const &key, uint64_t now)
+{
+	std::unordered_map<std::string, uint64_t>::iterator it = _entries.find(key);
+
+	if (it == _entries.end())
+		return (false);
+	if (it->second != 0 && it->second <= now)
+	{
+		_entries.erase(it);
+		return (false);
+	}
+	return (true);
+}
+
+size_t	ExpiringSet::size() const	{ return (_entries.size()); }
+
+/**
+ * @brief Drops every entry expired at now.
+ */
+void	ExpiringSet::sweep(uint64_t now)
+{
+	std::unordered_map<std::string, uint64_t>::iterator it = _entries.begin();
+
+	while (it != _entries.end())
+	{
+		if (it->second != 0 && it->second <= now)
+			it = _entries.erase(it);
+		else
+			it++;
+	}
+	_sweep_at = std::max(min_sweep, _entries.size() * 2);
+}
@@ -0,0 +1,141 @@
+#include "Hostmask.hpp"
+#include "ClientTable.hpp"
+
+/*		GLOB		*/
+
+Glob::Glob() : _star_first(false), _star_last(false), _has_star(false), _has_wildcard(false) {}
+
+Glob::Glob(std::string const &pattern)
+: _star_first(false), _star_last(false), _has_star(false), _has_wildcard(false)
+{
+	std::string	segment;
+
+	for (size_t i = 0; i < pattern.size(); i++)
+	{
+		if (pattern[i] != '*')
+		{
+			if (pattern[i] == '?')
+				_has_wildcard = true;
+			segment += pattern[i];
+			continue ;
+		}
+		if (i == 0)
+			_star_first = true;
+		if (segment.empty() == false) // "a**b" is "a*b"
+			_segments.push_back(segment);
+		segment.clear();
+		_has_star = _has_wildcard = true;
+	}
+	_star_last = (pattern.empty() == false && pattern[pattern.size() - 1] == '*');
+	if (segment.empty() == false || _has_star == false)
+		_segments.push_back(segment);
+}
+
+bool	Glob::isLiteral() const	{ return (_has_wildcard == false); }
+
+/* Compares a segment with the characters at str, '?' matching any of them */
+static bool	segmentAt(std::string const &segment, const char *str)
+{
+	for (size_t i = 0; i < segment.size(); i++)
+	{
+		if (segment[i] != '?' && segment[i] != str[i])
+			return (false);
+	}
+	return (true);
+}
+
+bool	Glob::matches(str_view str) const
+{
+	size_t	begin = 0;
+	size_t	end = str.size;
+	size_t	first = 0;
+	size_t	last = _segments.size();
+
+	if (_has_star == false)
+		return (str.size == _segments[0].size() && segmentAt(_segments[0], str.data));
+	if (_star_first == false && last > 0) // anchored at the start
+	{
+		if (_segments[0].size() > str.size || segmentAt(_segments[0], str.data) == false)
+			return (false);
+		begin = _segments[first++].size();
+	}
+	if (_star_last == false && last > first) // anchored at the end
+	{
+		std::string const &tail = _segments[--last];
+
+		if (tail.size() > end - begin || segmentAt(tail, str.data + end - tail.size()) == false)
+			return (false);
+		end -= tail.size();
+	}
+	for (size_t i = first; i < last; i++) // floating: leftmost occurrence
+	{
+		std::string const &segment = _segments[i];
+
+		while (begin + segment.size() <= end && segmentAt(segment, str.data + begin) == false)
+			begin++;
+		if (begin + segment.size() > end)
+			return (false);
+		begin += segment.size();
+	}
+	return (true);
+}
+
+/*		HOSTMASK		*/
+
+Hostmask::Hostmask(std::string const &mask) : _mask(normalize(mask))
+{
+	size_t	bang = _mask.find('!');
+	size_t	at = _mask.find('@', bang);
+
+	_parts[NICK] = _mask.substr(0, bang);
+	_parts[USER] = _mask.substr(bang + 1, at - bang - 1);
+	_parts[HOST] = _mask.substr(at + 1);
+	for (int i = 0; i < PARTS; i++)
+		_globs[i] = Glob(_parts[i]);
+}
+
+std::string const	&Hostmask::str() const				{ return (_mask); }
+std::string const	&Hostmask::part(int index) const	{ return (_parts[index]); }
+bool				Hostmask::isLiteral(int index) const	{ return (_globs[index].isLiteral()); }
+
+/**
+ * @brief Matches the identity of a client, whose parts must be casemapped.
+ */
+bool	Hostmask::matches(std::string const &nick, std::string const &user, std::string const &host) const
+{
+	return (_globs[HOST].matches(host) && _globs[NICK].matches(nick) && _globs[USER].matches(user));
+}
+
+/**
+ * @brief Completes a mask to nick!user@host and casemaps it.
+ */
+std::string	Hostmask::normalize(std::string const &mask)
+{
+	std::string	nick = "*";
+	std::string	user = "*";
+	std::string	host = "*";
+	size_t		bang = mask.find('!');
+	size_t		at = mask.find('@', bang == std::string::npos ? 0 : bang);
+
+	if (bang == std::string::npos && at == std::string::npos)
+		nick = mask;
+	else if (bang == std::string::npos)
+	{
+		user = mask.substr(0, at);
+		host = mask.substr(at + 1);
+	}
+	else
+	{
+		nick = mask.substr(0, bang);
+		user = mask.substr(bang + 1, at == std::string::npos ? std::string::npos : at - bang - 1);
+		if (at != std::string::npos)
+			host = mask.substr(at + 1);
+	}
+	if (nick.empty())
+		nick = "*";
+	if (user.empty())
+		user = "*";
+	if (host.empty())
+		host = "*";
+	return (casemapNickname(nick + "!" + user + "@" + host));
+}
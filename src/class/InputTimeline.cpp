@@ -0,0 +1,179 @@
+#include "InputTimeline.hpp"
+
+/**
+ * @param records Capacity, a power of two
+ */
+InputTimeline::InputTimeline(size_t records)
+: _record_count(records), _head(0), _tail(0)
+{
+}
+
+InputTimeline::~InputTimeline()
+{
+}
+
+/**
+ * @brief Whether the next line has to wait for the consumer to pop one.
+ */
+bool	InputTimeline::full() const
+{
+	return (_tail.load(std::memory_order_relaxed) - _head.load(std::memory_order_acquire) >= _record_count);
+}
+
+/**
+ * @brief The record to fill at the tail, the caller checked full() first.
+ */
+InputTimeline::record	&InputTimeline::nextRecord(uint64_t time, size_t pin)
+{
+	if (_records.empty()) // published to the consumer by the first tail store
+		_records.resize(_record_count);
+
+	record	&rec = _records[_tail.load(std::memory_order_relaxed) & (_record_count - 1)];
+
+	rec.time = time;
+	rec.pin = pin;
+	rec.first = str_view();
+	rec.second = str_view();
+	rec.too_long = false;
+	rec.has_command = false;
+	rec.spec = NULL;
+	return (rec);
+}
+
+/**
+ * @brief Splits the line and publishes it to the consumer. Its bytes stay
+ * 		  in the read buffer: first and second tell where, line is the same
+ * 		  bytes made contiguous if they wrap.
+ *
+ * @param time Clock of the producer (ms), never behind the previous line's
+ * @param pin Read buffer position to keep until the line is popped
+ */
+void	InputTimeline::append(uint64_t time, size_t pin, str_view line, str_view first, str_view second)
+{
+	record		&rec = nextRecord(time, pin);
+	irc_message	tokens;
+
+	rec.first = first;
+	rec.second = second;
+	rec.has_command = (tokenizeMessage(line, tokens) == SUCCESS);
+	if (rec.has_command) // offsets into the line, right for any contiguous copy of it
+	{
+		packMessage(line, tokens, rec.tokens);
+		rec.spec = lookupCommand(tokens.command);
+	}
+	_tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Records that a line over the limit was dropped, so its error
+ * 		  reply keeps its place among the commands.
+ */
+void	InputTimeline::appendTooLong(uint64_t time, size_t pin)
+{
+	nextRecord(time, pin).too_long = true;
+	_tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Where the producer may release its read buffer up to: the bytes
+ * 		  of the oldest line not popped yet, none if every line was.
+ */
+size_t	InputTimeline::pinnedFrom(size_t none) const
+{
+	size_t	head = _head.load(std::memory_order_acquire);
+
+	if (head == _tail.load(std::memory_order_relaxed))
+		return (none);
+	return (_records[head & (_record_count - 1)].pin);
+}
+
+void	InputTimeline::toEntry(record const &rec, timeline_entry &entry, std::string &linear) const
+{
+	entry.time = rec.time;
+	entry.line = rec.first;
+	if (rec.second.size > 0)
+	{
+		linear.assign(rec.first.data, rec.first.size);
+		linear.append(rec.second.data, rec.second.size);
+		entry.line = str_view(linear);
+	}
+	entry.too_long = rec.too_long;
+	entry.has_command = rec.has_command;
+	entry.spec = rec.spec;
+	if (rec.has_command)
+		unpackMessage(entry.line, rec.tokens, entry.tokens);
+}
+
+/**
+ * @return false if no line is waiting
+ */
+bool	InputTimeline::front(timeline_entry &entry)
+{
+	size_t	head = _head.load(std::memory_order_relaxed);
+
+	if (head == _tail.load(std::memory_order_acquire))
+		return (false);
+	toEntry(_records[head & (_record_count - 1)], entry, _linear);
+	return (true);
+}
+
+/**
+ * @brief Releases the front line once its command has run; its view is no
+ * 		  longer valid after that.
+ */
+void	InputTimeline::pop()
+{
+	_head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Cursor over the waiting lines framed at or after time. Lines are
+ * 		  appended in time order, so the first one is found by binary search.
+ */
+InputTimeline::cursor	InputTimeline::since(uint64_t time) const
+{
+	cursor	it;
+	size_t	low = _head.load(std::memory_order_relaxed);
+	size_t	high = _tail.load(std::memory_order_acquire);
+
+	it._timeline = this;
+	it._end = high;
+	while (low < high)
+	{
+		size_t	mid = low + (high - low) / 2;
+
+		if (_records[mid & (_record_count - 1)].time < time)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	it._pos = low;
+	return (it);
+}
+
+/**
+ * @return false once every line of the cursor was walked
+ */
+bool	InputTimeline::cursor::next(timeline_entry &entry)
+{
+	if (_pos == _end)
+		return (false);
+	_timeline->toEntry(_timeline->_records[_pos & (_timeline->_record_count - 1)], entry, _linear);
+	_pos++;
+	return (true);
+}
+
+size_t	InputTimeline::cursor::remaining() const	{ return (_end - _pos); }
+
+/**
+ * @brief Drops every waiting line (consumer side, e.g. the client leaves).
+ */
+void	InputTimeline::clear()
+{
+	_head.store(_tail.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+size_t	InputTimeline::size() const
+{
+	return (_tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire));
+}
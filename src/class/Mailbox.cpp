@@ -0,0 +1,75 @@
+#include "Mailbox.hpp"
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <stdint.h>
+
+Mailbox::Mailbox() : _signaled(false), _event_fd(FAILURE)
+{
+}
+
+Mailbox::~Mailbox()
+{
+	if (_event_fd != FAILURE)
+		close(_event_fd);
+}
+
+int		Mailbox::open()
+{
+	_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	return (_event_fd == FAILURE ? FAILURE : SUCCESS);
+}
+
+/**
+ * @brief Readable while messages are waiting, for the receiver's Reactor.
+ */
+int		Mailbox::getFd() const	{ return (_event_fd); }
+
+void	Mailbox::post(shard_message const &message)
+{
+	_queue.push(message);
+	if (_signaled.exchange(true, std::memory_order_acq_rel) == false)
+	{
+		uint64_t	one = 1;
+
+		if (write(_event_fd, &one, sizeof(one)) == FAILURE && errno != EAGAIN)
+			std::cerr << "[Mailbox] eventfd write failed" << std::endl;
+	}
+}
+
+/**
+ * @brief Takes every waiting message, oldest first. The eventfd and the
+ * 		  flag are reset before the queue is drained: a post that finds the
+ * 		  flag cleared writes the eventfd again, and one that found it set
+ * 		  had pushed its message before, so none is left without a wakeup.
+ */
+void	Mailbox::receive(std::vector<shard_message> &messages)
+{
+	uint64_t		count;
+	shard_message	message;
+
+	messages.clear();
+	if (read(_event_fd, &count, sizeof(count)) == FAILURE && errno != EAGAIN)
+		std::cerr << "[Mailbox] eventfd read failed" << std::endl;
+	_signaled.exchange(false, std::memory_order_acq_rel);
+	while (_queue.pop(message))
+		messages.push_back(message);
+}
+
+/**
+ * @brief Blocks until a message is posted, for a receiver without a
+ * 		  Reactor of its own.
+ *
+ * @return int FAILURE with errno set (EINTR on a signal), SUCCESS otherwise
+ */
+int		Mailbox::wait(int timeout_ms)
+{
+	struct pollfd	entry;
+
+	entry.fd = _event_fd;
+	entry.events = POLLIN;
+	entry.revents = 0;
+	if (poll(&entry, 1, timeout_ms) == FAILURE)
+		return (FAILURE);
+	return (SUCCESS);
+}
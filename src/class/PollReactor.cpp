@@ -0,0 +1,92 @@
+#include "PollReactor.hpp"
+
+PollReactor::PollReactor() {}
+
+PollReactor::~PollReactor() {}
+
+const char*	PollReactor::getName() const		{ return ("poll"); }
+
+bool		PollReactor::isEdgeTriggered() const	{ return (false); }
+
+short		PollReactor::toPollEvents(int events)
+{
+	short poll_events = 0;
+
+	if (events & READ)
+		poll_events |= POLLIN;
+	if (events & WRITE)
+		poll_events |= POLLOUT;
+	return (poll_events);
+}
+
+int			PollReactor::add(int fd, int events)
+{
+	pollfd	entry;
+
+	if (fd < 0)
+		return (FAILURE);
+	if (static_cast<size_t>(fd) >= _index.size())
+		_index.resize(fd + 1, -1);
+	if (_index[fd] != -1)
+		return (modify(fd, events));
+
+	entry.fd = fd;
+	entry.events = toPollEvents(events);
+	entry.revents = 0;
+	_index[fd] = _fds.size();
+	_fds.push_back(entry);
+	return (SUCCESS);
+}
+
+int			PollReactor::modify(int fd, int events)
+{
+	if (fd < 0 || static_cast<size_t>(fd) >= _index.size() || _index[fd] == -1)
+		return (FAILURE);
+	_fds[_index[fd]].events = toPollEvents(events);
+	return (SUCCESS);
+}
+
+/**
+ * @brief Unregisters fd in O(1) by moving the last pollfd into its slot.
+ */
+int			PollReactor::remove(int fd)
+{
+	if (fd < 0 || static_cast<size_t>(fd) >= _index.size() || _index[fd] == -1)
+		return (FAILURE);
+
+	int	pos = _index[fd];
+
+	_fds[pos] = _fds.back();
+	_index[_fds[pos].fd] = pos;
+	_fds.pop_back();
+	_index[fd] = -1;
+	return (SUCCESS);
+}
+
+int			PollReactor::wait(std::vector<reactor_event> &ready, int timeout_ms)
+{
+	ready.clear();
+	if (poll(_fds.data(), _fds.size(), timeout_ms) == FAILURE)
+		return (FAILURE);
+
+	for (size_t i = 0; i < _fds.size(); i++)
+	{
+		if (_fds[i].revents == 0)
+			continue ;
+
+		reactor_event	event;
+
+		event.fd = _fds[i].fd;
+		event.events = 0;
+		event.data = NULL;
+		event.result = 0;
+		if (_fds[i].revents & (POLLIN | POLLHUP))
+			event.events |= READ;
+		if (_fds[i].revents & POLLOUT)
+			event.events |= WRITE;
+		if (_fds[i].revents & (POLLERR | POLLNVAL))
+			event.events |= ERROR;
+		ready.push_back(event);
+	}
+	return (SUCCESS);
+}
@@ -0,0 +1,57 @@
+#include "Reactor.hpp"
+#include "PollReactor.hpp"
+#include "EpollReactor.hpp"
+#include "UringReactor.hpp"
+#include <fcntl.h>
+
+/**
+ * @brief Instantiates the event backend requested in the settings file.
+ * 		  "uring" falls back to "epoll" and "epoll" to "poll" when they cannot
+ * 		  be created (non-Linux host, old kernel, seccomp...), any other value
+ * 		  selects "poll".
+ *
+ * @param backend Name of the backend ("uring", "epoll" or "poll")
+ * @return Reactor* A heap-allocated reactor owned by the caller
+ */
+Reactor*	Reactor::create(std::string const &backend)
+{
+#ifdef __linux__
+	if (backend == "uring")
+	{
+		UringReactor *reactor = new UringReactor();
+		if (reactor->isValid())
+			return (reactor);
+		std::cerr << RED << "[Server] io_uring unavailable, falling back to epoll" << RESET << std::endl;
+		delete reactor;
+	}
+	if (backend == "epoll" || backend == "uring")
+	{
+		EpollReactor *reactor = new EpollReactor();
+		if (reactor->isValid())
+			return (reactor);
+		std::cerr << RED << "[Server] epoll unavailable, falling back to poll" << RESET << std::endl;
+		delete reactor;
+	}
+#endif
+	if (backend != "poll" && backend != "epoll" && backend != "uring")
+		std::cerr << RED << "[Server] Unknown reactor '" << backend << "', using poll" << RESET << std::endl;
+	return (new PollReactor());
+}
+
+/**
+ * @brief Default send path of readiness backends: a plain writev(2), which
+ * 		  may write partially or fail with EAGAIN on a non-blocking socket.
+ */
+ssize_t		Reactor::sendv(int fd, const struct iovec *iov, int iovcnt)
+{
+	return (writev(fd, iov, iovcnt));
+}
+
+int		setNonBlocking(int fd)
+{
+	int flags = fcntl(fd, F_GETFL, 0);
+
+	if (flags == FAILURE || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == FAILURE)
+		return (FAILURE);
+	return (SUCCESS);
+}
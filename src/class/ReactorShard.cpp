@@ -0,0 +1,331 @@
+#include "ReactorShard.hpp"
+#include "TimerWheel.hpp"
+#include <signal.h>
+#include <pthread.h>
+
+ReactorShard::ReactorShard(unsigned index, int listen_fd, Mailbox &core)
+: _index(index), _listen_fd(listen_fd), _reactor(NULL), _core(core), _now(0), _running(false)
+{
+}
+
+ReactorShard::~ReactorShard()
+{
+	stop();
+	close(_listen_fd);
+	delete _reactor;
+}
+
+Mailbox&	ReactorShard::getInbox()	{ return (_inbox); }
+
+/**
+ * @brief Registers the listening socket and the inbox, then starts the
+ * 		  thread. io_uring only reports sockets (see UringReactor), so the
+ * 		  shards run it as epoll to also watch their inbox.
+ */
+int		ReactorShard::start(std::string const &backend)
+{
+	sigset_t	blocked;
+	sigset_t	previous;
+
+	_reactor = Reactor::create(backend == "uring" ? "epoll" : backend);
+	if (_inbox.open() == FAILURE
+		|| _reactor->add(_listen_fd, Reactor::READ | Reactor::LISTEN) == FAILURE
+		|| _reactor->add(_inbox.getFd(), Reactor::READ) == FAILURE)
+		return (FAILURE);
+	// SIGINT is for the core loop; a failed write returns EPIPE instead of SIGPIPE
+	sigemptyset(&blocked);
+	sigaddset(&blocked, SIGINT);
+	sigaddset(&blocked, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	_running = true;
+	_thread = std::thread(&ReactorShard::run, this);
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	return (SUCCESS);
+}
+
+void	ReactorShard::stop()
+{
+	shard_message	message;
+
+	if (_thread.joinable() == false)
+		return ;
+	message.type = SHARD_STOP;
+	message.fd = FAILURE;
+	message.target = NULL;
+	_inbox.post(message);
+	_thread.join();
+}
+
+void	ReactorShard::run()
+{
+	std::vector<reactor_event>	events;
+	std::vector<shard_message>	messages;
+
+	while (_running)
+	{
+		if (_reactor->wait(events, -1) == FAILURE)
+		{
+			if (errno == EINTR)
+				continue ;
+			std::cerr << RED << "[Shard " << _index << "] " << _reactor->getName() << " error" << RESET << std::endl;
+			return ;
+		}
+		_now = monotonicMs();
+		for (size_t i = 0; i < events.size(); i++)
+		{
+			const int	fd = events[i].fd;
+
+			if (fd == _listen_fd)
+				acceptClients();
+			else if (fd == _inbox.getFd())
+			{
+				_inbox.receive(messages);
+				for (size_t j = 0; j < messages.size(); j++)
+					handleMessage(messages[j]);
+			}
+			else if (static_cast<size_t>(fd) < _connections.size() && _connections[fd].client != NULL)
+			{
+				if (events[i].events & Reactor::ERROR)
+					detach(fd);
+				if ((events[i].events & Reactor::READ) && _connections[fd].client != NULL)
+					readInput(fd);
+				if ((events[i].events & Reactor::WRITE) && _connections[fd].client != NULL)
+					flush(fd);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Hands every pending connection to the core, which decides whether
+ * 		  it gets a Client (K-lines and clone limits are its state).
+ */
+void	ReactorShard::acceptClients()
+{
+	while (true)
+	{
+		shard_message	message;
+		int				client_sock = acceptSocket(_listen_fd, message.address);
+
+		if (client_sock == FAILURE)
+		{
+			if (errno == EINTR)
+				continue ;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				std::cerr << RED << "[Shard " << _index << "] Accept() failed" << RESET << std::endl;
+			return ;
+		}
+		message.type = SHARD_ACCEPTED;
+		message.fd = client_sock;
+		message.target = NULL;
+		message.shard = _index;
+		_core.post(message);
+	}
+}
+
+void	ReactorShard::handleMessage(shard_message const &message)
+{
+	connection	*conn;
+
+	if (message.type == SHARD_STOP)
+		_running = false;
+	else if (message.type == SHARD_ADD)
+	{
+		if (static_cast<size_t>(message.fd) >= _connections.size())
+		{
+			connection	empty = { NULL, client_handle(), false, false, false, 0 };
+
+			_connections.resize(message.fd + 1, empty);
+		}
+		conn = &_connections[message.fd];
+		conn->client = message.target;
+		conn->handle = message.client;
+		conn->stalled = conn->want_write = conn->closing = false;
+		conn->interest = Reactor::READ;
+		if (_reactor->add(message.fd, Reactor::READ) == FAILURE)
+		{
+			conn->client = NULL;
+			postToCore(SHARD_CLOSED, message.fd, message.client);
+		}
+	}
+	else if ((conn = findConnection(message.fd, message.client)) == NULL)
+		return ; // gone already, the core will learn it from SHARD_CLOSED
+	else if (message.type == SHARD_FLUSH)
+	{
+		conn->client->takeFlushSignal();
+		flush(message.fd);
+	}
+	else if (message.type == SHARD_CLOSE)
+	{
+		conn->closing = true;
+		flush(message.fd);
+	}
+	else if (message.type == SHARD_RESUME && conn->stalled)
+	{
+		conn->stalled = false;
+		updateInterest(message.fd);
+		readInput(message.fd);
+	}
+}
+
+ReactorShard::connection	*ReactorShard::findConnection(int fd, client_handle const &handle)
+{
+	if (fd < 0 || static_cast<size_t>(fd) >= _connections.size())
+		return (NULL);
+
+	connection	&conn = _connections[fd];
+
+	if (conn.client == NULL || conn.handle.generation != handle.generation)
+		return (NULL);
+	return (&conn);
+}
+
+/**
+ * @brief Reads until recv() would block, framing the lines into the
+ * 		  timeline as the read buffer fills up. Once the timeline is full,
+ * 		  or the read buffer is full of lines the core did not run yet, the
+ * 		  shard stops reading the socket until the core has run some lines
+ * 		  and sends SHARD_RESUME.
+ *
+ * 	The core pops lines while this runs, so once the shard flagged the
+ * 	stall it frames again: lines popped in between leave room that no
+ * 	SHARD_RESUME would report.
+ */
+void	ReactorShard::readInput(int fd)
+{
+	connection		&conn = _connections[fd];
+	RingBuffer		&readbuf = conn.client->getReadBuffer();
+	bool			drained = false;
+	bool			full;
+	char			*span;
+	size_t			span_len;
+	ssize_t			read_count;
+
+	if (conn.stalled || conn.closing) // what a leaving client sends is ignored
+		return ;
+	while (true)
+	{
+		span_len = drained ? 0 : readbuf.writeSpan(&span);
+		if (span_len > 0)
+		{
+			read_count = recv(fd, span, span_len, 0);
+			if (read_count == 0) // end of file
+				return (detach(fd));
+			if (read_count > 0)
+			{
+				readbuf.commit(read_count);
+				continue ;
+			}
+			if (errno == EINTR)
+				continue ;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				return (detach(fd));
+			drained = true;
+		}
+		frameInput(conn, full);
+		if (full == false && drained)
+			return ; // every complete line is in the timeline
+		if (full == false)
+			continue ; // the lines framed left room in the read buffer
+		conn.client->setInputStalled();
+		frameInput(conn, full);
+		if (full)
+			break ;
+	}
+	conn.stalled = true;
+	updateInterest(fd);
+}
+
+/**
+ * @brief Moves the complete lines to the timeline, and tells the core if
+ * 		  it was not told already.
+ *
+ * @param full Set if nothing more can be framed before the core runs lines
+ */
+size_t	ReactorShard::frameInput(connection &conn, bool &full)
+{
+	size_t	count = conn.client->frameInput(_now, full);
+
+	if (count > 0 && conn.client->signalInput())
+		postToCore(SHARD_INPUT, conn.client->getClientFd(), conn.handle);
+	return (count);
+}
+
+/**
+ * @brief Writes the send queue until it is empty or the socket would block,
+ * 		  under the lock the core takes to append to it.
+ */
+void	ReactorShard::flush(int fd)
+{
+	connection	&conn = _connections[fd];
+	Client		&client = *conn.client;
+	bool		failed = false;
+	bool		pending;
+
+	{
+		std::lock_guard<std::mutex>	guard(client.getSendqLock());
+
+		while (client.hasPendingData())
+		{
+			iovec	replies[SEND_IOV_MAX];
+			int		count = client.getSendIovec(replies, SEND_IOV_MAX);
+			ssize_t	sent = _reactor->sendv(fd, replies, count);
+
+			if (sent == FAILURE)
+			{
+				if (errno == EINTR)
+					continue ;
+				failed = (errno != EAGAIN && errno != EWOULDBLOCK);
+				break ;
+			}
+			client.consumeSendBuffer(sent);
+		}
+		pending = client.hasPendingData();
+	}
+	if (failed || (pending == false && conn.closing))
+		return (detach(fd));
+	conn.want_write = pending;
+	updateInterest(fd);
+}
+
+/**
+ * @brief READ unless the connection is stalled or closing, WRITE while
+ * 		  replies are left, changed only when it differs.
+ */
+void	ReactorShard::updateInterest(int fd)
+{
+	connection	&conn = _connections[fd];
+	int			events = 0;
+
+	if (conn.stalled == false && conn.closing == false)
+		events |= Reactor::READ;
+	if (conn.want_write)
+		events |= Reactor::WRITE;
+	if (events != conn.interest && _reactor->modify(fd, events) == SUCCESS)
+		conn.interest = events;
+}
+
+/**
+ * @brief Lets go of the connection: the core closes the fd and deletes the
+ * 		  Client when it gets SHARD_CLOSED, so the fd cannot be reused while
+ * 		  the core still knows it.
+ */
+void	ReactorShard::detach(int fd)
+{
+	connection	&conn = _connections[fd];
+
+	_reactor->remove(fd);
+	postToCore(SHARD_CLOSED, fd, conn.handle);
+	conn.client = NULL;
+}
+
+void	ReactorShard::postToCore(shard_message_type type, int fd, client_handle handle)
+{
+	shard_message	message;
+
+	message.type = type;
+	message.fd = fd;
+	message.client = handle;
+	message.target = NULL;
+	_core.post(message);
+}
@@ -0,0 +1,236 @@
+#include "RingBuffer.hpp"
+#include <algorithm>
+
+/*
+ * _keep, _head, _tail and _scan only ever grow: the distance between them
+ * is the amount of data whatever the wrap-arounds, and "& _mask" gives the
+ * position in the storage.
+ */
+RingBuffer::RingBuffer(size_t capacity)
+: _mask(0), _capacity(capacity), _keep(0), _head(0), _tail(0), _scan(0), _discarding(false),
+  _line_begin(0), _line_len(0) {}
+
+RingBuffer::~RingBuffer() {}
+
+size_t	RingBuffer::size() const		{ return (_tail - _head); }
+
+/**
+ * @brief Whether lines handed out are still kept: the storage cannot move.
+ */
+bool	RingBuffer::isKeeping() const	{ return (_keep != _head); }
+
+/**
+ * @brief Bytes that can still be received, growing the storage included
+ * 		  unless it cannot move.
+ */
+size_t	RingBuffer::available() const
+{
+	return ((isKeeping() ? _buf.size() : _capacity) - (_tail - _keep));
+}
+
+/**
+ * @brief Drops everything and gives the storage back (the client leaves).
+ */
+void	RingBuffer::clear()
+{
+	_keep = 0;
+	_head = 0;
+	_tail = 0;
+	_scan = 0;
+	_discarding = false;
+	std::vector<char>().swap(_buf);
+	std::string().swap(_linear);
+	_mask = 0;
+}
+
+/**
+ * @brief Moves the bytes not released to a storage of size bytes, where the
+ * 		  same positions are found with the new mask.
+ */
+void	RingBuffer::resize(size_t size)
+{
+	std::vector<char>	buf(size);
+
+	for (size_t i = _keep; i < _tail; i++)
+		buf[i & (size - 1)] = _buf[i & _mask];
+	_buf.swap(buf);
+	_mask = size - 1;
+}
+
+/**
+ * @brief Points span to the contiguous free space after the received bytes,
+ * 		  so that recv() can write into it directly. When the free space
+ * 		  wraps around, only its first part is returned. The storage is
+ * 		  allocated or grown here, when no line is kept: the views handed
+ * 		  out before and released are not valid anymore.
+ *
+ * @return size_t Size of the span, 0 if the buffer is full
+ */
+size_t	RingBuffer::writeSpan(char **span)
+{
+	size_t	used = _tail - _keep;
+	size_t	pos;
+
+	if (used == _buf.size() && _buf.size() < _capacity && isKeeping() == false)
+		resize(_buf.empty() ? std::min<size_t>(RECV_BUF_MIN, _capacity) : _buf.size() * 2);
+	if (used == _buf.size())
+		return (0);
+	pos = _tail & _mask;
+	*span = &_buf[pos];
+	return (std::min(_buf.size() - used, _buf.size() - pos));
+}
+
+/**
+ * @brief Adds the len bytes written in the span from writeSpan() to the data.
+ */
+void	RingBuffer::commit(size_t len)
+{
+	_tail += len;
+}
+
+/**
+ * @brief Copies as much of data as fits, for backends which already received
+ * 		  it in a buffer of their own.
+ *
+ * @return size_t Number of bytes copied
+ */
+size_t	RingBuffer::write(const char *data, size_t len)
+{
+	size_t	written = 0;
+	char	*span;
+	size_t	span_len;
+
+	while (written < len && (span_len = writeSpan(&span)) > 0)
+	{
+		span_len = std::min(span_len, len - written);
+		memcpy(span, data + written, span_len);
+		commit(span_len);
+		written += span_len;
+	}
+	return (written);
+}
+
+size_t	RingBuffer::lineLimit() const
+{
+	if (_head != _tail && _buf[_head & _mask] == '@')
+		return (MSG_MAX_TAGGED_LEN);
+	return (MSG_MAX_LEN);
+}
+
+str_view	RingBuffer::makeView(size_t begin, size_t len)
+{
+	size_t	pos = begin & _mask;
+	size_t	first = _buf.size() - pos;
+
+	if (len <= first)
+		return (str_view(&_buf[pos], len));
+	_linear.assign(&_buf[pos], first);
+	_linear.append(&_buf[0], len - first);
+	return (str_view(_linear.data(), len));
+}
+
+/**
+ * @brief Extracts the next line, without its "\r\n" (or bare "\n"). Empty
+ * 		  lines are skipped, as RFC 1459 asks.
+ *
+ * 	The view stays valid until the next call to nextLine(), writeSpan() or
+ * 	write(); the bytes themselves until release().
+ *
+ * @return int LINE, LINE_TOO_LONG if a line over the limit was dropped, or
+ * 		   NO_LINE when no complete line is left
+ */
+int		RingBuffer::nextLine(str_view &line)
+{
+	while (true)
+	{
+		// Look for '\n' in the bytes that were not scanned yet, one
+		// contiguous part of the storage at a time
+		size_t		eol = _tail;
+		while (_scan < _tail)
+		{
+			size_t		pos = _scan & _mask;
+			size_t		len = std::min(_tail - _scan, _buf.size() - pos);
+			const void	*found = memchr(&_buf[pos], '\n', len);
+
+			if (found != NULL)
+			{
+				eol = _scan + (static_cast<const char *>(found) - &_buf[pos]);
+				break ;
+			}
+			_scan += len;
+		}
+
+		if (eol == _tail) // no complete line
+		{
+			if (_discarding)
+				_head = _tail;
+			else if (size() >= lineLimit())
+			{
+				_discarding = true;
+				_head = _tail;
+				_scan = _tail;
+				return (LINE_TOO_LONG);
+			}
+			_scan = _tail;
+			return (NO_LINE);
+		}
+
+		size_t	begin = _head;
+		size_t	len = eol - begin;
+		size_t	limit = lineLimit();
+
+		_head = eol + 1;
+		_scan = _head;
+		if (_discarding) // end of a line already reported
+		{
+			_discarding = false;
+			continue ;
+		}
+		if (len + 1 > limit)
+			return (LINE_TOO_LONG);
+		if (len > 0 && _buf[(eol - 1) & _mask] == '\r')
+			len--;
+		if (len == 0)
+			continue ;
+		_line_begin = begin;
+		_line_len = len;
+		line = makeView(begin, len);
+		return (LINE);
+	}
+}
+
+/**
+ * @brief Where the last line nextLine() returned lies in the storage: all
+ * 		  of it in first, unless it wraps around the end and its second
+ * 		  part is at the start. Valid until the line is released.
+ */
+void	RingBuffer::lastLineParts(str_view &first, str_view &second) const
+{
+	size_t	pos = _line_begin & _mask;
+	size_t	len = std::min(_line_len, _buf.size() - pos);
+
+	first = str_view(&_buf[pos], len);
+	second = str_view(&_buf[0], _line_len - len);
+}
+
+/**
+ * @brief First byte not handed out by nextLine(): releasing up to it frees
+ * 		  every line handed out so far.
+ */
+size_t	RingBuffer::position() const	{ return (_head); }
+
+/**
+ * @brief Frees the bytes before upto, a position() taken earlier: the lines
+ * 		  handed out after it are kept. When nothing is left, a storage grown
+ * 		  by a burst shrinks back.
+ */
+void	RingBuffer::release(size_t upto)
+{
+	_keep = std::max(_keep, std::min(upto, _head));
+	if (_keep == _tail && _buf.size() > RECV_BUF_MIN)
+	{
+		std::vector<char>(RECV_BUF_MIN).swap(_buf);
+		std::string().swap(_linear);
+		_mask = RECV_BUF_MIN - 1;
+	}
+}
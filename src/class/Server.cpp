@@ -1,19 +1,46 @@
 #include "Server.hpp"
 #include "Commands.hpp"
+#include <algorithm>
+#include <cassert>
 
 // Server::Server()
 Server::Server(std::string port, std::string password, struct tm *timeinfo)
-: _servinfo(NULL), _server_socket_fd(0) , _port(port), _password(password)
+: _servinfo(NULL), _server_socket_fd(0) , _port(port), _password(password), _reactor(NULL), _now(0), _round(0)
 {
 	std::cout << YELLOW << "Server running..." << RESET << std::endl;
  	std::cout << YELLOW << "Server listening" << RESET << std::endl;
 	memset(&_hints, 0, sizeof(_hints));
 	this->setDatetime(timeinfo);
+	_batch.left = 0;
+	_batch.event_fd = FAILURE;
+	_settings.reactor = DEFAULT_REACTOR;
+	_settings.max_clients = DEFAULT_MAX_CLIENTS;
+	_settings.default_class.max_per_address = DEFAULT_MAX_PER_ADDRESS;
+	_settings.default_class.max_per_prefix = DEFAULT_MAX_PER_PREFIX;
+	_settings.default_class.sendq_soft = DEFAULT_SENDQ_SOFT;
+	_settings.default_class.sendq_hard = DEFAULT_SENDQ_HARD;
+	_settings.ping_interval = DEFAULT_PING_INTERVAL;
+	_settings.ping_timeout = DEFAULT_PING_TIMEOUT;
+	_settings.registration_timeout = DEFAULT_REGISTRATION_TIMEOUT;
+	_settings.reactors = DEFAULT_REACTORS;
+	_settings.channel_workers = DEFAULT_CHANNEL_WORKERS;
+	_settings.command_budget = DEFAULT_COMMAND_BUDGET;
+	_settings.flood_rate = DEFAULT_FLOOD_RATE;
+	_settings.flood_burst = DEFAULT_FLOOD_BURST;
 }
 
 Server::~Server()
 {
 	std::cout << YELLOW << "Server destructor" << RESET << std::endl;
+	for (size_t i = 0; i < _shards.size(); i++)
+		delete _shards[i]; // stops its thread
+	for (size_t i = 0; i < _workers.size(); i++)
+		delete _workers[i];
+	for (size_t i = 0; i < _tasks.size(); i++)
+		delete _tasks[i];
+	if (_batch.event_fd != FAILURE)
+		close(_batch.event_fd);
+	delete _reactor;
 }
 
 const char * 	Server::InvalidClientException::what (void) const throw() 
@@ -40,10 +67,28 @@ std::string 					Server::getDatetime() const { return (_datetime); }
 
 std::map<std::string, Channel>&	Server::getChannels()		{ return (_channels); }
 
-std::map<const int, Client>&	Server::getClients()		{ return (_clients); }
+ClientTable&					Server::getClients()		{ return (_clients); }
 
 std::vector<server_op>&			Server::getIrcOperators()	{ return (_irc_operators); }
 
+server_settings&				Server::getSettings()		{ return (_settings); }
+
+Reactor*						Server::getReactor()		{ return (_reactor); }
+RadixTree<std::string>&			Server::getKlines()			{ return (_klines); }
+RadixTree<connection_class>&	Server::getClasses()		{ return (_classes); }
+TaskScheduler&					Server::getScheduler()		{ return (_scheduler); }
+
+/**
+ * @brief Limits of the most specific class containing address, the default
+ * 		  class if none does.
+ */
+connection_class const&			Server::getConnectionClass(ip_address const &address)
+{
+	connection_class const	*found = _classes.find(address);
+
+	return (found != NULL ? *found : _settings.default_class);
+}
+
 void							Server::setPassword(std::string new_pwd)
 {
 	_password = new_pwd;
@@ -96,6 +141,148 @@ int 		Server::readFromConfigFile(char *filename)
    return (SUCCESS);
 }
 
+/**
+ * @brief Reads the server tunables, one "<key> <value>" pair per line.
+ * 		  Empty lines and lines starting with '#' are ignored, unknown keys
+ * 		  are reported and skipped. Missing keys keep their Macro.hpp default.
+ *
+ * 	Keys:
+ * 		reactor		event backend used by manageServerLoop ("epoll" or "poll")
+ * 		reactors	threads owning the sockets, each with its own listening
+ * 					socket and backend; 1 runs everything on the main loop
+ * 					(see ReactorShard)
+ * 		channel_workers	threads running the commands aimed at one channel,
+ * 					each owning a share of the channels; 0 runs them on the
+ * 					main loop (see ChannelWorker)
+ * 		max_clients	connections accepted at the same time
+ * 		max_per_ip	connections from one address (default class)
+ * 		max_per_prefix	connections from one IPv6 /64 (default class)
+ * 		sendq_soft	bytes of pending replies above which bulk replies
+ * 					(LIST) are cut short (default class)
+ * 		sendq_hard	bytes of pending replies above which the client is
+ * 					disconnected (default class)
+ * 		class		"<address>[/<len>] <max_per_ip> <max_per_prefix>
+ * 					[<sendq_soft> <sendq_hard>]", limits for that range
+ * 					instead of the default ones (the sendq ones default to
+ * 					the values given above the line)
+ * 		ping_interval	seconds of silence before the server PINGs a client
+ * 		ping_timeout	seconds it then has to answer before being disconnected
+ * 		registration_timeout	seconds a new connection has to register
+ * 		command_budget	cost of the commands run for one client per loop
+ * 					iteration (see Server::processReadBuffer)
+ * 		flood_rate	command cost a client may run per second over time, 0
+ * 					for no limit (see LagCompensation)
+ * 		flood_burst	command cost it may run at once
+ * 		kline		"<address>[/<len>] [reason]", refuses the connections from
+ * 					that range (may appear several times)
+ *
+ * @param filename Path of the settings file
+ * @return int Returns SUCCESS (0) or FAILURE (-1) if the file cannot be opened
+ */
+int			Server::readSettingsFile(const char *filename)
+{
+	std::ifstream	data;
+	std::string		line;
+
+	data.open(filename);
+	if (!data)
+		return (FAILURE);
+	while (getline(data, line))
+	{
+		std::istringstream	fields(line);
+		std::string			key;
+		std::string			value;
+
+		if (!(fields >> key) || key[0] == '#')
+			continue ;
+		fields >> value;
+		if (key == "reactor")
+			_settings.reactor = value;
+		else if (key == "max_clients")
+			_settings.max_clients = strtoul(value.c_str(), NULL, 10);
+		else if (key == "max_per_ip")
+			_settings.default_class.max_per_address = strtoul(value.c_str(), NULL, 10);
+		else if (key == "max_per_prefix")
+			_settings.default_class.max_per_prefix = strtoul(value.c_str(), NULL, 10);
+		else if (key == "reactors")
+			_settings.reactors = std::min(std::max(1UL, strtoul(value.c_str(), NULL, 10)), static_cast<unsigned long>(MAX_REACTORS));
+		else if (key == "channel_workers")
+			_settings.channel_workers = std::min(strtoul(value.c_str(), NULL, 10), static_cast<unsigned long>(MAX_CHANNEL_WORKERS));
+		else if (key == "command_budget")
+			_settings.command_budget = std::max(1L, strtol(value.c_str(), NULL, 10));
+		else if (key == "flood_rate")
+			_settings.flood_rate = strtoul(value.c_str(), NULL, 10);
+		else if (key == "flood_burst")
+			_settings.flood_burst = std::max(1UL, strtoul(value.c_str(), NULL, 10));
+		else if (key == "sendq_soft")
+			_settings.default_class.sendq_soft = strtoul(value.c_str(), NULL, 10);
+		else if (key == "sendq_hard")
+			_settings.default_class.sendq_hard = strtoul(value.c_str(), NULL, 10);
+		else if (key == "ping_interval")
+			_settings.ping_interval = strtoul(value.c_str(), NULL, 10);
+		else if (key == "ping_timeout")
+			_settings.ping_timeout = strtoul(value.c_str(), NULL, 10);
+		else if (key == "registration_timeout")
+			_settings.registration_timeout = strtoul(value.c_str(), NULL, 10);
+		else if (key == "class")
+		{
+			if (addConnectionClass(value, fields) == FAILURE)
+				std::cerr << RED << "[Server] Invalid class: " << value << RESET << std::endl;
+		}
+		else if (key == "kline")
+		{
+			std::string	reason;
+
+			getline(fields >> std::ws, reason);
+			if (addKline(value, reason) == FAILURE)
+				std::cerr << RED << "[Server] Invalid kline: " << value << RESET << std::endl;
+		}
+		else
+			std::cerr << RED << "[Server] Unknown setting: " << key << RESET << std::endl;
+	}
+	data.close();
+	return (SUCCESS);
+}
+
+/**
+ * @brief Bans an address range: admitClient() closes the connections coming
+ * 		  from it before they get a Client.
+ *
+ * @param cidr "a.b.c.d", "a.b.c.d/len", "x::y" or "x::y/len"
+ * @return int FAILURE if cidr cannot be parsed
+ */
+int			Server::addKline(std::string const &cidr, std::string const &reason)
+{
+	ip_address	prefix;
+	unsigned	prefix_len;
+
+	if (parseCidr(cidr, prefix, prefix_len) == false)
+		return (FAILURE);
+	_klines.insert(prefix, prefix_len, reason.empty() ? "No reason" : reason);
+	return (SUCCESS);
+}
+
+/**
+ * @brief Gives the limits read from fields ("<max_per_ip> <max_per_prefix>
+ * 		  [<sendq_soft> <sendq_hard>]") to the connections coming from cidr.
+ *
+ * @return int FAILURE if a field is missing or invalid
+ */
+int			Server::addConnectionClass(std::string const &cidr, std::istream &fields)
+{
+	connection_class	limits = _settings.default_class;
+	ip_address			prefix;
+	unsigned			prefix_len;
+
+	if (!(fields >> limits.max_per_address >> limits.max_per_prefix)
+		|| parseCidr(cidr, prefix, prefix_len) == false)
+		return (FAILURE);
+	if (fields >> limits.sendq_soft && !(fields >> limits.sendq_hard))
+		return (FAILURE);
+	_classes.insert(prefix, prefix_len, limits);
+	return (SUCCESS);
+}
+
 /**
  * @brief Helps set up the structs 'hints' and 'servinfo' of our Server class
  *
@@ -113,67 +300,273 @@ int Server::fillServinfo(char *port)
 }
 
 /**
- * @brief This function follows step by step the required function calls to launch the server:
+ * @brief This function follows step by step the required function calls to open a listening socket:
  *
  * 		1) socket() => get the server socket file descriptor
  * 		2) setsocktop() => enable the configuration of said socket (here, we wanted
- * 							to allow the re-use of a port if the IP address is different)
+ * 							to allow the re-use of a port if the IP address is different,
+ * 							and with 'shared', several sockets bound to the same port)
  * 		3) bind() => Associate the socket with a specific port (here, the one given by the user)
  * 		4) listen() => Wait for any incoming connections to our server socket
+ * 		5) the listening socket is made non-blocking so that accept() can be
+ * 		   drained on edge-triggered backends
  *
- * @return int 0 for SUCCESS and -1 for FAILURE
+ * @param shared SO_REUSEPORT: the kernel spreads the connections over every
+ * 		  socket bound to the port (one per reactor shard)
+ * @return int The socket, or -1 for FAILURE
  */
-int Server::launchServer()
+int Server::openListener(bool shared)
 {
-	_server_socket_fd = socket(_servinfo->ai_family, _servinfo->ai_socktype, _servinfo->ai_protocol);
-	if (_server_socket_fd == FAILURE)
+	int listen_fd = socket(_servinfo->ai_family, _servinfo->ai_socktype, _servinfo->ai_protocol);
+	if (listen_fd == FAILURE)
 	{
 		std::cerr << RED << "[Server] Socket failed" << RESET << std::endl;
 		return (FAILURE);
 	}
 	int optvalue = 1; // enables the re-use of a port if the IP address is different
-	if (setsockopt(_server_socket_fd, SOL_SOCKET, SO_REUSEADDR, &optvalue, sizeof(optvalue)) == FAILURE)
+	if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &optvalue, sizeof(optvalue)) == FAILURE
+		|| (shared && setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &optvalue, sizeof(optvalue)) == FAILURE))
 	{
 		std::cerr << RED << "[Server] Impossible to reuse" << RESET << std::endl;
+		close(listen_fd);
 		return (FAILURE);
 	}
-	if (bind(_server_socket_fd, _servinfo->ai_addr, _servinfo->ai_addrlen) == FAILURE)
+	if (bind(listen_fd, _servinfo->ai_addr, _servinfo->ai_addrlen) == FAILURE)
 	{
 		std::cerr << RED << "[Server] Bind failed" << RESET << std::endl;
+		close(listen_fd);
 		return (FAILURE);
 	}
-	if (listen(_server_socket_fd, BACKLOG) == FAILURE)
+	if (listen(listen_fd, BACKLOG) == FAILURE)
 	{
 		std::cerr << RED << "[Server] Listen failed" << RESET << std::endl;
+		close(listen_fd);
+		return (FAILURE);
+	}
+	if (setNonBlocking(listen_fd) == FAILURE)
+	{
+		std::cerr << RED << "[Server] fcntl() failed" << RESET << std::endl;
+		close(listen_fd);
 		return (FAILURE);
 	}
+	return (listen_fd);
+}
+
+/**
+ * @brief Opens the listening socket and sets up the event backend used by
+ * 		  manageServerLoop. With several reactors, each reactor shard gets a
+ * 		  listening socket of its own instead, and the core only waits on
+ * 		  its mailbox (see ReactorShard).
+ *
+ * @return int 0 for SUCCESS and -1 for FAILURE
+ */
+int Server::launchServer()
+{
+	if (_settings.reactors > 1)
+	{
+		int	status = launchShards();
+
+		freeaddrinfo(_servinfo);
+		return (status == FAILURE ? FAILURE : launchWorkers());
+	}
+	_server_socket_fd = openListener(false);
 	freeaddrinfo(_servinfo);
-	return (SUCCESS);
+	if (_server_socket_fd == FAILURE)
+		return (FAILURE);
+	_reactor = Reactor::create(_settings.reactor);
+	if (_reactor->add(_server_socket_fd, Reactor::READ | Reactor::LISTEN) == FAILURE)
+	{
+		std::cerr << RED << "[Server] Reactor registration failed" << RESET << std::endl;
+		return (FAILURE);
+	}
+	std::cout << YELLOW << "[Server] Event backend: " << _reactor->getName() << RESET << std::endl;
+	return (launchWorkers());
 }
 
-void Server::addClient(int client_socket, std::vector<pollfd> &poll_fds)
+int Server::launchShards()
 {
-	pollfd client_pollfd;
-	Client new_client(client_socket);
+	if (_mailbox.open() == FAILURE)
+	{
+		std::cerr << RED << "[Server] eventfd() failed" << RESET << std::endl;
+		return (FAILURE);
+	}
+	for (unsigned i = 0; i < _settings.reactors; i++)
+	{
+		int	listen_fd = openListener(true);
 
-	client_pollfd.fd = client_socket;
-	client_pollfd.events = POLLIN;
-	poll_fds.push_back(client_pollfd);
+		if (listen_fd == FAILURE)
+			return (FAILURE);
+		_shards.push_back(new ReactorShard(i, listen_fd, _mailbox));
+		if (_shards.back()->start(_settings.reactor) == FAILURE)
+		{
+			std::cerr << RED << "[Server] Reactor shard " << i << " failed to start" << RESET << std::endl;
+			return (FAILURE);
+		}
+	}
+	std::cout << YELLOW << "[Server] " << _shards.size() << " reactor shards" << RESET << std::endl;
+	return (SUCCESS);
+}
 
-	_clients.insert(std::pair<int, Client>(client_socket, new_client)); // insert a new nod in client map with the fd as key
+/**
+ * @param shard Reactor shard that accepted the connection and owns its
+ * 		  socket from now on, -1 without reactor threads
+ */
+void Server::addClient(int client_socket, ip_address const &address, int shard)
+{
+	if (setNonBlocking(client_socket) == FAILURE
+		|| (shard == FAILURE && _reactor->add(client_socket, Reactor::READ) == FAILURE))
+	{
+		std::cerr << RED << "[Server] Could not register client " << client_socket << RESET << std::endl;
+		close(client_socket);
+		return ;
+	}
+	Client *client = _clients.insert(client_socket); // new Client in the slot of its fd
+	if (client != NULL)
+	{
+		connection_class const	&limits = getConnectionClass(address);
+
+		client->setAddress(address);
+		client->setSendqLimits(limits.sendq_soft, limits.sendq_hard);
+		client->setLastActivity(_now);
+		client->getFlood().reset(_now, _settings.flood_burst);
+		_connections.add(address);
+		scheduleTimer(TIMER_CLIENT, _clients.getHandle(client_socket), _now + _settings.registration_timeout * 1000ULL);
+		client->setShard(shard);
+		if (shard != FAILURE)
+			postToShard(*client, SHARD_ADD);
+	}
+	else if (shard != FAILURE)
+		close(client_socket); // its fd is still in use for the core
 	std::cout << PURPLE << "[Server] ADDED CLIENT SUCCESSFULLY" << RESET << std::endl;
 }
 
-void Server::delClient(std::vector<pollfd> &poll_fds, std::vector<pollfd>::iterator &it, int current_fd)
+void Server::delClient(int current_fd)
 {
 	std::cout << "[Server] Disconnection of client : " << current_fd << std::endl;
-	int key = current_fd;
-
+	if (_shards.empty()) // a shard removes its sockets itself
+		_reactor->remove(current_fd);
 	close(current_fd);
-	_clients.erase(key);
-	poll_fds.erase(it);
 
-	std::cout << "[Server] " << PURPLE << "Client deleted. Total Client is now: " << (unsigned int)(poll_fds.size() - 1) << RESET << std::endl;
+	// its fd may be reused right away: the channels must forget this client first
+	Client	*client = _clients.find(current_fd);
+	if (client != NULL)
+	{
+		removeClientFromAllChannels(*client);
+		_connections.remove(client->getAddress());
+	}
+	_clients.erase(current_fd);
+
+	std::cout << "[Server] " << PURPLE << "Client deleted. Total Client is now: " << (unsigned int)_clients.size() << RESET << std::endl;
+}
+
+/**
+ * @brief Makes the server close a connection on its own: the channels of the
+ * 		  client see it QUIT, the client gets an ERROR, and its connection is
+ * 		  closed once that has been flushed.
+ */
+void Server::quitClient(Client &client, std::string const &reason)
+{
+	std::string	id = user_id(client.getNickname(), client.getUsername());
+
+	addToCoMembersBuffer(this, client, makeSharedBuffer(RPL_QUIT(id, reason)));
+	removeClientFromAllChannels(client);
+	addToClientBuffer(this, client.getClientFd(), ERR_CLOSINGLINK(client.getHostname(), reason));
+	client.setDeconnexionStatus(true);
+	updateWriteInterest(client);
+}
+
+/**
+ * @brief Called when the replies queued for client go past its hard limit:
+ * 		  they are dropped and the client stops receiving anything. It is
+ * 		  disconnected by dropSlowClients(), once the command being run is
+ * 		  over (it may be walking the very channel the client is leaving).
+ */
+void Server::sendqExceeded(Client &client)
+{
+	std::cerr << RED << "[Server] SendQ exceeded for client " << client.getClientFd()
+		<< " (" << client.getSendqSize() << " bytes)" << RESET << std::endl;
+	{
+		std::lock_guard<std::mutex>	guard(client.getSendqLock());
+
+		client.dropSendBuffer();
+	}
+	client.setSendqExceeded(true);
+	_slow_clients.push_back(_clients.getHandle(client.getClientFd()));
+}
+
+void Server::dropSlowClients()
+{
+	std::vector<client_handle>	slow_clients;
+
+	slow_clients.swap(_slow_clients);
+	for (size_t i = 0; i < slow_clients.size(); i++)
+	{
+		Client	*client = _clients.find(slow_clients[i]);
+
+		if (client == NULL || client->getDeconnexionStatus() == true)
+			continue ;
+		client->setSendqExceeded(false); // lets the ERROR line through
+		quitClient(*client, "SendQ exceeded");
+	}
+}
+
+/**
+ * @brief Subscribes the client to WRITE events only while it has replies
+ * 		  waiting (or must be disconnected once they are flushed), so idle
+ * 		  connections never wake the loop up.
+ */
+void Server::updateWriteInterest(Client &client)
+{
+	if (client.getShard() != FAILURE)
+		return (signalShard(client));
+
+	bool	wanted = client.hasPendingData() || client.getDeconnexionStatus();
+	int		events = Reactor::READ;
+
+	if (wanted == client.hasWriteInterest())
+		return ;
+	if (wanted)
+		events |= Reactor::WRITE;
+	if (_reactor->modify(client.getClientFd(), events) == SUCCESS)
+		client.setWriteInterest(wanted);
+}
+
+/**
+ * @brief Same as updateWriteInterest for a socket owned by a reactor shard:
+ * 		  tells the shard there are replies to write (once until it takes
+ * 		  them), or that the client must be closed once they are written.
+ */
+void Server::signalShard(Client &client)
+{
+	bool	pending;
+
+	if (client.getDeconnexionStatus() == true)
+	{
+		if (client.isCloseSignaled() == false)
+		{
+			client.setCloseSignaled();
+			postToShard(client, SHARD_CLOSE);
+		}
+		return ;
+	}
+	{
+		std::lock_guard<std::mutex>	guard(client.getSendqLock());
+
+		pending = client.hasPendingData();
+	}
+	if (pending && client.signalFlush())
+		postToShard(client, SHARD_FLUSH);
+}
+
+void Server::postToShard(Client &client, shard_message_type type)
+{
+	shard_message	message;
+
+	message.type = type;
+	message.fd = client.getClientFd();
+	message.client = _clients.getHandle(client.getClientFd());
+	message.target = &client;
+	_shards[client.getShard()]->getInbox().post(message);
 }
 
 /**
@@ -184,20 +577,20 @@ void Server::delClient(std::vector<pollfd> &poll_fds, std::vector<pollfd>::itera
  *      "Welcome to the Internet Relay Network
  *       <nick>!<user>@<host>"
  */
-std::string getWelcomeReply(std::map<const int, Client>::iterator &it)
+std::string getWelcomeReply(Client &client)
 {
 	std::stringstream	rpl_welcome;
 	std::string			host = "localhost";
 	std::string			space = " ";
 	std::string			welcome = " :Welcome to the Internet Relay Network ";
 	std::string			rpl_code = "001";
-	std::string			user_id = it->second.getNickname() + "!" + it->second.getUsername() + "@" + host;
+	std::string			user_id = client.getNickname() + "!" + client.getUsername() + "@" + host;
 	std::string			end = "\r\n";
 	
 	// reset the stringstream
 	rpl_welcome.str(std::string());
 	// write in the stream to append everything in one line and properly terminate it with a NULL operator
-	rpl_welcome << ":" << host << space << rpl_code << space << it->second.getNickname() << welcome << user_id << end;
+	rpl_welcome << ":" << host << space << rpl_code << space << client.getNickname() << welcome << user_id << end;
 	// convert the stream in the required std::string
 	return (rpl_welcome.str());
 }
@@ -207,142 +600,120 @@ std::string	cleanStr(std::string str)
 	// Erase the space at the beginning of the str (i.e " marine sanjuan" must be "marine sanjuan")
 	if (str.find(' ') != std::string::npos && str.find(' ') == 0)
 		str.erase(str.find(' '), 1);
-	// Erase any Carriage Returns in the str. Note : the '\n' has already be dealt with in the function SplitMessage
+	// Erase any Carriage Returns in the str. Note : the '\n' has already be dealt with by the RingBuffer
 	if (str.find('\r') != std::string::npos)
 		str.erase(str.find('\r'), 1);
 	return (str);
 }
 
-void Server::fillClients(std::map<const int, Client> &client_list, int client_fd, std::string cmd)
-{
-	std::map<const int, Client>::iterator it = client_list.find(client_fd);
-	cmd_struct cmd_infos;
-	parseCommand(cmd, cmd_infos);
-
-	if (cmd.find("NICK") != std::string::npos)
-		nick(this, client_fd, cmd_infos);
-	else if (cmd.find("USER") != std::string::npos)
-		user(this, client_fd, cmd_infos);
-	else if (cmd.find("PASS") != std::string::npos)
-	{
-		if (pass(this, client_fd, cmd_infos) == SUCCESS)
-			it->second.setConnexionPassword(true);
-		else
-			it->second.setConnexionPassword(false);
-	}
-}
-
-static void splitMessage(std::vector<std::string> &cmds, std::string msg)
+/**
+ * @brief Handles one line received from a client (without its "\r\n"):
+ * 		  registration commands until the client is welcomed, then any command.
+ * 		  The line comes split and its command looked up by the side that
+ * 		  framed it (see InputTimeline), handlers get the result.
+ *
+ * 		  Operators aside, a command first takes its cost in tokens from the
+ * 		  client's bucket (see LagCompensation); without enough of them, it
+ * 		  is held until they are back (see throttleClient).
+ *
+ * 		  With channel workers, a command aimed at one channel is handed to
+ * 		  the worker owning it (see channelOwner). The client's next commands
+ * 		  are held until it ran, unless they go to the same worker. They are
+ * 		  held the same way while a LIST or NAMES of its runs in slices
+ * 		  (see scheduleTask).
+ *
+ * @return unsigned The cost of the command (command_spec::cost), 1 for the
+ * 		   unknown ones, charged to the client's command budget; 0 if the
+ * 		   command was held and not run
+ */
+unsigned Server::parseMessage(int const client_fd, timeline_entry const &entry)
 {
-	int pos = 0;
-	std::string delimiter = "\n";
-	std::string substr;
-
-	while ((pos = msg.find(delimiter)) != static_cast<int>(std::string::npos))
+	Client				&client = *_clients.find(client_fd);
+	cmd_struct			cmd_infos;
+	const command_spec	*spec;
+	unsigned			cost;
+	int					worker;
+
+	if (entry.has_command == false)
+		return (1);
+	cmd_infos.tokens = entry.tokens;
+	fillCommand(entry.line, cmd_infos);
+	spec = entry.spec;
+	cost = (spec ? spec->cost : 1);
+	worker = channelOwner(client, spec, cmd_infos);
+	if (client.hasTaskPending())
+		return (0); // runTaskSlices resumes it
+	if (client.getWorker() != FAILURE && worker != client.getWorker())
+		return (0); // runChannelJobs resumes it
+	if (_settings.flood_rate != 0 && client.hasMode(UMODE_OPERATOR) == false
+		&& client.getFlood().consume(cost, _now, _settings.flood_rate, _settings.flood_burst) == false)
 	{
-		substr = msg.substr(0, pos);
-		cmds.push_back(substr);
-		msg.erase(0, pos + delimiter.length());
+		throttleClient(client, cost);
+		return (0);
 	}
-}
-
-void Server::parseMessage(int const client_fd, std::string message)
-{
-	std::vector<std::string>				cmds;
-	std::map<const int, Client>::iterator	it = _clients.find(client_fd);
-
-	splitMessage(cmds, message);
-
-	for (size_t i = 0; i != cmds.size(); i++)
+	if (client.isRegistrationDone() == false)
 	{
-		if (it->second.isRegistrationDone() == false)
+		// NICK stays open so a client whose nickname was in use can pick another
+		if (client.hasAllInfo() == false || cmd_infos.name == "NICK")
 		{
-			if (it->second.hasAllInfo() == false)
-			{
-				fillClients(_clients, client_fd, cmds[i]);
-				if (cmds[i].find("USER") != std::string::npos)
-					it->second.hasAllInfo() = true;
-			}
-			if (it->second.hasAllInfo() == true && it->second.isWelcomeSent() == false)
+			execCommand(client_fd, cmd_infos);
+			if (cmd_infos.name == "USER")
+				client.hasAllInfo() = true;
+		}
+		if (client.hasAllInfo() == true && client.isWelcomeSent() == false)
+		{
+			if (client.getNickname().empty() == true && client.getConnexionPassword() == true)
+				return (cost);
+			if (client.is_valid() == SUCCESS)
 			{
-				if (it->second.is_valid() == SUCCESS)
-				{
-					addToClientBuffer(this, client_fd, getWelcomeReply(it));
-					addToClientBuffer(this, client_fd, RPL_YOURHOST(it->second.getNickname(), "42_Ftirc", "1.1"));
- 					addToClientBuffer(this, client_fd, RPL_CREATED(it->second.getNickname(), getDatetime()));
- 					addToClientBuffer(this, client_fd, RPL_MYINFO(it->second.getNickname(), "localhost", "1.1", "io", "okst", "k"));
- 					addToClientBuffer(this, client_fd, RPL_ISUPPORT(it->second.getNickname(), "CHANNELLEN=32 NICKLEN=9 TOPICLEN=307"));
-					it->second.isWelcomeSent() = true;
-					it->second.isRegistrationDone() = true;
-				}		
-				else
-					throw Server::InvalidClientException();
-			}
+				addToClientBuffer(this, client_fd, getWelcomeReply(client));
+				addToClientBuffer(this, client_fd, RPL_YOURHOST(client.getNickname(), "42_Ftirc", "1.1"));
+				addToClientBuffer(this, client_fd, RPL_CREATED(client.getNickname(), getDatetime()));
+				addToClientBuffer(this, client_fd, RPL_MYINFO(client.getNickname(), "localhost", "1.1", userModeLetters(), channelModeLetters(false), channelModeLetters(true)));
+				addToClientBuffer(this, client_fd, RPL_ISUPPORT(client.getNickname(), "CHANNELLEN=32 NICKLEN=9 TOPICLEN=307"));
+				client.isWelcomeSent() = true;
+				client.isRegistrationDone() = true;
+			}		
+			else
+				throw Server::InvalidClientException();
 		}
-		else
-			execCommand(client_fd, cmds[i]);
 	}
+	else if (worker != FAILURE)
+		dispatchChannelCommand(client, worker, entry.line);
+	else
+		execCommand(client_fd, cmd_infos);
+	return (cost);
 }
 
-void Server::execCommand(int const client_fd, std::string cmd_line)
+/**
+ * @brief Runs a command through the dispatch table, after the checks its
+ * 		  metadata asks for (registration state, number of parameters).
+ */
+void Server::execCommand(int const client_fd, cmd_struct &cmd_infos)
 {
-	std::string	validCmds[VALID_LEN] = {
-		"INVITE",
-		"JOIN",
-		"KICK",
-		"KILL",
-		"LIST",
-		"MODE",
-		"NAMES",
-		"NICK",
-		"NOTICE",
-		"OPER",
-		"PART",
-		"PING",
-		"PRIVMSG",
-		"QUIT",
-		"TOPIC",
-		"USER",
-		};
-
-	Client *client = getClient(this, client_fd);
-	cmd_struct cmd_infos;
-	int index = 0;
-
-	parseCommand(cmd_line, cmd_infos);
-
-	while (index < VALID_LEN)
-	{
-		if (cmd_infos.name == validCmds[index])
-			break;
-		index++;
-	}
+	Client				*client = getClient(this, client_fd);
+	const command_spec	*cmd = findCommand(cmd_infos.name);
+	bool				registered = client->isRegistrationDone();
 
-	switch (index + 1)
+	if (cmd == NULL)
 	{
-		case 1: invite(this, client_fd, cmd_infos); break;
-		case 2: join(this, client_fd, cmd_infos); break;
-		case 3: kick(this, client_fd, cmd_infos); break;
-		case 4: kill(this, client_fd, cmd_infos); break;
-		case 5: list(this, client_fd, cmd_infos); break;
-		case 6: modeFunction(this, client_fd, cmd_infos); break;
-		case 7: names(this, client_fd, cmd_infos); break;
-		case 8: nick(this, client_fd, cmd_infos); break;
-    	case 9: notice(this, client_fd, cmd_infos); break;
-		case 10: oper(this, client_fd, cmd_infos); break;
-		case 11: part(this, client_fd, cmd_infos); break;
-		case 12: ping(this, client_fd, cmd_infos); break;
-		case 13: privmsg(this, client_fd, cmd_infos); break;
-		case 14: quit(this, client_fd, cmd_infos); break;
-		case 15: topic(this, client_fd, cmd_infos); break;
-		case 16: user(this, client_fd, cmd_infos); break;
-		default:
+		// Unregistered clients probe for extensions (CAP...): ignored
+		if (registered)
 			addToClientBuffer(this, client_fd, ERR_UNKNOWNCOMMAND(client->getNickname(), cmd_infos.name));
 	}
+	else if (registered == false && (cmd->flags & CMD_NEEDS_REGISTRATION))
+		addToClientBuffer(this, client_fd, ERR_NOTREGISTERED(client->getNickname()));
+	else if (registered == true && (cmd->flags & CMD_BEFORE_REGISTRATION))
+		addToClientBuffer(this, client_fd, ERR_ALREADYREGISTERED(client->getNickname()));
+	else if (cmd_infos.tokens.param_count < cmd->min_params)
+		addToClientBuffer(this, client_fd, ERR_NEEDMOREPARAMS(client->getNickname(), cmd_infos.name));
+	else
+		cmd->handler(this, client_fd, cmd_infos);
 }
 
 void Server::addChannel(std::string &channelName)
 {
+	assert(ChannelWorker::current() == NULL); // see ::addChannel
 	std::map<std::string, Channel>::iterator it = _channels.find(channelName);
 	if (it != _channels.end())
 	{
@@ -353,16 +724,46 @@ void Server::addChannel(std::string &channelName)
 	_channels.insert(std::pair<std::string, Channel>(channel.getName(), channel));
 }
 
+/**
+ * @brief Makes the client a member of the channel. The channel only records
+ * 		  the client's handle, and the client records the channel name, so
+ * 		  each side can find the other without scanning.
+ */
 void Server::addClientToChannel(std::string &channelName, Client &client)
 {
 	std::map<std::string, Channel>::iterator it;
 	it = _channels.find(channelName);
-	std::string client_nickname = client.getNickname();
-	if (it->second.doesClientExist(client_nickname) == false)
+	if (it->second.doesClientExist(client.getClientFd()) == false)
 	{
-		it->second.addClientToChannel(client);
+		it->second.addClientToChannel(_clients.getHandle(client.getClientFd()));
+		{
+			std::lock_guard<std::mutex>	guard(client.getJoinedLock());
+
+			client.getJoinedChannels().insert(channelName);
+		}
 		std::cout << "Client successfully joined the channel" << channelName << "!" << std::endl;
 	}
 	else 
 		std::cout << YELLOW << client.getNickname() << "already here\n" << RESET;
 }
+
+void Server::removeClientFromChannel(std::string const &channelName, Client &client)
+{
+	std::map<std::string, Channel>::iterator it = _channels.find(channelName);
+
+	if (it != _channels.end())
+		it->second.removeClientFromChannel(client.getClientFd());
+
+	std::lock_guard<std::mutex>	guard(client.getJoinedLock()); // a KICK may run on another worker
+
+	client.getJoinedChannels().erase(channelName);
+}
+
+void Server::removeClientFromAllChannels(Client &client)
+{
+	std::set<std::string>	joined;
+
+	joined.swap(client.getJoinedChannels());
+	for (std::set<std::string>::iterator it = joined.begin(); it != joined.end(); it++)
+		removeClientFromChannel(*it, client);
+}
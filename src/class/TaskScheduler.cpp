@@ -0,0 +1,140 @@
+#include "TaskScheduler.hpp"
+#include "Server.hpp"
+
+SlicedTask::SlicedTask(client_handle client) : _client(client), _done(false), _failed(false)
+{
+}
+
+SlicedTask::~SlicedTask()
+{
+}
+
+client_handle	SlicedTask::getClient() const	{ return (_client); }
+bool			SlicedTask::isDone() const		{ return (_done); }
+bool			SlicedTask::hasFailed() const	{ return (_failed); }
+
+/**
+ * @brief Runs the next slice for the client, if it is still there. A slice
+ * 		  that throws ends the task, and the core disconnects the client as
+ * 		  it would for a command.
+ */
+void	SlicedTask::run(Server &server)
+{
+	Client	*client = server.getClients().find(_client);
+
+	if (client == NULL || client->getDeconnexionStatus()) // it left in the meantime
+	{
+		_done = true;
+		return ;
+	}
+	try
+	{
+		_done = runSlice(server, *client);
+	}
+	catch(const std::exception& e)
+	{
+		std::cerr << "[Task] Caught exception : " << e.what() << std::endl;
+		_done = true;
+		_failed = true;
+	}
+}
+
+TaskScheduler::TaskScheduler() : _queued(0), _held(false)
+{
+	pthread_rwlockattr_t	attr;
+
+	pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+	pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+	pthread_rwlock_init(&_state, &attr);
+	pthread_rwlockattr_destroy(&attr);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	for (size_t i = 0; i < _deques.size(); i++)
+		delete _deques[i];
+	if (_held) // the core left its loop
+		pthread_rwlock_unlock(&_state);
+	pthread_rwlock_destroy(&_state);
+}
+
+/**
+ * @brief One deque per thread, before any of them starts.
+ */
+void	TaskScheduler::resize(size_t threads)
+{
+	while (_deques.size() < threads)
+		_deques.push_back(new task_deque());
+}
+
+size_t	TaskScheduler::size() const	{ return (_deques.size()); }
+
+void	TaskScheduler::push(size_t thread, SlicedTask *task)
+{
+	std::lock_guard<std::mutex>	guard(_deques[thread]->lock);
+
+	_deques[thread]->tasks.push_back(task);
+	_queued.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Next task for the thread: its own newest one, else the oldest one
+ * 		  of the next deque that has any.
+ *
+ * @return false once every deque is empty
+ */
+bool	TaskScheduler::next(size_t thread, SlicedTask *&task)
+{
+	for (size_t i = 0; i < _deques.size(); i++)
+	{
+		task_deque					&victim = *_deques[(thread + i) % _deques.size()];
+		std::lock_guard<std::mutex>	guard(victim.lock);
+
+		if (victim.tasks.empty())
+			continue ;
+		if (i == 0)
+		{
+			task = victim.tasks.back();
+			victim.tasks.pop_back();
+		}
+		else
+		{
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+		}
+		_queued.fetch_sub(1, std::memory_order_acq_rel);
+		return (true);
+	}
+	return (false);
+}
+
+/**
+ * @brief The core takes the server state back, once the slices running
+ * 		  are over.
+ */
+void	TaskScheduler::lockState()
+{
+	pthread_rwlock_wrlock(&_state);
+	_held = true;
+}
+
+/**
+ * @brief The core lets the slices run until lockState().
+ *
+ * @return size_t The tasks queued, the workers to wake up
+ */
+size_t	TaskScheduler::unlockState()
+{
+	_held = false;
+	pthread_rwlock_unlock(&_state);
+	return (_queued.load(std::memory_order_acquire));
+}
+
+/**
+ * @return false if the core holds the state or is about to
+ */
+bool	TaskScheduler::tryShareState()	{ return (pthread_rwlock_tryrdlock(&_state) == 0); }
+
+void	TaskScheduler::unshareState()	{ pthread_rwlock_unlock(&_state); }
@@ -0,0 +1,111 @@
+#include "TimerWheel.hpp"
+
+static const uint64_t	max_delay = (static_cast<uint64_t>(1) << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
+
+/**
+ * @brief Milliseconds of the coarse monotonic clock. It is only as precise
+ * 		  as the kernel tick (a few ms), which is plenty for timeouts counted
+ * 		  in seconds, and costs no system call.
+ */
+uint64_t	monotonicMs()
+{
+	struct timespec	ts;
+
+#ifdef CLOCK_MONOTONIC_COARSE
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+	return (static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000);
+}
+
+TimerWheel::TimerWheel() : _now(0), _size(0) {}
+
+TimerWheel::~TimerWheel() {}
+
+/**
+ * @brief Puts entry in the slot of the lowest level whose range covers its
+ * 		  distance from _now.
+ */
+void	TimerWheel::place(timer const &entry)
+{
+	uint64_t	delay = entry.expiry - _now;
+	int			level = 0;
+
+	while (level < TIMER_WHEEL_LEVELS - 1 && delay >= (static_cast<uint64_t>(1) << (TIMER_WHEEL_BITS * (level + 1))))
+		level++;
+	_slots[level][(entry.expiry >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)].push_back(entry);
+}
+
+/**
+ * @brief Adds a timer firing at entry.expiry. A tick already passed fires at
+ * 		  the next one, a tick too far ahead at the furthest one.
+ */
+void	TimerWheel::schedule(timer entry)
+{
+	if (entry.expiry <= _now)
+		entry.expiry = _now + 1;
+	else if (entry.expiry - _now > max_delay)
+		entry.expiry = _now + max_delay;
+	place(entry);
+	_size++;
+}
+
+/**
+ * @brief Moves the wheel forward to tick, appending the timers that fired
+ * 		  on the way to expired, in tick order.
+ */
+void	TimerWheel::advance(uint64_t tick, std::vector<timer> &expired)
+{
+	if (_size == 0 && tick > _now) // nothing to walk through
+		_now = tick;
+	while (_now < tick)
+	{
+		_now++;
+		// when a level wraps around, the next slot of the level above comes down
+		for (int level = 1; level < TIMER_WHEEL_LEVELS; level++)
+		{
+			if ((_now & ((static_cast<uint64_t>(1) << (TIMER_WHEEL_BITS * level)) - 1)) != 0)
+				break ;
+			std::vector<timer>	cascade;
+
+			cascade.swap(_slots[level][(_now >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)]);
+			for (size_t i = 0; i < cascade.size(); i++)
+				place(cascade[i]);
+		}
+
+		std::vector<timer>	&due = _slots[0][_now & (TIMER_WHEEL_SLOTS - 1)];
+
+		_size -= due.size();
+		expired.insert(expired.end(), due.begin(), due.end());
+		due.clear();
+		if (_size == 0)
+			_now = tick;
+	}
+}
+
+/**
+ * @brief Tick at which advance() has something to do: the next timer due
+ * 		  within the current turn of level 0, or the end of that turn (when
+ * 		  the level above cascades), so an idle wheel wakes up at most once
+ * 		  every 64 ticks.
+ *
+ * @return 0 if the wheel is empty
+ */
+uint64_t	TimerWheel::nextTick() const
+{
+	uint64_t	turn_end = (_now | (TIMER_WHEEL_SLOTS - 1)) + 1;
+
+	if (_size == 0)
+		return (0);
+	for (uint64_t tick = _now + 1; tick < turn_end; tick++)
+	{
+		if (_slots[0][tick & (TIMER_WHEEL_SLOTS - 1)].empty() == false)
+			return (tick);
+	}
+	return (turn_end);
+}
+
+uint64_t	TimerWheel::now() const		{ return (_now); }
+
+size_t		TimerWheel::size() const	{ return (_size); }
@@ -0,0 +1,750 @@
+#include "UringReactor.hpp"
+
+#ifdef __linux__
+# include <sys/mman.h>
+# include <sys/syscall.h>
+# include <csignal>
+# include <algorithm>
+
+# define URING_OP_ACCEPT	1ULL
+# define URING_OP_RECV		2ULL
+# define URING_OP_SEND		3ULL
+# define URING_OP_CANCEL	4ULL
+# define URING_OP_PROVIDE	5ULL
+# define URING_OP_PROBE		6ULL
+# define URING_OP_POLL		7ULL
+# define URING_GEN_MASK		0xFFFFFFU
+
+/*
+ * user_data layout: [ operation:8 | generation:24 | fd or send slot:32 ]
+ * The generation lets completions of a previous owner of a reused fd be told
+ * apart from the current connection.
+ */
+static uint64_t	packUserData(uint64_t op, unsigned gen, unsigned id)
+{
+	return ((op << 56) | (static_cast<uint64_t>(gen & URING_GEN_MASK) << 32) | id);
+}
+
+static unsigned	getOp(uint64_t user_data)	{ return (user_data >> 56); }
+static unsigned	getGen(uint64_t user_data)	{ return ((user_data >> 32) & URING_GEN_MASK); }
+static unsigned	getId(uint64_t user_data)	{ return (user_data & 0xFFFFFFFFU); }
+
+static int	sys_io_uring_setup(unsigned entries, struct io_uring_params *params)
+{
+	return (syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int	sys_io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+	return (syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+static int	sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, const void *arg, size_t argsz)
+{
+	return (syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz));
+}
+
+UringReactor::UringReactor()
+: _ring_fd(FAILURE), _sq_ring(MAP_FAILED), _sq_ring_size(0), _sq_head(NULL), _sq_tail(NULL),
+  _sq_mask(NULL), _sq_array(NULL), _sqes(static_cast<struct io_uring_sqe *>(MAP_FAILED)), _sqes_size(0),
+  _sq_local_tail(0), _cq_ring(MAP_FAILED), _cq_ring_size(0), _cq_head(NULL), _cq_tail(NULL), _cq_mask(NULL),
+  _cqes(NULL), _buf_base(NULL)
+{
+	memset(&_params, 0, sizeof(_params));
+	if (setupRing() == false || setupBuffers() == false || probeSupport() == false)
+	{
+		if (_ring_fd != FAILURE)
+			close(_ring_fd);
+		_ring_fd = FAILURE;
+	}
+}
+
+UringReactor::~UringReactor()
+{
+	for (size_t i = 0; i < _sends.size(); i++)
+		delete _sends[i];
+	if (_ring_fd != FAILURE)
+		close(_ring_fd);
+	if (_sqes != MAP_FAILED)
+		munmap(_sqes, _sqes_size);
+	if (_cq_ring != MAP_FAILED && _cq_ring != _sq_ring)
+		munmap(_cq_ring, _cq_ring_size);
+	if (_sq_ring != MAP_FAILED)
+		munmap(_sq_ring, _sq_ring_size);
+	delete [] _buf_base;
+}
+
+bool		UringReactor::isValid() const			{ return (_ring_fd != FAILURE); }
+
+const char*	UringReactor::getName() const			{ return ("uring"); }
+
+bool		UringReactor::isEdgeTriggered() const	{ return (true); }
+
+/**
+ * @brief Creates the ring and maps its submission/completion queues.
+ */
+bool		UringReactor::setupRing()
+{
+	int ring_fd = sys_io_uring_setup(URING_ENTRIES, &_params);
+	if (ring_fd < 0)
+		return (false);
+	_ring_fd = ring_fd;
+
+	_sq_ring_size = _params.sq_off.array + _params.sq_entries * sizeof(unsigned);
+	_cq_ring_size = _params.cq_off.cqes + _params.cq_entries * sizeof(struct io_uring_cqe);
+	if (_params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		_sq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+		_cq_ring_size = _sq_ring_size;
+	}
+	_sq_ring = mmap(NULL, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+	if (_sq_ring == MAP_FAILED)
+		return (false);
+	if (_params.features & IORING_FEAT_SINGLE_MMAP)
+		_cq_ring = _sq_ring;
+	else
+		_cq_ring = mmap(NULL, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_CQ_RING);
+	if (_cq_ring == MAP_FAILED)
+		return (false);
+	_sqes_size = _params.sq_entries * sizeof(struct io_uring_sqe);
+	_sqes = static_cast<struct io_uring_sqe *>(mmap(NULL, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES));
+	if (_sqes == MAP_FAILED)
+		return (false);
+
+	char *sq = static_cast<char *>(_sq_ring);
+	char *cq = static_cast<char *>(_cq_ring);
+
+	_sq_head = reinterpret_cast<unsigned *>(sq + _params.sq_off.head);
+	_sq_tail = reinterpret_cast<unsigned *>(sq + _params.sq_off.tail);
+	_sq_mask = reinterpret_cast<unsigned *>(sq + _params.sq_off.ring_mask);
+	_sq_array = reinterpret_cast<unsigned *>(sq + _params.sq_off.array);
+	_sq_local_tail = *_sq_tail;
+	_cq_head = reinterpret_cast<unsigned *>(cq + _params.cq_off.head);
+	_cq_tail = reinterpret_cast<unsigned *>(cq + _params.cq_off.tail);
+	_cq_mask = reinterpret_cast<unsigned *>(cq + _params.cq_off.ring_mask);
+	_cqes = reinterpret_cast<struct io_uring_cqe *>(cq + _params.cq_off.cqes);
+	return (true);
+}
+
+/**
+ * @brief Hands URING_BUF_COUNT receive buffers of URING_BUF_SIZE bytes to the
+ * 		  kernel as buffer group URING_BUF_GROUP, used by every multishot recv.
+ * 		  The request is submitted along with the first recv by wait().
+ */
+bool		UringReactor::setupBuffers()
+{
+	_buf_base = new char[URING_BUF_COUNT * URING_BUF_SIZE];
+	for (unsigned short bid = 0; bid < URING_BUF_COUNT; bid++)
+		_to_recycle.push_back(bid);
+	recycleBuffers();
+	return (true);
+}
+
+/**
+ * @brief Checks that the kernel has what the backend relies on. The opcodes
+ * 		  are listed by IORING_REGISTER_PROBE, but the multishot flags are
+ * 		  not: a kernel that does not know them fails the request (-EINVAL)
+ * 		  or answers it once, without IORING_CQE_F_MORE. So a multishot recv
+ * 		  is tried on a socket pair holding one byte. Multishot accept came
+ * 		  before multishot recv (5.19 and 6.0), it is covered by the same test.
+ *
+ * 	The test recv is left to be cancelled: its last completions are dropped
+ * 	by handleCompletion like those of a removed fd.
+ */
+bool		UringReactor::probeSupport()
+{
+	static const unsigned	needed[] = {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND,
+		IORING_OP_PROVIDE_BUFFERS, IORING_OP_ASYNC_CANCEL, IORING_OP_POLL_ADD};
+	std::vector<char>		probe_mem(sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op), 0);
+	struct io_uring_probe	*probe = reinterpret_cast<struct io_uring_probe *>(&probe_mem[0]);
+	int						pair[2];
+	struct io_uring_sqe		*sqe;
+	bool					multishot = false;
+	bool					answered = false;
+
+	if (sys_io_uring_register(_ring_fd, IORING_REGISTER_PROBE, probe, 256) < 0)
+		return (false);
+	for (size_t i = 0; i < sizeof(needed) / sizeof(needed[0]); i++)
+	{
+		if (needed[i] > probe->last_op || (probe->ops[needed[i]].flags & IO_URING_OP_SUPPORTED) == 0)
+			return (false);
+	}
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == FAILURE)
+		return (false);
+	if (write(pair[1], "", 1) == 1 && (sqe = getSqe()) != NULL)
+	{
+		sqe->opcode = IORING_OP_RECV;
+		sqe->fd = pair[0];
+		sqe->ioprio = IORING_RECV_MULTISHOT;
+		sqe->flags = IOSQE_BUFFER_SELECT;
+		sqe->buf_group = URING_BUF_GROUP;
+		sqe->user_data = packUserData(URING_OP_PROBE, 0, 0);
+		while (answered == false && submit(1, 1000) == SUCCESS)
+		{
+			unsigned	head = *_cq_head;
+
+			if (head == __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE))
+				break ; // timed out
+			for (; head != __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE); head++)
+			{
+				struct io_uring_cqe const	&cqe = _cqes[head & *_cq_mask];
+
+				if (getOp(cqe.user_data) != URING_OP_PROBE)
+					continue ;
+				if (cqe.flags & IORING_CQE_F_BUFFER)
+					_to_recycle.push_back(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+				multishot = (cqe.res == 1 && (cqe.flags & IORING_CQE_F_MORE));
+				answered = true;
+			}
+			__atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+		}
+		if (multishot && (sqe = getSqe()) != NULL)
+		{
+			sqe->opcode = IORING_OP_ASYNC_CANCEL;
+			sqe->fd = -1;
+			sqe->addr = packUserData(URING_OP_PROBE, 0, 0);
+			sqe->user_data = packUserData(URING_OP_CANCEL, 0, 0);
+			submit(0, 0);
+		}
+	}
+	close(pair[0]);
+	close(pair[1]);
+	return (multishot);
+}
+
+/**
+ * @brief Gives the buffers consumed during the previous wakeup back to the
+ * 		  kernel. Consecutive buffer ids are merged into a single
+ * 		  IORING_OP_PROVIDE_BUFFERS request.
+ *
+ * 	Registered buffer rings (IORING_REGISTER_PBUF_RING) would save these
+ * 	requests, but they are not reliable on every kernel the server runs on.
+ */
+void		UringReactor::recycleBuffers()
+{
+	if (_to_recycle.empty())
+		return ;
+
+	std::sort(_to_recycle.begin(), _to_recycle.end());
+	for (size_t first = 0, last; first < _to_recycle.size(); first = last)
+	{
+		for (last = first + 1; last < _to_recycle.size(); last++)
+		{
+			if (_to_recycle[last] != _to_recycle[last - 1] + 1)
+				break ;
+		}
+
+		struct io_uring_sqe *sqe = getSqe();
+		unsigned short		bid = _to_recycle[first];
+
+		sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+		sqe->fd = last - first;	// number of buffers
+		sqe->addr = reinterpret_cast<uint64_t>(_buf_base + bid * URING_BUF_SIZE);
+		sqe->len = URING_BUF_SIZE;
+		sqe->off = bid;			// id of the first buffer
+		sqe->buf_group = URING_BUF_GROUP;
+		sqe->user_data = packUserData(URING_OP_PROVIDE, 0, 0);
+	}
+	_to_recycle.clear();
+}
+
+/**
+ * @brief Returns a zeroed submission entry. Entries are only published to the
+ * 		  kernel by submit(); if the queue is full it is flushed first.
+ */
+struct io_uring_sqe*	UringReactor::getSqe()
+{
+	unsigned head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+
+	if (_sq_local_tail - head >= _params.sq_entries)
+	{
+		if (submit(0, 0) == FAILURE)
+			return (NULL);
+		head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+		if (_sq_local_tail - head >= _params.sq_entries)
+			return (NULL);
+	}
+
+	unsigned				index = _sq_local_tail & *_sq_mask;
+	struct io_uring_sqe		*sqe = &_sqes[index];
+
+	memset(sqe, 0, sizeof(*sqe));
+	_sq_array[index] = index;
+	_sq_local_tail++;
+	return (sqe);
+}
+
+/**
+ * @brief Publishes the pending submissions and, if min_complete > 0, waits
+ * 		  for completions (at most timeout_ms when it is >= 0).
+ */
+int			UringReactor::submit(unsigned min_complete, int timeout_ms)
+{
+	unsigned	flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+	unsigned	to_submit;
+	int			ret;
+
+	__atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+	to_submit = _sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+	if (to_submit == 0 && min_complete == 0)
+		return (SUCCESS);
+
+	if (min_complete && timeout_ms >= 0 && (_params.features & IORING_FEAT_EXT_ARG))
+	{
+		struct __kernel_timespec		ts;
+		struct io_uring_getevents_arg	arg;
+
+		ts.tv_sec = timeout_ms / 1000;
+		ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+		memset(&arg, 0, sizeof(arg));
+		arg.ts = reinterpret_cast<uint64_t>(&ts);
+		ret = sys_io_uring_enter(_ring_fd, to_submit, min_complete, flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+	}
+	else
+		ret = sys_io_uring_enter(_ring_fd, to_submit, min_complete, flags, NULL, _NSIG / 8);
+
+	if (ret < 0 && errno != ETIME && errno != EBUSY)
+		return (FAILURE);
+	return (SUCCESS);
+}
+
+UringReactor::fd_state*	UringReactor::getState(int fd)
+{
+	if (fd < 0 || static_cast<size_t>(fd) >= _fds.size() || _fds[fd].registered == false)
+		return (NULL);
+	return (&_fds[fd]);
+}
+
+void		UringReactor::armAccept(int fd)
+{
+	struct io_uring_sqe *sqe = getSqe();
+	if (sqe == NULL)
+		return ;
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = fd;
+	sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	sqe->user_data = packUserData(URING_OP_ACCEPT, _fds[fd].gen, fd);
+}
+
+void		UringReactor::armRecv(int fd)
+{
+	struct io_uring_sqe *sqe = getSqe();
+	if (sqe == NULL)
+		return ;
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = fd;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = URING_BUF_GROUP;
+	sqe->user_data = packUserData(URING_OP_RECV, _fds[fd].gen, fd);
+}
+
+void		UringReactor::armPoll(int fd)
+{
+	struct io_uring_sqe *sqe = getSqe();
+	if (sqe == NULL)
+		return ;
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->poll32_events = POLLIN;
+	sqe->user_data = packUserData(URING_OP_POLL, _fds[fd].gen, fd);
+}
+
+void		UringReactor::cancel(int fd, int op)
+{
+	struct io_uring_sqe *sqe = getSqe();
+	if (sqe == NULL)
+		return ;
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = packUserData(op, _fds[fd].gen, fd);
+	sqe->user_data = packUserData(URING_OP_CANCEL, 0, fd);
+}
+
+/**
+ * @brief Queues the send of the slot. If the submission queue cannot take
+ * 		  it, it waits in _unsubmitted for the next wait(): the fd keeps its
+ * 		  send in flight, so nothing behind it goes out first.
+ */
+void		UringReactor::submitSend(size_t slot)
+{
+	send_op				*op = _sends[slot];
+	struct io_uring_sqe	*sqe = getSqe();
+
+	if (sqe == NULL)
+	{
+		_unsubmitted.push_back(slot);
+		return ;
+	}
+	sqe->opcode = IORING_OP_SEND;
+	sqe->fd = op->fd;
+	sqe->addr = reinterpret_cast<uint64_t>(op->data.data() + op->offset);
+	sqe->len = op->data.size() - op->offset;
+	sqe->msg_flags = MSG_NOSIGNAL;
+	sqe->user_data = packUserData(URING_OP_SEND, 0, slot);
+}
+
+/**
+ * @brief Retries the sends the submission queue was too full for, oldest
+ * 		  first. Those still left wait for the next call.
+ */
+void		UringReactor::submitPendingSends()
+{
+	std::vector<size_t>	pending;
+
+	pending.swap(_unsubmitted);
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		send_op		*op = _sends[pending[i]];
+		fd_state	*state = getState(op->fd);
+
+		if (state == NULL || state->gen != op->gen) // removed meanwhile, the fd may be another's
+		{
+			op->data.clear();
+			_free_sends.push_back(pending[i]);
+		}
+		else if (_unsubmitted.empty() == false) // the queue is still full, keep the order
+			_unsubmitted.push_back(pending[i]);
+		else
+			submitSend(pending[i]);
+	}
+}
+
+/**
+ * @brief Only one send per fd is in flight at a time so that replies cannot
+ * 		  be reordered by the kernel; the next one is queued on completion.
+ */
+void		UringReactor::queueNextSend(int fd)
+{
+	fd_state *state = getState(fd);
+	if (state == NULL || state->sending || state->sendq.empty())
+		return ;
+
+	size_t slot;
+	if (_free_sends.empty())
+	{
+		slot = _sends.size();
+		_sends.push_back(new send_op());
+	}
+	else
+	{
+		slot = _free_sends.back();
+		_free_sends.pop_back();
+	}
+	send_op *op = _sends[slot];
+	op->fd = fd;
+	op->gen = state->gen;
+	op->offset = 0;
+	op->data.swap(state->sendq.front());
+	state->sendq.pop_front();
+	state->sending = true;
+	submitSend(slot);
+}
+
+int			UringReactor::add(int fd, int events)
+{
+	if (fd < 0)
+		return (FAILURE);
+	if (static_cast<size_t>(fd) >= _fds.size())
+	{
+		fd_state empty;
+
+		empty.registered = false;
+		empty.listening = false;
+		empty.notify = false;
+		empty.want_write = false;
+		empty.sending = false;
+		empty.gen = 0;
+		empty.queued = 0;
+		_fds.resize(fd + 1, empty);
+	}
+	if (_fds[fd].registered)
+		return (modify(fd, events));
+
+	fd_state &state = _fds[fd];
+	state.registered = true;
+	state.listening = (events & LISTEN) != 0;
+	state.notify = (events & NOTIFY) != 0;
+	state.want_write = (events & WRITE) != 0;
+	state.sending = false;
+	state.queued = 0;
+	state.sendq.clear();
+	if (state.want_write)
+		_write_interest.push_back(fd);
+	if (state.listening)
+		armAccept(fd);
+	else if (state.notify)
+		armPoll(fd);
+	else
+		armRecv(fd);
+	return (SUCCESS);
+}
+
+int			UringReactor::modify(int fd, int events)
+{
+	fd_state *state = getState(fd);
+	if (state == NULL)
+		return (FAILURE);
+
+	bool want_write = (events & WRITE) != 0;
+	if (want_write && state->want_write == false)
+		_write_interest.push_back(fd);
+	state->want_write = want_write;
+	return (SUCCESS);
+}
+
+/**
+ * @brief Cancels the multishot request of fd and submits the cancellation
+ * 		  right away, before the caller closes the descriptor.
+ */
+int			UringReactor::remove(int fd)
+{
+	fd_state *state = getState(fd);
+	if (state == NULL)
+		return (FAILURE);
+
+	cancel(fd, state->listening ? URING_OP_ACCEPT : (state->notify ? URING_OP_POLL : URING_OP_RECV));
+	state->registered = false;
+	state->want_write = false;
+	state->sending = false;
+	state->queued = 0;
+	state->sendq.clear();
+	state->gen = (state->gen + 1) & URING_GEN_MASK;
+	submit(0, 0);
+	return (SUCCESS);
+}
+
+/**
+ * @brief Copies the reply and queues it for the next submission. Returns -1
+ * 		  with EAGAIN once URING_SENDQ_MAX bytes are waiting for this fd; a
+ * 		  WRITE event is reported again when the backlog shrinks.
+ */
+ssize_t		UringReactor::sendv(int fd, const struct iovec *iov, int iovcnt)
+{
+	fd_state *state = getState(fd);
+	if (state == NULL)
+	{
+		errno = EBADF;
+		return (FAILURE);
+	}
+	if (state->queued >= URING_SENDQ_MAX)
+	{
+		errno = EAGAIN;
+		return (FAILURE);
+	}
+
+	std::string data;
+	for (int i = 0; i < iovcnt; i++)
+		data.append(static_cast<const char *>(iov[i].iov_base), iov[i].iov_len);
+	if (data.empty())
+		return (0);
+
+	ssize_t size = data.size();
+	state->queued += size;
+	state->sendq.push_back(std::string());
+	state->sendq.back().swap(data);
+	queueNextSend(fd);
+	return (size);
+}
+
+void		UringReactor::handleSendCompletion(size_t slot, int res, std::vector<reactor_event> &ready)
+{
+	send_op		*op = _sends[slot];
+	fd_state	*state = getState(op->fd);
+
+	if (state == NULL || state->gen != op->gen) // connection gone, only the buffer is left to free
+	{
+		op->data.clear();
+		_free_sends.push_back(slot);
+		return ;
+	}
+	if (res == -EAGAIN || res == -EINTR)
+	{
+		submitSend(slot);
+		return ;
+	}
+	if (res < 0)
+	{
+		reactor_event event;
+
+		event.fd = op->fd;
+		event.events = ERROR;
+		event.data = NULL;
+		event.result = res;
+		ready.push_back(event);
+		state->sendq.clear();
+		state->queued = 0;
+		state->sending = false;
+		op->data.clear();
+		_free_sends.push_back(slot);
+		return ;
+	}
+	op->offset += res;
+	if (op->offset < op->data.size()) // partial send: queue the remainder
+	{
+		submitSend(slot);
+		return ;
+	}
+	state->queued -= op->data.size();
+	state->sending = false;
+	op->data.clear();
+	_free_sends.push_back(slot);
+	queueNextSend(op->fd);
+}
+
+/**
+ * @brief Errors after which the listening socket can still accept: the
+ * 		  connection was reset before being accepted, or a limit was hit.
+ */
+static bool	isTransientAcceptError(int error)
+{
+	return (error == EINTR || error == EAGAIN || error == ECONNABORTED || error == EPROTO
+		|| error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM);
+}
+
+void		UringReactor::handleCompletion(struct io_uring_cqe const &cqe, std::vector<reactor_event> &ready)
+{
+	unsigned	op = getOp(cqe.user_data);
+
+	if (op == URING_OP_SEND)
+		return (handleSendCompletion(getId(cqe.user_data), cqe.res, ready));
+	if (op == URING_OP_CANCEL || op == URING_OP_PROVIDE || op == URING_OP_PROBE)
+		return ;
+
+	int				fd = getId(cqe.user_data);
+	fd_state		*state = getState(fd);
+	bool			current = (state != NULL && state->gen == getGen(cqe.user_data));
+	bool			more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+	reactor_event	event;
+
+	event.fd = fd;
+	event.data = NULL;
+	event.result = cqe.res;
+	if (op == URING_OP_ACCEPT)
+	{
+		if (cqe.res >= 0 && current == false)
+			close(cqe.res);
+		else if (cqe.res >= 0)
+		{
+			event.events = ACCEPTED;
+			ready.push_back(event);
+		}
+		if (current == false || more)
+			return ;
+		if (cqe.res >= 0 || isTransientAcceptError(-cqe.res))
+			armAccept(fd);
+		else // re-arming would only fail again
+		{
+			event.events = ERROR;
+			ready.push_back(event);
+		}
+		return ;
+	}
+	if (op == URING_OP_POLL) // the eventfd is read by the caller, then polled again
+	{
+		if (current == false)
+			return ;
+		event.events = (cqe.res < 0 ? ERROR : READ);
+		ready.push_back(event);
+		if (cqe.res >= 0)
+			armPoll(fd);
+		return ;
+	}
+
+	// URING_OP_RECV
+	if (cqe.flags & IORING_CQE_F_BUFFER)
+	{
+		unsigned short bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+
+		_to_recycle.push_back(bid); // given back to the kernel on the next wait()
+		event.data = _buf_base + bid * URING_BUF_SIZE;
+	}
+	if (current == false)
+		return ;
+	if (cqe.res > 0 || (cqe.res < 0 && cqe.res != -ENOBUFS))
+	{
+		event.events = RECEIVED;
+		ready.push_back(event);
+	}
+	else if (cqe.res == 0) // end of file, the multishot request is over
+	{
+		event.events = RECEIVED;
+		event.data = NULL;
+		ready.push_back(event);
+		return ;
+	}
+	if (cqe.res >= 0 || cqe.res == -ENOBUFS)
+	{
+		if (more == false)
+			armRecv(fd);
+	}
+}
+
+void		UringReactor::reap(std::vector<reactor_event> &ready)
+{
+	unsigned head = *_cq_head;
+	unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+
+	while (head != tail)
+	{
+		struct io_uring_cqe cqe = _cqes[head & *_cq_mask];
+
+		head++;
+		__atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+		handleCompletion(cqe, ready);
+		tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+	}
+}
+
+/**
+ * @brief One io_uring_enter() submits everything queued since the last call
+ * 		  (recv re-arms, sends, cancellations) and waits for completions.
+ * 		  WRITE is reported for every fd with write interest whose backlog is
+ * 		  below URING_SENDQ_MAX; the call does not block while there are some.
+ */
+int			UringReactor::wait(std::vector<reactor_event> &ready, int timeout_ms)
+{
+	bool	writable = false;
+	size_t	kept = 0;
+
+	ready.clear();
+	recycleBuffers();
+	submitPendingSends();
+	for (size_t i = 0; i < _write_interest.size(); i++)
+	{
+		fd_state *state = getState(_write_interest[i]);
+
+		if (state == NULL || state->want_write == false)
+			continue ;
+		_write_interest[kept++] = _write_interest[i];
+		if (state->queued < URING_SENDQ_MAX)
+			writable = true;
+	}
+	_write_interest.resize(kept);
+
+	bool	pending = (*_cq_head != __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE));
+	bool	block = (writable == false && pending == false && _unsubmitted.empty() && timeout_ms != 0);
+
+	if (submit(block ? 1 : 0, timeout_ms) == FAILURE)
+		return (FAILURE);
+	reap(ready);
+
+	for (size_t i = 0; i < _write_interest.size(); i++)
+	{
+		fd_state *state = getState(_write_interest[i]);
+
+		if (state == NULL || state->want_write == false || state->queued >= URING_SENDQ_MAX)
+			continue ;
+
+		reactor_event event;
+
+		event.fd = _write_interest[i];
+		event.events = WRITE;
+		event.data = NULL;
+		event.result = 0;
+		ready.push_back(event);
+	}
+	return (SUCCESS);
+}
+
+#endif
@@ -12,7 +12,7 @@ static std::string	findChannel(std::string msg_to_parse);
  * 	Syntax : INVITE <nickname> <channel>
  * 
  */
-void	invite(Server *server, int const client_fd, cmd_struct cmd_infos)
+void	invite(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
 	Client&		client			= retrieveClient(server, client_fd);
 	std::string	client_nickname	= client.getNickname();
@@ -21,41 +21,47 @@ void	invite(Server *server, int const client_fd, cmd_struct cmd_infos)
 	
 	if (client_nickname.empty() || channel_name.empty())
 	{
-		sendServerRpl(client_fd, ERR_NEEDMOREPARAMS(client_nickname, cmd_infos.name));
+		addToClientBuffer(server, client_fd, ERR_NEEDMOREPARAMS(client_nickname, cmd_infos.name));
 		return ;
 	}
 
 	// Check if the channel exists
-	std::map<std::string, Channel>			 channels = server->getChannels();
+	std::map<std::string, Channel>&			 channels = server->getChannels();
 	std::map<std::string, Channel>::iterator channel = channels.find(channel_name);
 	if (channel == channels.end())
 	{
-		sendServerRpl(client_fd, ERR_NOSUCHCHANNEL(client_nickname, channel_name));
+		addToClientBuffer(server, client_fd, ERR_NOSUCHCHANNEL(client_nickname, channel_name));
 		return ;
 	}
 	
 	// Check that the person inviting is a member of said channel
-	if (channel->second.doesClientExist(client_nickname) == false)
+	if (channel->second.doesClientExist(client_fd) == false)
 	{
-		sendServerRpl(client_fd, ERR_NOTONCHANNEL(client_nickname, channel_name));
+		addToClientBuffer(server, client_fd, ERR_NOTONCHANNEL(client_nickname, channel_name));
+		return ;
+	}
+
+	// Check that the invited user exists
+	Client *invited = server->getClients().findByNickname(invited_client);
+	if (invited == NULL)
+	{
+		addToClientBuffer(server, client_fd, ERR_NOSUCHNICK(client_nickname, invited_client));
 		return ;
 	}
 
 	// Check that the invited user is not already on the channel
-	if (channel->second.doesClientExist(invited_client) == true)
+	if (channel->second.doesClientExist(invited->getClientFd()) == true)
 	{
-		sendServerRpl(client_fd, ERR_USERONCHANNEL(client_nickname, invited_client, channel_name));
+		addToClientBuffer(server, client_fd, ERR_USERONCHANNEL(client_nickname, invited_client, channel_name));
 		return ;
 	}
 	
 	// If all checks are successful => send a RPL_INVITING + invite to the inviting user 
-	sendServerRpl(client_fd, RPL_INVITING(client_nickname, invited_client, channel_name));
+	addToClientBuffer(server, client_fd, RPL_INVITING(client_nickname, invited_client, channel_name));
 	
-	std::map<std::string, Client> clients = channel->second.getClientList();
-	std::map<std::string, Client>::iterator invited = clients.find(invited_client);
-	std::string user_id = ":" +	invited->second.getNickname() + "!" + invited->second.getUsername() + "@localhost";
+	std::string user_id = ":" +	invited->getNickname() + "!" + invited->getUsername() + "@localhost";
 	std::string invite = user_id + ":Knock knock! You are invited to join the channel #" + channel_name + " by " + client_nickname + " .\r\n";
-	send(invited->second.getClientFd(), invite.c_str(), invite.size(), 0);
+	addToClientBuffer(server, invited->getClientFd(), invite);
 }
 
 // Exemple of user input : "INVITE Wiz #foo_bar"
@@ -2,11 +2,11 @@
 #include "Channel.hpp"
 #include "Server.hpp"
 #include "Commands.hpp"
+#include <cassert>
 
 bool			containsAtLeastOneAlphaChar(std::string str);
 std::string		retrieveKey(std::string msg_to_parse);
 void			addChannel(Server *server, std::string const &channelName);
-void			addClientToChannel(Server *server, std::string &channelName, Client &client);
 void			sendChanInfos(Server *server, Channel &channel, std::string channel_name, Client &client);
 /**
  * @brief The JOIN command indicates that the client wants to join the given channel(s), 
@@ -41,9 +41,9 @@ void			sendChanInfos(Server *server, Channel &channel, std::string channel_name,
  * 	[CLIENT]  JOIN #foo,#bar fubar,foobar
  * 	[SERVER]; join channel #foo using key "fubar" and channel #bar using key "foobar".
  */
-void	join(Server *server, int const client_fd, cmd_struct cmd_infos)
+void	join(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
-	Client		client 			= retrieveClient(server, client_fd);
+	Client&		client 			= retrieveClient(server, client_fd);
 	std::string client_nickname = client.getNickname();
 	std::string	channel_name;
 
@@ -62,25 +62,24 @@ void	join(Server *server, int const client_fd, cmd_struct cmd_infos)
 		{
 			addChannel(server, channel_name);	
 		}
-		else if (it->second.getMode().find('k') != std::string::npos)
+		else if (it->second.hasMode(CMODE_KEY))
  		{
  			std::string key = retrieveKey(cmd_infos.message);
  			cmd_infos.message.erase(cmd_infos.message.find(key), key.length());
  			if (key != it->second.getChannelPassword())
  			{
- 				sendServerRpl(client_fd, ERR_BADCHANNELKEY(client_nickname, channel_name));
+ 				addToClientBuffer(server, client_fd, ERR_BADCHANNELKEY(client_nickname, channel_name));
  				continue;
  			}
  		}
 
 		std::map<std::string, Channel>::iterator it_chan = server->getChannels().find(channel_name);
-		if (it_chan->second.isBanned(client_nickname) == true) {
+		if (it_chan->second.isBanned(client, server->getNow()) == true) {
 			addToClientBuffer(server, client_fd, ERR_BANNEDFROMCHAN(client_nickname, channel_name));
 		} 
 		else {
-			addClientToChannel(server, channel_name, client);
-			if (it_chan->second.getOperators().empty())
-				it_chan->second.addFirstOperator(client.getNickname());
+			server->addClientToChannel(channel_name, client);
+			it_chan->second.addFirstOperator(client_fd);
 			sendChanInfos(server, it_chan->second, channel_name, client);
 		}
 	}
@@ -99,20 +98,23 @@ void		sendChanInfos(Server *server, Channel &channel, std::string channel_name,
 {
 	std::string	nick		= client.getNickname();
 	std::string username	= client.getUsername();
+	std::string	list_of_members = getListOfMembers(server, client, channel);
+	std::string symbol			= getSymbol(channel);
+	// Same lines for every member: serialized once, shared by all the queues
+	shared_buffer	join_rpl	= makeSharedBuffer(RPL_JOIN(user_id(nick, username), channel_name));
+	shared_buffer	topic_rpl	= makeSharedBuffer(RPL_TOPIC(nick, channel_name, channel.getTopic()));
+	shared_buffer	names_rpl	= makeSharedBuffer(RPL_NAMREPLY(username, symbol, channel_name, list_of_members));
+	shared_buffer	end_rpl		= makeSharedBuffer(RPL_ENDOFNAMES(username, channel_name));
  	
-	std::map<std::string, Client>::iterator member = channel.getClientList().begin();
+	member_list::iterator member = channel.getMembers().begin();
 
-	while (member != channel.getClientList().end())
+	while (member != channel.getMembers().end())
 	{
-		addToClientBuffer(server, member->second.getClientFd(), RPL_JOIN(user_id(nick, username), channel_name));
+		addToClientBuffer(server, member->first, join_rpl);
 		if (channel.getTopic().empty() == false)
-			addToClientBuffer(server, member->second.getClientFd(), RPL_TOPIC(nick, channel_name, channel.getTopic()));
-		
-		std::string	list_of_members = getListOfMembers(nick, channel);
-		std::string symbol			= getSymbol(channel);
-
-		addToClientBuffer(server, member->second.getClientFd(), RPL_NAMREPLY(username, symbol, channel_name, list_of_members));
-		addToClientBuffer(server, member->second.getClientFd(), RPL_ENDOFNAMES(username, channel_name));
+			addToClientBuffer(server, member->first, topic_rpl);
+		addToClientBuffer(server, member->first, names_rpl);
+		addToClientBuffer(server, member->first, end_rpl);
 		member++;
 	}
 }
@@ -152,8 +154,14 @@ std::string	retrieveKey(std::string msg_to_parse)
 	return (key);
 }
 
+/**
+ * @brief Only the core adds channels, between two worker batches: the
+ * 		  workers look the channel index up without a lock (see
+ * 		  Server::channelOwner).
+ */
 void	addChannel(Server *server, std::string const &channelName)
 {
+	assert(ChannelWorker::current() == NULL);
 	// check if channel already exists.
 	std::map<std::string, Channel>::iterator it = server->getChannels().find(channelName);
 	if (it != server->getChannels().end())
@@ -165,17 +173,3 @@ void	addChannel(Server *server, std::string const &channelName)
 	server->getChannels().insert(std::pair<std::string, Channel>(channelName, channel));
 	std::cout << RED << "Channel added: " << channelName << RESET << std::endl;
 }
-
-void	addClientToChannel(Server *server, std::string &channelName, Client &client)
-{
-	std::map<std::string, Channel>::iterator it;
-	it = server->getChannels().find(channelName);
-	std::string client_nickname = client.getNickname();
-	if (it->second.doesClientExist(client_nickname) == false)
-	{
-		it->second.getClientList().insert(std::pair<std::string, Client>(client.getNickname(), client));
-		std::cout << "Client successfully joined the channel" << channelName << "!" << std::endl;
-	}
-	else 
-		std::cout << YELLOW << client.getNickname() << "already here\n" << RESET;
-}
@@ -30,7 +30,7 @@ static void			broadcastToChannel(Server *server, Channel &channel, Client &clien
  * @param server
  * @param cmd_infos Structure w/ prefix, command name and message
  */
-void				kick(Server *server, int const client_fd, cmd_struct cmd_infos)
+void				kick(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
 	Client& 	requester		= retrieveClient(server, client_fd);
 	std::string	requester_name	= requester.getNickname();
@@ -60,19 +60,21 @@ void				kick(Server *server, int const client_fd, cmd_struct cmd_infos)
 		// sendServerRpl(client_fd, ERR_NOSUCHCHANNEL(requester_name, channel_name));
 		return ;
 	}
-	else if (it_chan->second.doesClientExist(requester_name) == false)
+	Client	*kicked = server->getClients().findByNickname(kicked_name);
+
+	if (it_chan->second.doesClientExist(client_fd) == false)
 	{
 		addToClientBuffer(server, client_fd, ERR_NOTONCHANNEL(requester_name, channel_name));
 		// sendServerRpl(client_fd, ERR_NOTONCHANNEL(requester_name, channel_name));
 		return ;
 	}
-	else if (it_chan->second.doesClientExist(kicked_name) == false)
+	else if (kicked == NULL || it_chan->second.doesClientExist(kicked->getClientFd()) == false)
 	{
 		addToClientBuffer(server, client_fd, ERR_USERNOTINCHANNEL(requester_name, kicked_name, channel_name));
 		// sendServerRpl(client_fd, ERR_USERNOTINCHANNEL(requester_name, kicked_name, channel_name));
 		return ;
 	}
-	else if (it_chan->second.isOperator(requester_name) == false) // you're not a channel operator
+	else if (it_chan->second.isOperator(client_fd) == false) // you're not a channel operator
 	{
 		addToClientBuffer(server, client_fd, ERR_CHANOPRIVSNEEDED(requester_name, channel_name));
 		// sendServerRpl(client_fd, ERR_CHANOPRIVSNEEDED(requester_name, channel_name));
@@ -80,9 +82,10 @@ void				kick(Server *server, int const client_fd, cmd_struct cmd_infos)
 	}
 	else
 	{
-		it_chan->second.getClientList().erase(kicked_name);
-		it_chan->second.addToKicked(kicked_name);
+		// the kicked member is still listed, so it gets the KICK too
 		broadcastToChannel(server, it_chan->second, requester, kicked_name, reason);
+		server->removeClientFromChannel(channel_name, *kicked);
+		it_chan->second.addToKicked(kicked_name, server->getNow(), KICK_LIFETIME);
 	}
 }
 
@@ -99,12 +102,13 @@ static std::string	getKickedName(std::string msg_to_parse)
 
 static void			broadcastToChannel(Server *server, Channel &channel, Client &client, std::string kicked, std::string reason)
 {
-	std::map<std::string, Client>::iterator member = channel.getClientList().begin();
+	member_list::iterator member = channel.getMembers().begin();
+	shared_buffer							reply = makeSharedBuffer(\
+		RPL_KICK(user_id(client.getNickname(), client.getUsername()), channel.getName(), kicked, reason));
 	
-	while (member != channel.getClientList().end())
+	while (member != channel.getMembers().end())
 	{
-		addToClientBuffer(server, member->second.getClientFd(), \
-			RPL_KICK(user_id(client.getNickname(), client.getUsername()), channel.getName(), kicked, reason));
+		addToClientBuffer(server, member->first, reply);
 		member++;
 	}
 }
\ No newline at end of file
@@ -5,7 +5,6 @@
 
 static std::string	retrieveNickname(std::string msg);
 static std::string	retrieveComment(std::string msg);
-static void			broadcastQuit(Server *server, std::string reply);
 static Client*		clientExists(Server *server, std::string nickname);
 static bool	isIrcOperator(Server *server, std::string nickname);
 
@@ -23,7 +22,7 @@ static bool	isIrcOperator(Server *server, std::string nickname);
  * 
  * 		The <source> of the message should be the operator who performed the command.
  */
-void		kill(Server *server, int const client_fd, cmd_struct cmd_infos)
+void		kill(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
 	Client &client = retrieveClient(server, client_fd);
 	std::string killer = client.getNickname();
@@ -37,7 +36,7 @@ void		kill(Server *server, int const client_fd, cmd_struct cmd_infos)
 		addToClientBuffer(server, client_fd, ERR_NOSUCHNICK(killer, killed));
 	else if (comment.empty())
 		comment = "default";
-	else if (client.getMode().find('o') == std::string::npos && isIrcOperator(server, killer) == false)
+	else if (client.hasMode(UMODE_OPERATOR) == false && isIrcOperator(server, killer) == false)
 		addToClientBuffer(server, client_fd, ERR_NOPRIVILEGES(killer));
 	else
 	{
@@ -48,7 +47,10 @@ void		kill(Server *server, int const client_fd, cmd_struct cmd_infos)
 		/* The user being killed and every user sharing a channel with them receives 
 			a QUIT message representing that they are leaving the network. */
 		std::string quit_reason = ":Killed (" + killer + " (" + comment + "))";
-		broadcastQuit(server, RPL_QUIT(user_id(killed, killed_user->getUsername()), quit_reason));
+		shared_buffer quit_rpl = makeSharedBuffer(RPL_QUIT(user_id(killed, killed_user->getUsername()), quit_reason));
+		addToClientBuffer(server, killed_user->getClientFd(), quit_rpl);
+		addToCoMembersBuffer(server, *killed_user, quit_rpl);
+		server->removeClientFromAllChannels(*killed_user);
 		
 		/* The user being killed then receives the ERROR message */
 		std::string error_reason = ":Closing Link: localhost. Killed (" + killer + " (" + comment + "))";
@@ -59,17 +61,6 @@ void		kill(Server *server, int const client_fd, cmd_struct cmd_infos)
 	}
 }
 
-static void	broadcastQuit(Server *server, std::string reply)
-{
-    std::map<const int, Client>&		client_list = server->getClients();
-	std::map<const int, Client>::iterator it_client;
-	
-	for (it_client = client_list.begin(); it_client != client_list.end(); it_client++)
-	{
-		addToClientBuffer(server, it_client->second.getClientFd(), reply);
-	}
-}
-
 static bool	isIrcOperator(Server *server, std::string nickname)
 {
 	std::vector<server_op> irc_ops = server->getIrcOperators();
@@ -85,17 +76,7 @@ static bool	isIrcOperator(Server *server, std::string nickname)
 
 static Client*	clientExists(Server *server, std::string nickname)
 {
-	std::map<const int, Client>&		client_list = server->getClients();
-	std::map<const int, Client>::iterator it_client;
-	
-	for (it_client = client_list.begin(); it_client != client_list.end(); it_client++)
-	{
-		if (it_client->second.getNickname() == nickname)
-			break;
-	}
-	if (it_client == client_list.end())
-		return (NULL);
-	return (&it_client->second);
+	return (server->getClients().findByNickname(nickname));
 }
 
 static std::string	retrieveNickname(std::string msg)
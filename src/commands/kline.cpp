@@ -0,0 +1,89 @@
+#include "Irc.hpp"
+#include "Server.hpp"
+#include "Commands.hpp"
+
+static void	disconnectKlined(Server *server);
+
+/**
+ * @brief The KLINE command bans an address range from the server. Connections
+ * 		  from it are refused right after accept() (see Server::admitClient),
+ * 		  and the clients already connected from it are disconnected.
+ * 		  GLINE is the same command: with a single server, a global ban and a
+ * 		  local one cover the same connections.
+ *
+ * 	Syntax :
+ * 	KLINE <address>[/<len>] [:<reason>]
+ *
+ * 		<address> is an IPv4 or IPv6 address, without <len> only this
+ * 		address is banned. The ban lasts until UNKLINE or a restart (bans
+ * 		meant to stay go in src/config/ircserv.config).
+ *
+ * 	Numeric replies:
+ * 		ERR_NEEDMOREPARAMS (461)
+ * 		ERR_NOPRIVILEGES (481)
+ */
+void	kline(Server *server, int const client_fd, cmd_struct &cmd_infos)
+{
+	Client		&client		= retrieveClient(server, client_fd);
+	std::string	nickname	= client.getNickname();
+	irc_message	&tokens		= cmd_infos.tokens;
+
+	if (client.hasMode(UMODE_OPERATOR) == false)
+	{
+		addToClientBuffer(server, client_fd, ERR_NOPRIVILEGES(nickname));
+		return ;
+	}
+	std::string	mask	= tokens.params[0].str();
+	std::string	reason	= tokens.param_count > 1 ? tokens.params[1].str() : "";
+
+	if (server->addKline(mask, reason) == FAILURE)
+	{
+		addToClientBuffer(server, client_fd, RPL_SERVERNOTICE(nickname, "Invalid K-line mask " + mask));
+		return ;
+	}
+	addToClientBuffer(server, client_fd, RPL_SERVERNOTICE(nickname, "Added K-line for " + mask));
+	disconnectKlined(server);
+}
+
+/**
+ * @brief The UNKLINE command lifts a ban set by KLINE (or by the settings
+ * 		  file). The mask must be the one of the ban, UNKLINE 10.0.0.1 does
+ * 		  not lift a ban on 10.0.0.0/8.
+ *
+ * 	Syntax :
+ * 	UNKLINE <address>[/<len>]
+ */
+void	unkline(Server *server, int const client_fd, cmd_struct &cmd_infos)
+{
+	Client		&client		= retrieveClient(server, client_fd);
+	std::string	nickname	= client.getNickname();
+	std::string	mask		= cmd_infos.tokens.params[0].str();
+	ip_address	prefix;
+	unsigned	prefix_len;
+
+	if (client.hasMode(UMODE_OPERATOR) == false)
+		addToClientBuffer(server, client_fd, ERR_NOPRIVILEGES(nickname));
+	else if (parseCidr(mask, prefix, prefix_len) == false
+		|| server->getKlines().erase(prefix, prefix_len) == false)
+		addToClientBuffer(server, client_fd, RPL_SERVERNOTICE(nickname, "No K-line for " + mask));
+	else
+		addToClientBuffer(server, client_fd, RPL_SERVERNOTICE(nickname, "Removed K-line for " + mask));
+}
+
+/**
+ * @brief Applies the bans to the clients connected before they were set.
+ */
+static void	disconnectKlined(Server *server)
+{
+	ClientTable	&clients = server->getClients();
+
+	for (ClientTable::iterator it = clients.begin(); it != clients.end(); it++)
+	{
+		Client				&target	= **it;
+		std::string const	*reason	= server->getKlines().find(target.getAddress());
+
+		if (reason == NULL || target.getDeconnexionStatus() == true)
+			continue ;
+		server->quitClient(target, "K-lined: " + *reason);
+	}
+}
@@ -5,6 +5,21 @@
 
 static std::string	findAnyChannel(std::string msg_to_parse);
 static std::string	getRplList(std::string client_nick, std::map<std::string, Channel>::iterator &channel);
+static bool			isCongested(Client &client);
+
+/* "/LIST" of every channel, TASK_SLICE channels per slice, in name order */
+class ListTask : public SlicedTask
+{
+	private:
+		std::string	_last;		// name of the last channel listed
+		bool		_started;
+
+	protected:
+		bool	runSlice(Server &server, Client &client);
+
+	public:
+		explicit ListTask(client_handle client);
+};
 
 /**
  * @brief If the exact name of a channel is given, the only information about 
@@ -18,13 +33,18 @@ static std::string	getRplList(std::string client_nick, std::map<std::string, Cha
  * 		RPL_LISTSTART (321) : marks the start of a channel list. 
  * 		RPL_LIST (322) : sends information about a channel to the client.
  * 		RPL_LISTEND (323) : indicates the end of a LIST response.
+ * 		RPL_TRYAGAIN (263) : the replies already waiting for the client are
+ * 			past its soft sendq limit. The same limit cuts a listing short.
+ * 
+ * 	A listing of every channel runs in slices (see ListTask), so a large
+ * 	network does not hold the other clients up.
  * 
  * 	Examples:
  * 		/LIST
  * 		/LIST -yes => "LIST" when received by server
  * 		/LIST #ubuntu
  */
-void		list(Server *server, int const client_fd, cmd_struct cmd_infos)
+void		list(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
 	std::string channel_to_display	= findAnyChannel(cmd_infos.message);
 	Client&		client 				= retrieveClient(server, client_fd);
@@ -33,43 +53,62 @@ void		list(Server *server, int const client_fd, cmd_struct cmd_infos)
 	std::string	RPL_LIST;
 	std::string	RPL_LISTEND 		= "323 " + client_nick + " :End of /LIST\r\n";
 
-	if (channel_to_display.empty()) // "/LIST" => list all channels
+	if (client.isSendqCongested())
 	{
-		if (server->getChannels().empty()) {
-			send(client_fd, RPL_LISTEND.c_str(), RPL_LISTEND.size(), 0);
-			std::cout << "[Server] Message sent to client " << client_fd << " >> " << CYAN << RPL_LISTEND << RESET << std::endl;
-		} 
-		else 
-		{
-			std::map<std::string, Channel>::iterator it = server->getChannels().begin();
-			while (it != server->getChannels().end())
-			{
-				RPL_LIST.clear();
-				RPL_LIST = getRplList(client_nick, it);
-				send(client_fd, RPL_LIST.c_str(), RPL_LIST.size(), 0);
-				std::cout << "[Server] Message sent to client " << client_fd << " >> " << CYAN << RPL_LIST << RESET << std::endl;
-				it++;
-			}
-		}
+		addToClientBuffer(server, client_fd, RPL_TRYAGAIN(client_nick, cmd_infos.name));
+		return ;
 	}
+	if (channel_to_display.empty()) // "/LIST" => list all channels
+		server->scheduleTask(client, new ListTask(server->getClients().getHandle(client_fd)));
 	else
 	{
-		std::map<std::string, Channel>			 channels = server->getChannels();
+		std::map<std::string, Channel>			 &channels = server->getChannels();
 		std::map<std::string, Channel>::iterator channel = channels.find(channel_to_display);
 		if (channel != channels.end())
 		{	
 			RPL_LIST = getRplList(client_nick, channel);
-			send(client_fd, RPL_LIST.c_str(), RPL_LIST.size(), 0);
+			addToClientBuffer(server, client_fd, RPL_LIST);
 
 		} else {
 			std::cout << "[Server] The channel " << channel_to_display << " does not exist." << std::endl;
-			send(client_fd, RPL_LISTEND.c_str(), RPL_LISTEND.size(), 0);
-			std::cout << "[Server] Message sent to client " << client_fd << " >> " << CYAN << RPL_LISTEND << RESET << std::endl;
+			addToClientBuffer(server, client_fd, RPL_LISTEND);
 		}
 	}
 	return ;
 }
 
+ListTask::ListTask(client_handle client) : SlicedTask(client), _started(false)
+{
+}
+
+/**
+ * @brief Lists the next channels, after the last one listed: those created
+ * 		  or removed in the meantime are simply found or not.
+ */
+bool	ListTask::runSlice(Server &server, Client &client)
+{
+	std::map<std::string, Channel>				&channels = server.getChannels();
+	std::map<std::string, Channel>::iterator	it;
+	std::string									client_nick = client.getNickname();
+
+	it = (_started ? channels.upper_bound(_last) : channels.begin());
+	_started = true;
+	for (size_t i = 0; i < TASK_SLICE && it != channels.end(); i++, it++)
+	{
+		if (isCongested(client))
+		{
+			it = channels.end();
+			break ;
+		}
+		addToClientBuffer(&server, client.getClientFd(), getRplList(client_nick, it));
+		_last = it->first;
+	}
+	if (it != channels.end())
+		return (false);
+	addToClientBuffer(&server, client.getClientFd(), "323 " + client_nick + " :End of /LIST\r\n");
+	return (true);
+}
+
 static std::string	findAnyChannel(std::string msg_to_parse)
 {
 	std::string	channel;
@@ -93,8 +132,18 @@ static std::string	getRplList(std::string client_nick, std::map<std::string, Cha
 	std::stringstream concat;
 		
 	concat << "322 " << client_nick << " " << channel->second.getName() << " "  \
-			<< channel->second.getClientList().size() \
+			<< channel->second.getMembers().size() \
 			<< (channel->second.getTopic().empty() ? " :No topic set for this channel yet."  : channel->second.getTopic()) \
 			<< "\r\n";
 	return (concat.str());			
 }
+
+/**
+ * @brief The shard of the client may be writing its send queue meanwhile.
+ */
+static bool	isCongested(Client &client)
+{
+	std::lock_guard<std::mutex>	guard(client.getSendqLock());
+
+	return (client.isSendqCongested());
+}
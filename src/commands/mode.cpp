@@ -112,13 +112,14 @@ struct mode_struct
 	std::string	params;
 };
 
-static void	broadcastToAllChannelMembers(Server *server, Channel &channel, std::string reply)
+static void	broadcastToAllChannelMembers(Server *server, Channel &channel, std::string mode)
 {
-	std::map<std::string, Client>::iterator member = channel.getClientList().begin();
+	member_list::iterator member = channel.getMembers().begin();
+	shared_buffer							reply = makeSharedBuffer(mode);
 	
-	while (member != channel.getClientList().end())
+	while (member != channel.getMembers().end())
 	{
-		addToClientBuffer(server, member->second.getClientFd(), reply);
+		addToClientBuffer(server, member->first, reply);
 		member++;
 	}
 }
@@ -157,106 +158,63 @@ static void	fillModeInfos(mode_struct &mode_infos, std::string command)
 	mode_infos.params = command.substr(0);
 }
 
-static void	operatorChannelMode(Server *server, mode_struct mode_infos, int const client_fd, std::string str)
+static void	operatorChannelMode(Server *server, mode_struct mode_infos, int const client_fd, bool adding)
 {
-	std::map<const int, Client>::iterator it_client = server->getClients().find(client_fd);
+	Client *client = server->getClients().find(client_fd);
 	std::map<std::string, Channel>::iterator it_channel_target = server->getChannels().find(mode_infos.target);
-	
-	if (mode_infos.params.empty() == true)
-		return ;
 
 	// check that the parameter is an IRC user, then a user of the channel
-	std::map<const int, Client>::iterator it_user_target = server->getClients().begin();
-    while (it_user_target != server->getClients().end())
-    {
-    	if (it_user_target->second.getNickname() == mode_infos.params)
-        	break;
-    	it_user_target++;
-    }
-	if (it_user_target == server->getClients().end())
+	Client *user_target = server->getClients().findByNickname(mode_infos.params);
+
+	if (user_target == NULL)
 	{
-		addToClientBuffer(server, client_fd, ERR_NOSUCHNICK(it_client->second.getNickname(), mode_infos.params));
-		addToClientBuffer(server, client_fd, ERR_USERNOTINCHANNEL(it_client->second.getNickname(), mode_infos.params, mode_infos.target));
+		addToClientBuffer(server, client_fd, ERR_NOSUCHNICK(client->getNickname(), mode_infos.params));
+		addToClientBuffer(server, client_fd, ERR_USERNOTINCHANNEL(client->getNickname(), mode_infos.params, mode_infos.target));
 		return ;
 	}
 
-	if (it_channel_target->second.getClientList().find(mode_infos.params) == it_channel_target->second.getClientList().end())
+	if (it_channel_target->second.doesClientExist(user_target->getClientFd()) == false)
 	{
-		addToClientBuffer(server, client_fd, ERR_USERNOTINCHANNEL(it_client->second.getNickname(), mode_infos.params, mode_infos.target));
+		addToClientBuffer(server, client_fd, ERR_USERNOTINCHANNEL(client->getNickname(), mode_infos.params, mode_infos.target));
 		return ;
 	}
 
-	std::vector<std::string>::iterator it;
-	for (it = it_channel_target->second.getOperators().begin(); it != it_channel_target->second.getOperators().end(); it++)
-	{
-		if (*it == mode_infos.params)
-			break;
-	}
+	bool	is_operator = it_channel_target->second.isOperator(user_target->getClientFd());
 
-	if (str[0] == '+')
+	if (adding)
 	{
-		if (it != it_channel_target->second.getOperators().end())
+		if (is_operator == true)
 			return ;
 
-		it_channel_target->second.getOperators().push_back(mode_infos.params);
+		it_channel_target->second.setOperator(user_target->getClientFd(), true);
 		broadcastToAllChannelMembers(server, it_channel_target->second, MODE_CHANNELMSGWITHPARAM(mode_infos.target, "+o", mode_infos.params));
 	}
 	else
 	{
-		if (it == it_channel_target->second.getOperators().end())
+		if (is_operator == false)
 			return ;
 
-		it_channel_target->second.getOperators().erase(it);
+		it_channel_target->second.setOperator(user_target->getClientFd(), false);
 		broadcastToAllChannelMembers(server, it_channel_target->second, MODE_CHANNELMSGWITHPARAM(mode_infos.target, "-o", mode_infos.params));
 	}
 }
 
-static void	topicChannelMode(Server *server, mode_struct mode_infos, int const client_fd, std::string mode_str)
-{
-	std::cout << "I am in mode t" << std::endl;
-	std::map<const int, Client>::iterator it_client = server->getClients().find(client_fd);
-	(void)it_client;
-	std::map<std::string, Channel>::iterator it_channel_target = server->getChannels().find(mode_infos.target);
-
-	size_t pos = it_channel_target->second.getMode().find("t");
-	if (mode_str[0] == '+')
-	{
-		if (pos != std::string::npos)
-			return;
-		it_channel_target->second.addMode("t");
-		broadcastToAllChannelMembers(server, it_channel_target->second, MODE_CHANNELMSG(mode_infos.target, "+t"));
-	}
-	else
-	{
-		if (pos == std::string::npos)
-			return;
-		it_channel_target->second.removeMode("t");
-		broadcastToAllChannelMembers(server, it_channel_target->second, MODE_CHANNELMSG(mode_infos.target, "-t"));
-	}
-}
-
-static void	secretChannelMode(Server *server, mode_struct mode_infos, int const client_fd, std::string mode_str)
+/**
+ * @brief Sets or clears a mode without parameter (type D) such as +t or +s,
+ * 		  and tells the channel if it changed.
+ */
+static void	flagChannelMode(Server *server, mode_struct mode_infos, mode_spec const &spec, bool adding)
 {
-	std::cout << "I am in mode s" << std::endl;
-	std::map<const int, Client>::iterator it_client = server->getClients().find(client_fd);
-	(void)it_client;
 	std::map<std::string, Channel>::iterator it_channel_target = server->getChannels().find(mode_infos.target);
+	std::string	change = std::string(adding ? "+" : "-") + spec.letter;
 
-	size_t pos = it_channel_target->second.getMode().find("s");
-	if (mode_str[0] == '+')
-	{
-		if (pos != std::string::npos)
-			return;
-		it_channel_target->second.addMode("s");
-		broadcastToAllChannelMembers(server, it_channel_target->second, MODE_CHANNELMSG(mode_infos.target, "+s"));
-	}
+	if (it_channel_target->second.hasMode(spec.bit) == adding)
+		return;
+	if (adding)
+		it_channel_target->second.addMode(spec.bit);
 	else
-	{
-		if (pos == std::string::npos)
-			return;
-		it_channel_target->second.removeMode("s");
-		broadcastToAllChannelMembers(server, it_channel_target->second, MODE_CHANNELMSG(mode_infos.target, "-s"));
-	}
+		it_channel_target->second.removeMode(spec.bit);
+	broadcastToAllChannelMembers(server, it_channel_target->second, MODE_CHANNELMSG(mode_infos.target, change));
 }
 
 static bool isAlpha(std::string str) 
@@ -269,79 +227,131 @@ static bool isAlpha(std::string str)
     return (true);
 }
 
-static void	keyChannelMode(Server *server, mode_struct mode_infos, int const client_fd, std::string mode_str)
+static void	keyChannelMode(Server *server, mode_struct mode_infos, int const client_fd, bool adding)
 {
 	std::cout << "I am in mode k" << std::endl;
-	std::map<const int, Client>::iterator it_client = server->getClients().find(client_fd);
+	Client *client = server->getClients().find(client_fd);
 	std::map<std::string, Channel>::iterator it_channel_target = server->getChannels().find(mode_infos.target);
+	bool	is_set = it_channel_target->second.hasMode(CMODE_KEY);
 
-
-	size_t pos = it_channel_target->second.getMode().find("k");
-	if (mode_infos.params.empty() == true)
-		return ;
-	
-	if (mode_str[0] == '+')
+	if (adding)
 	{
-		if (pos != std::string::npos)
+		if (is_set)
 			return;
 		if (isAlpha(mode_infos.params) == false) 
 		{
-			addToClientBuffer(server, client_fd, ERR_INVALIDMODEPARAM(it_client->second.getNickname(), mode_infos.target, "+k", mode_infos.params));
+			addToClientBuffer(server, client_fd, ERR_INVALIDMODEPARAM(client->getNickname(), mode_infos.target, "+k", mode_infos.params));
 			return ;
 		}
-		it_channel_target->second.addMode("k");
+		it_channel_target->second.addMode(CMODE_KEY);
 		it_channel_target->second.setChannelPassword(mode_infos.params);
 		broadcastToAllChannelMembers(server, it_channel_target->second, MODE_CHANNELMSGWITHPARAM(mode_infos.target, "+k", mode_infos.params));
 	}
 	else
 	{
-		if (pos == std::string::npos)
+		if (is_set == false)
 			return;
-		it_channel_target->second.removeMode("k");
+		it_channel_target->second.removeMode(CMODE_KEY);
 		it_channel_target->second.removeChannelPassword();
 		broadcastToAllChannelMembers(server, it_channel_target->second, MODE_CHANNELMSGWITHPARAM(mode_infos.target, "-k", mode_infos.params));
 	}
 }
 
-static void	changeChannelMode(Server *server, mode_struct mode_infos, int const client_fd)
+/**
+ * @brief +b/-b <mask> adds or removes a ban, a bare +b lists them.
+ */
+static void	banChannelMode(Server *server, mode_struct mode_infos, int const client_fd, bool adding)
 {
-	std::map<const int, Client>::iterator it_client = server->getClients().find(client_fd);
-	std::map<std::string, Channel>::iterator it_channel_target = server->getChannels().find(mode_infos.target);
+	Client *client = server->getClients().find(client_fd);
+	Channel &channel = server->getChannels().find(mode_infos.target)->second;
 
-	(void)it_client;
-	(void)it_channel_target;
+	if (mode_infos.params.empty() == true)
+	{
+		std::vector<std::string> masks = channel.getBanMasks(server->getNow());
+		for (size_t i = 0; i < masks.size(); i++)
+			addToClientBuffer(server, client_fd, RPL_BANLIST(client->getNickname(), mode_infos.target, masks[i]));
+		addToClientBuffer(server, client_fd, RPL_ENDOFBANLIST(client->getNickname(), mode_infos.target));
+		return ;
+	}
+	if (adding && channel.addToBanned(mode_infos.params, server->getNow()) == true)
+		broadcastToAllChannelMembers(server, channel, MODE_CHANNELMSGWITHPARAM(mode_infos.target, "+b", mode_infos.params));
+	else if (adding == false && channel.removeFromBanned(mode_infos.params) == true)
+		broadcastToAllChannelMembers(server, channel, MODE_CHANNELMSGWITHPARAM(mode_infos.target, "-b", mode_infos.params));
+}
 
-	std::vector<std::string> vector_modes;
-	for (int i = 1; mode_infos.mode[i] != '\0'; i++)
+/**
+ * @brief Splits the <mode arguments> into one string per argument. A
+ * 		  trailing argument (":...") is kept whole, without its ':'.
+ */
+static std::vector<std::string>	splitModeParams(std::string const &params)
+{
+	std::vector<std::string>	args;
+	size_t						pos = 0;
+
+	while (pos < params.size())
 	{
-		if (mode_infos.mode[i] == '+' || mode_infos.mode[i] == '-')
+		if (params[pos] == ' ')
+		{
+			pos++;
+			continue ;
+		}
+		if (params[pos] == ':')
 		{
-			vector_modes.push_back(mode_infos.mode.substr(0, i));
-			mode_infos.mode.erase(0, i);
-			i = 0;
+			args.push_back(params.substr(pos + 1));
+			break ;
 		}
+		size_t end = params.find(' ', pos);
+		if (end == std::string::npos)
+			end = params.size();
+		args.push_back(params.substr(pos, end - pos));
+		pos = end;
 	}
-	vector_modes.push_back(mode_infos.mode.substr(0));
-	
-	// apply modes
-	for (std::vector<std::string>::iterator it = vector_modes.begin(); it != vector_modes.end(); it++)
+	return (args);
+}
+
+static void	changeChannelMode(Server *server, mode_struct mode_infos, int const client_fd)
+{
+	std::vector<std::string>	args = splitModeParams(mode_infos.params);
+	size_t						next_arg = 0;
+
+	// each letter applies with the last sign seen before it: "+t-s" sets t, clears s,
+	// and the letters taking an argument consume them in order: "+ok nick key"
+	bool	adding = true;
+	for (size_t i = 0; i < mode_infos.mode.size(); i++)
 	{
-		std::string str = *it;
-		if (str.find("o") != std::string::npos)
-			operatorChannelMode(server, mode_infos, client_fd, str);
-		if (str.find("t") != std::string::npos)
-			topicChannelMode(server, mode_infos, client_fd, str);
-		if (str.find("s") != std::string::npos)
-			secretChannelMode(server, mode_infos, client_fd, str);
-		if (str.find("k") != std::string::npos)
-			keyChannelMode(server, mode_infos, client_fd, str);
+		char c = mode_infos.mode[i];
+		if (c == '+' || c == '-')
+		{
+			adding = (c == '+');
+			continue ;
+		}
+
+		const mode_spec *spec = findChannelMode(c);
+		if (spec == NULL)
+			continue ;
+
+		mode_struct	letter_infos = mode_infos;
+		letter_infos.params.clear();
+		if (modeTakesParam(*spec, adding) && next_arg < args.size())
+			letter_infos.params = args[next_arg++];
+
+		if (spec->type == MODE_TYPE_A) // list mode, listed when given no parameter
+			banChannelMode(server, letter_infos, client_fd, adding);
+		else if (modeTakesParam(*spec, adding) && letter_infos.params.empty())
+			continue ;
+		else if (spec->letter == 'o')
+			operatorChannelMode(server, letter_infos, client_fd, adding);
+		else if (spec->letter == 'k')
+			keyChannelMode(server, letter_infos, client_fd, adding);
+		else
+			flagChannelMode(server, letter_infos, *spec, adding);
 	}
 }
 
 static void	modeForChannel(Server *server, mode_struct mode_infos, int const client_fd)
 {
 	// syntax command : /mode <channel> <+ ou -> <mode> [parametres]
-	std::map<const int, Client>::iterator it_client = server->getClients().find(client_fd);
+	Client *client = server->getClients().find(client_fd);
 
 	mode_infos.target.erase(0,1); // erase '#'
 	std::cout << "CHANNEL - target : |" << mode_infos.target << "|" << std::endl;
@@ -349,30 +359,24 @@ static void	modeForChannel(Server *server, mode_struct mode_infos, int const cli
 	std::map<std::string, Channel>::iterator it_channel_target = server->getChannels().find(mode_infos.target);
 	if (it_channel_target == server->getChannels().end())
 	{
-		addToClientBuffer(server, client_fd, ERR_NOSUCHCHANNEL(it_client->second.getNickname(), mode_infos.target));
+		addToClientBuffer(server, client_fd, ERR_NOSUCHCHANNEL(client->getNickname(), mode_infos.target));
 		return ;
 	}
 
 	// If <mode> is not given
 	if (mode_infos.mode.empty() == true)
 	{
-		if (it_channel_target->second.getClientList().find(it_client->second.getNickname()) != it_channel_target->second.getClientList().end() \
+		if (it_channel_target->second.doesClientExist(client_fd) == true \
 		&& it_channel_target->second.getChannelPassword().empty() == false) 
-			addToClientBuffer(server, client_fd, RPL_CHANNELMODEISWITHKEY(it_client->second.getNickname(), mode_infos.target, it_channel_target->second.getMode(), it_channel_target->second.getChannelPassword()));
+			addToClientBuffer(server, client_fd, RPL_CHANNELMODEISWITHKEY(client->getNickname(), mode_infos.target, it_channel_target->second.getModeString(), it_channel_target->second.getChannelPassword()));
 		else
-			addToClientBuffer(server, client_fd, RPL_CHANNELMODEIS(it_client->second.getNickname(), mode_infos.target, it_channel_target->second.getMode()));
+			addToClientBuffer(server, client_fd, RPL_CHANNELMODEIS(client->getNickname(), mode_infos.target, it_channel_target->second.getModeString()));
 		return ;
 	}
 
-	std::vector<std::string>::iterator it;
-	for (it = it_channel_target->second.getOperators().begin(); it != it_channel_target->second.getOperators().end(); it++)
-	{
-		if (*it == it_client->second.getNickname())
-			break;
-	}
-	if (it == it_channel_target->second.getOperators().end())
+	if (it_channel_target->second.isOperator(client_fd) == false)
 	{
-		addToClientBuffer(server, client_fd, ERR_CHANOPRIVSNEEDED(it_client->second.getNickname(), mode_infos.target));
+		addToClientBuffer(server, client_fd, ERR_CHANOPRIVSNEEDED(client->getNickname(), mode_infos.target));
 		return ;
 	}
 	if (mode_infos.mode[0] == '+' || mode_infos.mode[0] == '-')
@@ -381,30 +385,25 @@ static void	modeForChannel(Server *server, mode_struct mode_infos, int const cli
 
 static void	modeForUser(Server *server, mode_struct mode_infos, int const client_fd)
 {
-	std::map<const int, Client>::iterator it_client = server->getClients().find(client_fd);
-
-	std::map<const int, Client>::iterator it_user_target = server->getClients().begin();
-    while (it_user_target != server->getClients().end())
-    {
-    	if (it_user_target->second.getNickname() == mode_infos.target)
-        	break;
-    	it_user_target++;
-    }
-	if (it_user_target == server->getClients().end())
+	Client *client = server->getClients().find(client_fd);
+
+	Client *user_target = server->getClients().findByNickname(mode_infos.target);
+
+	if (user_target == NULL)
 	{
-		addToClientBuffer(server, client_fd, ERR_NOSUCHNICK(it_client->second.getNickname(), mode_infos.target));
+		addToClientBuffer(server, client_fd, ERR_NOSUCHNICK(client->getNickname(), mode_infos.target));
 		return ;
 	}
 	//  If <target> is a different nick than the user who sent the command
-	if (it_user_target->second.getNickname() != it_client->second.getNickname())
+	if (user_target != client)
 	{
-		addToClientBuffer(server, client_fd, ERR_USERSDONTMATCH(it_client->second.getNickname()));
+		addToClientBuffer(server, client_fd, ERR_USERSDONTMATCH(client->getNickname()));
 		return ;
 	}
 
 	// If <mode> is not given
 	if (mode_infos.mode.empty() == true)
-		addToClientBuffer(server, client_fd, RPL_UMODEIS(it_client->second.getNickname(), it_client->second.getMode()));
+		addToClientBuffer(server, client_fd, RPL_UMODEIS(client->getNickname(), client->getModeString()));
 
 	if (mode_infos.mode[0] == '+' || mode_infos.mode[0] == '-')
 	{
@@ -418,10 +417,10 @@ static void	modeForUser(Server *server, mode_struct mode_infos, int const client
 				{
 					if (*pos == 'i')
 					{
-						if (it_user_target->second.getMode().find("i") == std::string::npos)
+						if (user_target->hasMode(UMODE_INVISIBLE) == false)
 						{
-							it_user_target->second.addMode("i");
-							addToClientBuffer(server, client_fd, MODE_USERMSG(it_client->second.getNickname(), "+i"));
+							user_target->addMode(UMODE_INVISIBLE);
+							addToClientBuffer(server, client_fd, MODE_USERMSG(client->getNickname(), "+i"));
 						}
 					}
 					pos++;
@@ -434,18 +433,18 @@ static void	modeForUser(Server *server, mode_struct mode_infos, int const client
 				{
 					if (*pos == 'i')
 					{
-						if (it_user_target->second.getMode().find("i") != std::string::npos)
+						if (user_target->hasMode(UMODE_INVISIBLE) == true)
 						{
-							it_user_target->second.removeMode("i");
-							addToClientBuffer(server, client_fd, MODE_USERMSG(it_client->second.getNickname(), "-i"));
+							user_target->removeMode(UMODE_INVISIBLE);
+							addToClientBuffer(server, client_fd, MODE_USERMSG(client->getNickname(), "-i"));
 						}
 					}
 					if (*pos == 'o')
 					{
-						if (it_user_target->second.getMode().find("o") != std::string::npos)
+						if (user_target->hasMode(UMODE_OPERATOR) == true)
 						{
-							it_user_target->second.removeMode("o");
-							addToClientBuffer(server, client_fd, MODE_USERMSG(it_client->second.getNickname(), "-o"));
+							user_target->removeMode(UMODE_OPERATOR);
+							addToClientBuffer(server, client_fd, MODE_USERMSG(client->getNickname(), "-o"));
 						}
 					}
 					pos++;
@@ -453,11 +452,11 @@ static void	modeForUser(Server *server, mode_struct mode_infos, int const client
 			}
 		}
 		if (mode_infos.mode.find("O") != std::string::npos || mode_infos.mode.find("r") != std::string::npos || mode_infos.mode.find("w") != std::string::npos)
-			addToClientBuffer(server, client_fd, ERR_UMODEUNKNOWNFLAG(it_client->second.getNickname()));
+			addToClientBuffer(server, client_fd, ERR_UMODEUNKNOWNFLAG(client->getNickname()));
 	}
 }
 
-void	modeFunction(Server *server, int const client_fd, cmd_struct cmd_infos)
+void	modeFunction(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
 	mode_struct	mode_infos;
 	
@@ -5,61 +5,142 @@
 
 static bool			containsAtLeastOneAlphaChar(std::string str);
 static std::string	getaChannelName(std::string msg_to_parse);
+
+/* Replies for the channels of a NAMES, about TASK_SLICE members per slice */
+class NamesTask : public SlicedTask
+{
+	private:
+		std::vector<std::string>	_channels;
+		size_t						_next;		// first channel not replied for
+		bool						_all;		// no channel was given: one RPL_ENDOFNAMES at the end
+		std::string					_last;		// with _all, name of the last channel walked
+		bool						_started;
+
+		size_t	replyFor(Server &server, Client &client, std::string const &channel_to_name);
+		bool	runSliceOfAll(Server &server, Client &client);
+
+	protected:
+		bool	runSlice(Server &server, Client &client);
+
+	public:
+		NamesTask(client_handle client, std::vector<std::string> const &channels, bool all);
+};
+
 /**
  * @brief The NAMES command is used to view the nicknames joined to a channel.
  *  If the channel name is invalid or the channel does not exist, one RPL_ENDOFNAMES 
  * 	numeric containing the given channel name should be returned.
  * 
- * 	Syntax: NAMES <channel>{,<channel>}
+ * 	Syntax: NAMES [<channel>{,<channel>}]
+ * 	
+ * 	Without a channel, every channel visible to the client is listed, and
+ * 	a single RPL_ENDOFNAMES for "*" ends the list (RFC 2812 3.2.5). The
+ * 	channel map is walked in name order from one slice to the next, like
+ * 	LIST does, instead of being copied upfront.
  * 	
  * 	Numeric Replies:
  * 	
  * 	RPL_NAMREPLY (353)
  * 	RPL_ENDOFNAMES (366)
  * 
+ * 	The channels are replied for in slices (see NamesTask), so a long list
+ * 	of large channels does not hold the other clients up.
+ * 
  * 	Examples:
  * 	[CLIENT] /NAMES #test,#42
  * 	[SERVER] <client> <symbol> #test :<nick1> <nick2>
  * 	
  */
-void	names(Server *server, int const client_fd, cmd_struct cmd_infos)
+void	names(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
-	Client			client				= retrieveClient(server, client_fd);
-	std::string		symbol				= "=";
-	std::string		channel_to_name;
-	std::string		list_of_members;
+	Client&						client				= retrieveClient(server, client_fd);
+	std::vector<std::string>	channels;
+	std::string					channel_to_name;
+	bool						all					= (containsAtLeastOneAlphaChar(cmd_infos.message) == false);
 
 	while (containsAtLeastOneAlphaChar(cmd_infos.message) == true)
 	{
 		// find the channel to display names of
-		channel_to_name.clear();
 		channel_to_name = getaChannelName(cmd_infos.message);
 		cmd_infos.message.erase(cmd_infos.message.find(channel_to_name), channel_to_name.length()); 
+		channels.push_back(channel_to_name);
+	}
+	server->scheduleTask(client, new NamesTask(server->getClients().getHandle(client_fd), channels, all));
+}
+
+NamesTask::NamesTask(client_handle client, std::vector<std::string> const &channels, bool all)
+: SlicedTask(client), _channels(channels), _next(0), _all(all), _started(false)
+{
+}
+
+/**
+ * @brief Replies for one channel, if it exists and the client may see it.
+ *
+ * @return How much was walked: the channel itself plus its members
+ */
+size_t	NamesTask::replyFor(Server &server, Client &client, std::string const &channel_to_name)
+{
+	std::map<std::string, Channel>&				channels	= server.getChannels();
+	std::map<std::string, Channel>::iterator	channel		= channels.find(channel_to_name);
+	int const									client_fd	= client.getClientFd();
+	std::string									symbol;
+	std::string									list_of_members;
 
-		// Error handling (Inexistent channel, Secret Mode on...)
-		std::map<std::string, Channel>				channels = server->getChannels();
-		std::map<std::string, Channel>::iterator	channel = channels.find(channel_to_name);
-		if (channel == channels.end()\
-			|| (channel->second.doesClientExist(client.getNickname()) == false \
-			&& channel->second.getMode().find('s') != std::string::npos))
-		{
-			addToClientBuffer(server, client_fd, RPL_ENDOFNAMES(client.getNickname(), channel_to_name));
-			continue ;
-		}
-			
-		// find the symbol of said channel (public, secret, or private)
-		symbol.clear();
-		symbol = getSymbol(channel->second);
-
-		// get as a string the list of all members (by nickname)
-		list_of_members.clear();
-		list_of_members = getListOfMembers(client.getNickname(), channel->second);
-
-		if (list_of_members.empty() == false)
-			addToClientBuffer(server, client_fd, RPL_NAMREPLY(client.getNickname(), symbol, channel_to_name, list_of_members));
-		addToClientBuffer(server, client_fd, RPL_ENDOFNAMES(client.getNickname(), channel_to_name));
+	// Error handling (Inexistent channel, Secret Mode on...)
+	if (channel == channels.end()\
+		|| (channel->second.doesClientExist(client_fd) == false \
+		&& channel->second.hasMode(CMODE_SECRET)))
+	{
+		if (_all == false)
+			addToClientBuffer(&server, client_fd, RPL_ENDOFNAMES(client.getNickname(), channel_to_name));
+		return (1); // the channels left out count too
+	}
+
+	// find the symbol of said channel (public, secret, or private)
+	symbol = getSymbol(channel->second);
+
+	// get as a string the list of all members (by nickname)
+	list_of_members = getListOfMembers(&server, client, channel->second);
+
+	if (list_of_members.empty() == false)
+		addToClientBuffer(&server, client_fd, RPL_NAMREPLY(client.getNickname(), symbol, channel_to_name, list_of_members));
+	if (_all == false)
+		addToClientBuffer(&server, client_fd, RPL_ENDOFNAMES(client.getNickname(), channel_to_name));
+	return (1 + channel->second.getMembers().size());
+}
+
+bool	NamesTask::runSlice(Server &server, Client &client)
+{
+	size_t	walked = 0;
+
+	if (_all)
+		return (runSliceOfAll(server, client));
+	for (; _next < _channels.size() && walked < TASK_SLICE; _next++)
+		walked += replyFor(server, client, _channels[_next]);
+	return (_next >= _channels.size());
+}
+
+/**
+ * @brief Walks the next channels, after the last one walked: those created
+ * 		  or removed in the meantime are simply found or not.
+ */
+bool	NamesTask::runSliceOfAll(Server &server, Client &client)
+{
+	std::map<std::string, Channel>&				channels	= server.getChannels();
+	std::map<std::string, Channel>::iterator	it;
+	size_t										walked		= 0;
+
+	it = (_started ? channels.upper_bound(_last) : channels.begin());
+	_started = true;
+	for (; it != channels.end() && walked < TASK_SLICE; it++)
+	{
+		_last = it->first;
+		walked += replyFor(server, client, _last);
 	}
-	
+	if (it != channels.end())
+		return (false);
+	addToClientBuffer(&server, client.getClientFd(), RPL_ENDOFALLNAMES(client.getNickname()));
+	return (true);
 }
 
 static bool		containsAtLeastOneAlphaChar(std::string str)
@@ -37,34 +37,44 @@ static bool	containsInvalidCharacters(std::string nickname);
  * 	[CLIENT] /Nick mike
  * 
  */
-void	nick(Server *server, int const client_fd, cmd_struct cmd_infos)
+void	nick(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
 	std::string nickname	= retrieveNickname(cmd_infos.message);
 	Client&		client		= retrieveClient(server, client_fd);
 
-	if (client.isRegistrationDone() == false)
-	{
-		client.setNickname(nickname);
-		client.setOldNickname(nickname);
-	}
-
 	if (nickname.empty()) {
 		addToClientBuffer(server, client_fd, ERR_NONICKNAMEGIVEN(client.getNickname()));
 	} 
 	else if (containsInvalidCharacters(nickname)) {
 		addToClientBuffer(server, client_fd,  ERR_ERRONEUSNICKNAME(client.getNickname(), nickname));
 	} 
-	else if (isAlreadyUsed(server, client_fd, nickname) == true) {
+	else {
+		std::string	old_nickname = client.getNickname();
+
+		// claims the nickname in the server index, or fails if someone holds it
+		if (server->getClients().setNickname(&client, nickname) == false)
+		{
 			addToClientBuffer(server, client_fd, ERR_NICKNAMEINUSE(client.getNickname(), nickname));
-	} else {
-		
-		if (client.isRegistrationDone() == true)
+			return ;
+		}
+		if (client.isRegistrationDone() == false)
+			client.setOldNickname(nickname);
+		else
 		{
-			client.setOldNickname(client.getNickname());
+			client.setOldNickname(old_nickname);
 			std::cout << "[Server] Nickname change registered. Old nickname is now : " << client.getOldNickname() << std::endl;
-		
-			client.setNickname(nickname);
-			addToClientBuffer(server, client_fd, RPL_NICK(client.getOldNickname(), client.getUsername(), client.getNickname()));
+			shared_buffer nick_rpl = makeSharedBuffer(RPL_NICK(client.getOldNickname(), client.getUsername(), client.getNickname()));
+			addToClientBuffer(server, client_fd, nick_rpl);
+			addToCoMembersBuffer(server, client, nick_rpl);
+
+			// the bans that matched the old nickname may not match the new one
+			std::set<std::string> &joined = client.getJoinedChannels();
+			for (std::set<std::string>::iterator it = joined.begin(); it != joined.end(); it++)
+			{
+				std::map<std::string, Channel>::iterator chan = server->getChannels().find(*it);
+				if (chan != server->getChannels().end())
+					chan->second.forgetBanCheck(client_fd);
+			}
 		}
 	}
 }
@@ -108,18 +118,3 @@ static bool	containsInvalidCharacters(std::string nickname)
 	}
 	return (false);			
 }
-
-bool	isAlreadyUsed(Server *server, int client_fd, std::string new_nickname)
-{
-	std::map<const int, Client>&			client_list	= server->getClients();
-	std::map<const int, Client>::iterator	client		= client_list.begin();
-
-	while (client != client_list.end())
-	{
-		if (client->second.getClientFd() != client_fd \
-			&& client->second.getNickname() == new_nickname)
-			return (true);
-		client++;
-	}
-	return (false);
-}
\ No newline at end of file
@@ -19,37 +19,41 @@
  * 
  */
 
-static void  broadcastToChannel(Server *server, int const client_fd, std::map<const int, Client>::iterator it_client, std::map<std::string, Channel>::iterator it_channel, std::string message)
+static void  broadcastToChannel(Server *server, int const client_fd, Client *client, std::map<std::string, Channel>::iterator it_channel, std::string message)
 {
    // TODO: Check based on channel modes
    // - Check if the user is a member of the channel -> If yes: loop through and send to every user in the channel
    // - If not: check if the channel mode allows sending messages
 
-   std::map<std::string, Client>::iterator member = it_channel->second.getClientList().begin(); // Start of the channel's client list
-   while (member != it_channel->second.getClientList().end())
+   if (it_channel->second.isBanned(*client, server->getNow()) == true) // no error reply to a NOTICE
+      return ;
+
+   shared_buffer reply = makeSharedBuffer(RPL_PRIVMSG(client->getNickname(), client->getUsername(), message));
+   member_list::iterator member = it_channel->second.getMembers().begin(); // Start of the channel's client list
+   while (member != it_channel->second.getMembers().end())
    {
-      if (member->second.getClientFd() != client_fd)   // Prevent sending the message back to the sender
-         addToClientBuffer(server, member->second.getClientFd(), RPL_PRIVMSG(it_client->second.getNickname(), it_client->second.getUsername(), message));    
+      if (member->first != client_fd)   // Prevent sending the message back to the sender
+         addToClientBuffer(server, member->first, reply);
       member++;
    }
 }
 
-void	notice(Server *server, int const client_fd, cmd_struct cmd_infos)
+void	notice(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {  
-   std::map<const int, Client>	client_list = server->getClients();
-   std::map<std::string, Channel> channel_list = server->getChannels(); 
-   std::map<const int, Client>::iterator it_client = client_list.find(client_fd); // Find the client who is sending the message
+   ClientTable&	client_list = server->getClients();
+   std::map<std::string, Channel>& channel_list = server->getChannels(); 
+   Client *client = client_list.find(client_fd); // Find the client who is sending the message
 
-   // Parsing message 
-   size_t      delimiter = cmd_infos.message.rfind(":");
-   std::string target = cmd_infos.message.substr(1, (delimiter - 2)); // Ends before the space before the delimiter ':'
-   std::string msg_to_send = cmd_infos.message.substr(delimiter);
+   // Parameters already split by the tokenizer: <target> <text>
+   irc_message &tokens = cmd_infos.tokens;
 
    // Error handling for message syntax
-   if (target.empty())        // No recipient specified
+   if (tokens.param_count < 1 || tokens.params[0].empty())        // No recipient specified
       return ;
-   if (msg_to_send.empty())   // No message provided
+   if (tokens.param_count < 2 || tokens.params[1].empty())        // No message provided
       return ;
+   std::string target = tokens.params[0].str();
+   cmd_infos.message = " " + target + " :" + tokens.params[1].str(); // "<target> :<text>" relayed as is
 
    // Channel case
    if (target[0] == '#')
@@ -58,21 +62,16 @@ void	notice(Server *server, int const client_fd, cmd_struct cmd_infos)
       if (it_channel == channel_list.end())
          return ;
       else
-         broadcastToChannel(server, client_fd, it_client, it_channel, cmd_infos.message);
+         broadcastToChannel(server, client_fd, client, it_channel, cmd_infos.message);
    }
    // User case
    else
    {     
-      std::map<const int, Client>::iterator it_target = client_list.begin();
-      while (it_target != client_list.end())
-      {
-         if (it_target->second.getNickname() == target)
-             break;
-         it_target++;
-      }
-      if (it_target == client_list.end())
+      Client *target_client = client_list.findByNickname(target);
+
+      if (target_client == NULL)
          return ;
       else
-         addToClientBuffer(server, it_target->first, RPL_PRIVMSG(it_client->second.getNickname(), it_client->second.getUsername(), cmd_infos.message)); 
+         addToClientBuffer(server, target_client->getClientFd(), RPL_PRIVMSG(client->getNickname(), client->getUsername(), cmd_infos.message)); 
    }
 }
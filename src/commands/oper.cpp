@@ -27,7 +27,7 @@ static bool			isPasswordValid(Server *server, std::string password, std::string
  *  [CLIENT] OPER foo bar
  *  [SERVER] ; Attempt to register as an operator using a name of "foo" and the password "bar".
  */
-void oper(Server *server, int const client_fd, cmd_struct cmd_infos)
+void oper(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
 	Client&		client		= retrieveClient(server, client_fd);
 	std::string name		= getName(cmd_infos.message);
@@ -48,7 +48,7 @@ void oper(Server *server, int const client_fd, cmd_struct cmd_infos)
 	else
 	{
 		addToClientBuffer(server, client_fd, RPL_YOUREOPER(client.getNickname()));
-		client.addMode("o");
+		client.addMode(UMODE_OPERATOR);
 		addToClientBuffer(server, client_fd, MODE_USERMSG(client.getNickname(), "+o"));
 	}
 }
@@ -25,14 +25,15 @@ static void			broadcastToAllChannelMembers(Server *server, Channel &channel, std
  * 	[SERVER] leaves both channels #test and #hey with the reason "Dining"
  * 	[SERVER to CLIENT]"@user_id PART #channel Dining" (for EACH channel they leave)
  */
-void				part(Server *server, int const client_fd, cmd_struct cmd_infos)
+void				part(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
-	Client		client		= retrieveClient(server, client_fd);
+	Client&		client		= retrieveClient(server, client_fd);
 	std::string nick		= client.getNickname();
 	std::string	channel;
 
 	std::string reason = getReason(cmd_infos.message);
-	cmd_infos.message.erase(cmd_infos.message.find(reason), reason.length()); // #chan reason" becomes "#chan "
+	if (cmd_infos.message.find(":") != cmd_infos.message.npos)
+		cmd_infos.message.erase(cmd_infos.message.find(":")); // "#chan :reason" becomes "#chan "
 
 	while (containsAtLeastOneAlphaChar(cmd_infos.message) == true)
 	{
@@ -48,14 +49,14 @@ void				part(Server *server, int const client_fd, cmd_struct cmd_infos)
 			continue ;
 		}
 		else if (it != channels.end() \
-				&& it->second.doesClientExist(nick) == false) // b) if chan exists and client not in it
+				&& it->second.doesClientExist(client_fd) == false) // b) if chan exists and client not in it
 		{
 			addToClientBuffer(server, client_fd, ERR_NOTONCHANNEL(nick, channel));
 			continue ;
 		}
 		else // c) if successful command
 		{
-			it->second.getClientList().erase(nick);
+			server->removeClientFromChannel(channel, client);
 			addToClientBuffer(server, client_fd, RPL_PART(user_id(nick, client.getUsername()), channel, reason));
 			broadcastToAllChannelMembers(server, it->second, client.getUsername(), nick, reason);
 		}
@@ -85,11 +86,12 @@ static bool			containsAtLeastOneAlphaChar(std::string str)
 
 static void			broadcastToAllChannelMembers(Server *server, Channel &channel, std::string user, std::string nick, std::string reason)
 {
-	std::map<std::string, Client>::iterator member = channel.getClientList().begin();
+	member_list::iterator member = channel.getMembers().begin();
+	shared_buffer							reply = makeSharedBuffer(RPL_PART(user_id(nick, user), channel.getName(), reason));
 	
-	while (member != channel.getClientList().end())
+	while (member != channel.getMembers().end())
 	{
-		addToClientBuffer(server, member->second.getClientFd(), RPL_PART(user_id(nick, user), channel.getName(), reason));
+		addToClientBuffer(server, member->first, reply);
 		member++;
 	}
 }
\ No newline at end of file
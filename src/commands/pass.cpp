@@ -20,21 +20,20 @@ std::string	retrievePassword(std::string msg_to_parse);
  * Example :
  *  [CLIENT] /PASS secretpassword
  */
-int		pass(Server *server, int const client_fd, cmd_struct cmd_infos)
+void	pass(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
-	Client		client		= retrieveClient(server, client_fd);
+	Client&		client		= retrieveClient(server, client_fd);
 	std::string	password	= retrievePassword(cmd_infos.message);
 
 	if (server->getPassword() == password)
 	{
-		return (SUCCESS);
+		client.setConnexionPassword(true);
 	}
 	else
 	{
-		sendServerRpl(client_fd, ERR_PASSWDMISMATCH(client.getNickname()));
-		return (FAILURE);
+		client.setConnexionPassword(false);
+		addToClientBuffer(server, client_fd, ERR_PASSWDMISMATCH(client.getNickname()));
 	}
-		
 }
 
 std::string	retrievePassword(std::string msg_to_parse)
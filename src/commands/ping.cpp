@@ -19,18 +19,29 @@
  *        to a nickname or a channel. Using the character '*' pings every user in a channel.
  *        Syntax: PING [<nick> | <channel> | *]
  * 
- * @return SUCCESS (0) or FAILURE (1) 
  */
-int	ping(Server *server, int const client_fd, cmd_struct &cmd)
+void	ping(Server *server, int const client_fd, cmd_struct &cmd)
 {
 	Client		&client		= retrieveClient(server, client_fd);
 	std::string	nickname	= client.getNickname();
 	std::string	username	= client.getUsername();
 
-	if (cmd.message[0] == ' ')
-		cmd.message.erase(0, 1);
-	cmd.message.insert(0, ":");
-	addToClientBuffer(server, client_fd, RPL_PONG(user_id(nickname, username), cmd.message));
+	if (cmd.tokens.param_count == 0)
+	{
+		addToClientBuffer(server, client_fd, ERR_NEEDMOREPARAMS(nickname, cmd.name));
+		return ;
+	}
+	addToClientBuffer(server, client_fd, RPL_PONG(user_id(nickname, username), ":" + cmd.tokens.params[0].str()));
+}
 
-	return (SUCCESS);
+/**
+ * @brief The PONG command answers the PINGs the server sends to idle clients
+ *        (see Server::runTimer). Receiving it is what matters: any line
+ *        updates the last activity of the client, so there is nothing to do.
+ */
+void	pong(Server *server, int const client_fd, cmd_struct &cmd)
+{
+	(void)server;
+	(void)client_fd;
+	(void)cmd;
 }
\ No newline at end of file
@@ -67,48 +67,52 @@
  
  */
 
-static void  broadcastToChannel(Server *server, int const client_fd, std::map<const int, Client>::iterator it_client, std::map<std::string, Channel>::iterator it_channel, std::string message)
+static void  broadcastToChannel(Server *server, int const client_fd, Client *client, std::map<std::string, Channel>::iterator it_channel, std::string message)
 {
-   std::vector<std::string> kicked_users = it_channel->second.getKickedUsers();
-
-	for (std::vector<std::string>::iterator it = kicked_users.begin(); it != kicked_users.end(); it++)
+	if (it_channel->second.isKicked(client->getNickname(), server->getNow()) == true)
+	{
+		std::cout << client->getNickname() << " is kicked from the channel and can't send message anymore" << std::endl;
+		return ;
+	}
+	if (it_channel->second.isBanned(*client, server->getNow()) == true)
 	{
-		if (*it == it_client->second.getNickname())
-		{
-			std::cout << it_client->second.getNickname() << " is kicked from the channel and can't send message anymore" << std::endl;
-			return ;
-		}
+		addToClientBuffer(server, client_fd, ERR_CANNOTSENDTOCHAN(client->getNickname(), it_channel->second.getName()));
+		return ;
 	}
 
-   std::map<std::string, Client>::iterator member = it_channel->second.getClientList().begin();
-   while (member != it_channel->second.getClientList().end())
+   // serialized once, every member's send queue references the same buffer
+   shared_buffer reply = makeSharedBuffer(RPL_PRIVMSG(client->getNickname(), client->getUsername(), message));
+   member_list::iterator member = it_channel->second.getMembers().begin();
+   while (member != it_channel->second.getMembers().end())
    {
-      if (member->second.getClientFd() != client_fd)   // prevent to send the message to the sender
-         addToClientBuffer(server, member->second.getClientFd(), RPL_PRIVMSG(it_client->second.getNickname(), it_client->second.getUsername(), message));
+      if (member->first != client_fd)   // prevent to send the message to the sender
+         addToClientBuffer(server, member->first, reply);
       member++;
    }
 }
 
-void	privmsg(Server *server, int const client_fd, cmd_struct cmd_infos)
+void	privmsg(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {  
-   std::map<const int, Client>	client_list = server->getClients();
-   std::map<std::string, Channel> channel_list = server->getChannels(); 
-   std::map<const int, Client>::iterator it_client = client_list.find(client_fd);
+   ClientTable&	client_list = server->getClients();
+   std::map<std::string, Channel>& channel_list = server->getChannels(); 
+   Client *client = client_list.find(client_fd);
 
-   // Parsing message 
-   size_t      delimiter = cmd_infos.message.find(":");
-   if (delimiter == std::string::npos)
-   {
-      delimiter = cmd_infos.message.find_last_of(" ");
-   }
-   std::string target = cmd_infos.message.substr(1, (delimiter - 2)); // end before the space there is before the delimiter ':'
-   std::string msg_to_send = cmd_infos.message.substr(delimiter);
+   // Parameters already split by the tokenizer: <target> <text>
+   irc_message &tokens = cmd_infos.tokens;
 
    // Error syntaxe message
-   if (target.empty())
-      addToClientBuffer(server, client_fd, ERR_NORECIPIENT(it_client->second.getNickname()));
-   if (msg_to_send.empty())
-      addToClientBuffer(server, client_fd, ERR_NOTEXTTOSEND(it_client->second.getNickname()));
+   if (tokens.param_count < 1 || tokens.params[0].empty())
+   {
+      addToClientBuffer(server, client_fd, ERR_NORECIPIENT(client->getNickname()));
+      return ;
+   }
+   if (tokens.param_count < 2 || tokens.params[1].empty())
+   {
+      addToClientBuffer(server, client_fd, ERR_NOTEXTTOSEND(client->getNickname()));
+      return ;
+   }
+   std::string target = tokens.params[0].str();
+   cmd_infos.message = " " + target + " :" + tokens.params[1].str(); // "<target> :<text>" relayed as is
 
    // Channel case
    if (target[0] == '#')
@@ -116,36 +120,30 @@ void	privmsg(Server *server, int const client_fd, cmd_struct cmd_infos)
       std::map<std::string, Channel>::iterator it_channel = channel_list.find(target.substr(1)); // find channel name by skipping the '#' character
 
       if (it_channel == channel_list.end())
-         addToClientBuffer(server, client_fd, ERR_NOSUCHNICK(it_client->second.getNickname(), target));
+         addToClientBuffer(server, client_fd, ERR_NOSUCHNICK(client->getNickname(), target));
       else
-         broadcastToChannel(server, client_fd, it_client, it_channel, cmd_infos.message);
+         broadcastToChannel(server, client_fd, client, it_channel, cmd_infos.message);
    }
    // user case
    else
    {
       std::map<std::string, Channel>::iterator it_channel = channel_list.find(target); // find channel name
      
-      std::map<const int, Client>::iterator it_target = client_list.begin();
-      while (it_target!=client_list.end())
-      {
-         if (it_target->second.getNickname() == target)
-             break;
-         it_target++;
-      }
-      if (it_target == client_list.end() && it_channel == channel_list.end()) // user and channel doesn't exist
+      Client *target_client = client_list.findByNickname(target);
+
+      if (target_client == NULL && it_channel == channel_list.end()) // user and channel doesn't exist
       {
-         addToClientBuffer(server, client_fd, ERR_NOSUCHNICK(it_client->second.getNickname(), target));
-         sendServerRpl(client_fd, ERR_NOSUCHNICK(it_client->second.getNickname(), target));
+         addToClientBuffer(server, client_fd, ERR_NOSUCHNICK(client->getNickname(), target));
       }      
       else
       {
-         if (it_target == client_list.end())
+         if (target_client == NULL)
          {
             cmd_infos.message.insert(1, "#");
-            broadcastToChannel(server, client_fd, it_client, it_channel, cmd_infos.message);
+            broadcastToChannel(server, client_fd, client, it_channel, cmd_infos.message);
          }
          else
-            addToClientBuffer(server, it_target->first, RPL_PRIVMSG(it_client->second.getNickname(), it_client->second.getUsername(), cmd_infos.message));    
+            addToClientBuffer(server, target_client->getClientFd(), RPL_PRIVMSG(client->getNickname(), client->getUsername(), cmd_infos.message));    
       }  
    }
 }
\ No newline at end of file
@@ -3,7 +3,6 @@
 #include "Server.hpp"
 #include "Commands.hpp"
 
-static void			broadcastToChan(Server *server, Channel &channel, int const client_fd, std::string nick, std::string user, std::string reason);
 
 /**
  * @brief The QUIT command is used to terminate a client’s connection to the server. 
@@ -23,43 +22,14 @@ static void			broadcastToChan(Server *server, Channel &channel, int const client
  * 
  * 	Source: https://modern.ircdocs.horse/#quit-message
  */
-void		quit(Server *server, int const client_fd, cmd_struct cmd_infos)
+void		quit(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
-	Client& 								  client   = retrieveClient(server, client_fd);
-	std::string								  reason   = getReason(cmd_infos.message);
-	std::map<std::string, Channel>&			  channels = server->getChannels();
-	std::map<std::string, Channel>::iterator  chan	   = channels.begin();
+	Client& 	client   = retrieveClient(server, client_fd);
+	std::string	reason   = getReason(cmd_infos.message);
 
-	for (; chan != channels.end(); chan++) // check all channels
-	{
-		std::map<std::string, Client>& 			chan_members = chan->second.getClientList();
-		std::map<std::string, Client>::iterator	member		 = chan_members.begin();
-		for (; member != chan_members.end(); member++) // check all chan_members
-		{
-			if (member->second.getClientFd() == client_fd) // erase user from the chan + inform the others 
-			{
-				chan_members.erase(client.getNickname());
-				broadcastToChan(server, chan->second, client_fd, client.getNickname(), client.getUsername(), reason);
-				break ;
-			}
-		}
-	}
+	// inform everyone sharing a channel (once each), then leave them all
+	addToCoMembersBuffer(server, client, makeSharedBuffer(RPL_QUIT(user_id(client.getNickname(), client.getUsername()), reason)));
+	server->removeClientFromAllChannels(client);
 	// close the connection (no need for irssi, but nc needs it)
 	client.setDeconnexionStatus(true);
 }
-
-static void	broadcastToChan(Server *server, Channel &channel, int const client_fd, std::string nick, std::string user, std::string reason)
-{
-	std::map<std::string, Client>::iterator member = channel.getClientList().begin();
-	
-	while (member != channel.getClientList().end())
-	{
-		if (member->second.getClientFd() != client_fd)
-		{
-			addToClientBuffer(server, member->second.getClientFd(), \
-				RPL_QUIT(user_id(nick, user), reason));
-		}
-			
-		member++;
-	}
-}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "Irc.hpp"
+#include "Server.hpp"
+#include "Commands.hpp"
+
+/* "STATS l", TASK_SLICE clients per slice, in fd order */
+class LinkInfoTask : public SlicedTask
+{
+	private:
+		size_t	_next_fd;	// first fd not reported
+
+	protected:
+		bool	runSlice(Server &server, Client &client);
+
+	public:
+		explicit LinkInfoTask(client_handle client);
+};
+
+static bool	isCongested(Client &client);
+
+struct klineReport
+{
+	Server		*server;
+	int			client_fd;
+	std::string	nickname;
+
+	void	operator()(ip_address const &prefix, unsigned prefix_len, std::string const &reason) const
+	{
+		addToClientBuffer(server, client_fd, RPL_STATSKLINE(nickname, cidrToString(prefix, prefix_len), reason));
+	}
+};
+
+struct classReport
+{
+	Server		*server;
+	int			client_fd;
+	std::string	nickname;
+
+	void	operator()(ip_address const &prefix, unsigned prefix_len, connection_class const &limits) const
+	{
+		addToClientBuffer(server, client_fd, RPL_STATSILINE(nickname, cidrToString(prefix, prefix_len), limits.max_per_address, limits.max_per_prefix));
+	}
+};
+
+/**
+ * @brief The STATS command queries statistics about the server. Reports are
+ * 		  restricted to IRC operators.
+ *
+ * 	Syntax :
+ * 	STATS <query>
+ *
+ * 	Queries:
+ * 		i	the connection classes, one RPL_STATSILINE (215) each, the
+ * 			default class as "*"
+ * 		k	the K-lines, one RPL_STATSKLINE (216) each
+ * 		l	the send queue of every client, one RPL_STATSLINKINFO (211)
+ * 			each: "<nick>[<host>] <queued> <high-water mark> <soft limit>
+ * 			<hard limit>", in bytes, then "<lines> <recent>": the lines of
+ * 			its timeline waiting to run, and how many of them arrived in
+ * 			the last second (a fresh burst, or a backlog). It runs in slices (see LinkInfoTask)
+ * 			and stops early once the replies waiting for the operator are
+ * 			past its soft sendq limit.
+ *
+ * 	Numeric replies:
+ * 		ERR_NEEDMOREPARAMS (461)
+ * 		ERR_NOPRIVILEGES (481)
+ * 		RPL_TRYAGAIN (263) : STATS l while the operator's sendq is already
+ * 			past its soft limit
+ * 		RPL_ENDOFSTATS (219), also sent for unknown queries
+ */
+void	stats(Server *server, int const client_fd, cmd_struct &cmd_infos)
+{
+	Client		&client		= retrieveClient(server, client_fd);
+	std::string	nickname	= client.getNickname();
+	std::string	query		= cmd_infos.tokens.params[0].str();
+
+	if (client.hasMode(UMODE_OPERATOR) == false)
+	{
+		addToClientBuffer(server, client_fd, ERR_NOPRIVILEGES(nickname));
+		return ;
+	}
+	if (query == "i" || query == "I")
+	{
+		classReport				report = { server, client_fd, nickname };
+		connection_class const	&limits = server->getSettings().default_class;
+
+		server->getClasses().forEach(report);
+		addToClientBuffer(server, client_fd, RPL_STATSILINE(nickname, std::string("*"), limits.max_per_address, limits.max_per_prefix));
+	}
+	else if (query == "k" || query == "K")
+	{
+		klineReport	report = { server, client_fd, nickname };
+
+		server->getKlines().forEach(report);
+	}
+	else if (query == "l" || query == "L")
+	{
+		if (isCongested(client))
+		{
+			addToClientBuffer(server, client_fd, RPL_TRYAGAIN(nickname, cmd_infos.name));
+			return ;
+		}
+		server->scheduleTask(client, new LinkInfoTask(server->getClients().getHandle(client_fd)));
+		return ;
+	}
+	addToClientBuffer(server, client_fd, RPL_ENDOFSTATS(nickname, query));
+}
+
+LinkInfoTask::LinkInfoTask(client_handle client) : SlicedTask(client), _next_fd(0)
+{
+}
+
+/**
+ * @brief Reports the next clients by fd: those that connect or leave in the
+ * 		  meantime are simply found or not.
+ */
+bool	LinkInfoTask::runSlice(Server &server, Client &client)
+{
+	ClientTable	&clients = server.getClients();
+	std::string	nickname = client.getNickname();
+	size_t		reported = 0;
+	uint64_t	last_second = server.getNow() - std::min<uint64_t>(server.getNow(), 1000);
+
+	for (; _next_fd < clients.capacity() && reported < TASK_SLICE; _next_fd++)
+	{
+		Client	*target = clients.find(_next_fd);
+
+		if (target == NULL)
+			continue ;
+		if (isCongested(client))
+		{
+			_next_fd = clients.capacity();
+			break ;
+		}
+
+		std::string	link = (target->getNickname().empty() ? "*" : target->getNickname()) + "[" + target->getHostname() + "]";
+		size_t		sendq;
+		size_t		peak;
+		InputTimeline::cursor	recent = target->getTimeline().since(last_second);
+
+		{
+			std::lock_guard<std::mutex>	guard(target->getSendqLock()); // its shard may be writing it
+
+			sendq = target->getSendqSize();
+			peak = target->getSendqPeak();
+		}
+		addToClientBuffer(&server, client.getClientFd(), RPL_STATSLINKINFO(nickname, link, sendq,
+			peak, target->getSendqSoft(), target->getSendqHard(), target->getTimeline().size(), recent.remaining()));
+		reported++;
+	}
+	if (_next_fd < clients.capacity())
+		return (false);
+	addToClientBuffer(&server, client.getClientFd(), RPL_ENDOFSTATS(nickname, std::string("l")));
+	return (true);
+}
+
+/**
+ * @brief The shard of the client may be writing its send queue meanwhile.
+ */
+static bool	isCongested(Client &client)
+{
+	std::lock_guard<std::mutex>	guard(client.getSendqLock());
+
+	return (client.isSendqCongested());
+}
@@ -34,7 +34,7 @@ static void	broadcastToChannel(Server *server, Channel &channel, Client &client,
  * 	[SERVER] ; Checking the topic for "#test"
  * 
  */
-void	topic(Server *server, int const client_fd, cmd_struct cmd_infos)
+void	topic(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
 	std::string channel_name;
 	std::string	topic;
@@ -56,7 +56,7 @@ void	topic(Server *server, int const client_fd, cmd_struct cmd_infos)
 		addToClientBuffer(server, client_fd, ERR_NOSUCHCHANNEL(client_nickname, channel_name));
 		return ;
 	}
-	if (channel->second.doesClientExist(client_nickname) == false)
+	if (channel->second.doesClientExist(client_fd) == false)
 	{
 		addToClientBuffer(server, client_fd, ERR_NOTONCHANNEL(client_nickname, channel_name));
 		return ;
@@ -73,8 +73,8 @@ void	topic(Server *server, int const client_fd, cmd_struct cmd_infos)
 	}
 	else
 	{
-		if (channel->second.getMode().find('t') != std::string::npos \
-			&& channel->second.isOperator(client_nickname) == false)
+		if (channel->second.hasMode(CMODE_TOPIC) \
+			&& channel->second.isOperator(client_fd) == false)
 			addToClientBuffer(server, client_fd, ERR_CHANOPRIVSNEEDED(client_nickname, channel_name));
 		else
 		{
@@ -103,9 +103,11 @@ std::string	findChannelName(std::string msg_to_parse)
 		return (channel_name);
 	else if (msg_to_parse.find(":") != msg_to_parse.npos)
 	{
-		char *str = const_cast<char *>(msg_to_parse.data());
-		channel_name = strtok(str, " ");
-		channel_name.erase(channel_name.find("#"), 1);
+		size_t	begin = msg_to_parse.find_first_not_of(' ');
+
+		channel_name = msg_to_parse.substr(begin, msg_to_parse.find(' ', begin) - begin);
+		if (channel_name.find("#") != channel_name.npos)
+			channel_name.erase(channel_name.find("#"), 1);
 	}
 	else
 	{
@@ -134,12 +136,13 @@ std::string	findTopic(std::string msg_to_parse)
 
 static void	broadcastToChannel(Server *server, Channel &channel, Client &client, std::string channel_name, std::string topic)
 {
-	std::map<std::string, Client>::iterator member = channel.getClientList().begin();
+	member_list::iterator member = channel.getMembers().begin();
 	std::string								client_nickname = client.getNickname();
+	shared_buffer							reply = makeSharedBuffer(RPL_TOPIC(client_nickname, channel_name, topic));
 	
-	while (member != channel.getClientList().end())
+	while (member != channel.getMembers().end())
 	{
-		addToClientBuffer(server, member->second.getClientFd(), RPL_TOPIC(client_nickname, channel_name, topic));
+		addToClientBuffer(server, member->first, reply);
 		member++;
 	}
 }
\ No newline at end of file
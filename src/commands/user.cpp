@@ -30,7 +30,7 @@ std::string	findRealname(std::string msg);
  *  [Client] USER msanjuan msanjuan localhost :Marine SANJUAN
  *  => Username is msanjuan, Realname is Marine Sanjuan
  */
-void	user(Server *server, int const client_fd, cmd_struct cmd_infos)
+void	user(Server *server, int const client_fd, cmd_struct &cmd_infos)
 {
 	// Parse the command line
 	Client&		client		= retrieveClient(server, client_fd);
@@ -0,0 +1,95 @@
+#include "Irc.hpp"
+#include "Commands.hpp"
+#include <stdint.h>
+
+/*
+ * Command names are at most 8 characters long, so each one packs into a
+ * uint64_t (one byte per character). The same packing done by a constexpr
+ * function gives the case labels below, and the compiler turns the switch
+ * into a jump table or a few comparisons: no string is built or compared.
+ *
+ * A name that does not fit, or that holds a '\0' (which would pack like the
+ * shorter name before it, "NICK\0X" like "NICK"), packs to 0: no command has
+ * that key, so it is unknown.
+ */
+static constexpr uint64_t	packCommand(const char *name, size_t i = 0)
+{
+	return ((i == 8 || name[i] == '\0') ? 0
+		: (static_cast<uint64_t>(static_cast<unsigned char>(name[i])) << (8 * i)) | packCommand(name, i + 1));
+}
+
+static uint64_t	packCommand(str_view name)
+{
+	uint64_t	key = 0;
+
+	if (name.size > 8)
+		return (0);
+	for (size_t i = 0; i < name.size; i++)
+	{
+		if (name.data[i] == '\0')
+			return (0);
+		key |= static_cast<uint64_t>(static_cast<unsigned char>(name.data[i])) << (8 * i);
+	}
+	return (key);
+}
+
+# define COMMAND(name, handler, min_params, flags, cost) \
+	case packCommand(name): \
+	{ \
+		static const command_spec spec = { name, handler, min_params, flags, cost }; \
+		return (&spec); \
+	}
+
+/**
+ * @brief Finds the handler and metadata of a command in O(1), without any
+ * 		  allocation.
+ *
+ * @param name Upper-cased command name
+ * @return const command_spec* NULL if the command is unknown
+ */
+const command_spec	*findCommand(str_view name)
+{
+	switch (packCommand(name))
+	{
+		//		name		handler			params	flags						cost
+		COMMAND("GLINE",	kline,			1,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("INVITE",	invite,			2,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("JOIN",		join,			1,		CMD_NEEDS_REGISTRATION,		2)
+		COMMAND("KICK",		kick,			2,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("KILL",		kill,			1,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("KLINE",	kline,			1,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("LIST",		list,			0,		CMD_NEEDS_REGISTRATION,		3)
+		COMMAND("MODE",		modeFunction,	1,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("NAMES",	names,			0,		CMD_NEEDS_REGISTRATION,		2)
+		COMMAND("NICK",		nick,			0,		0,							2)
+		COMMAND("NOTICE",	notice,			0,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("OPER",		oper,			2,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("PART",		part,			1,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("PASS",		pass,			1,		CMD_BEFORE_REGISTRATION,	1)
+		COMMAND("PING",		ping,			1,		0,							1)
+		COMMAND("PONG",		pong,			0,		0,							1)
+		COMMAND("PRIVMSG",	privmsg,		0,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("QUIT",		quit,			0,		0,							1)
+		COMMAND("STATS",	stats,			1,		CMD_NEEDS_REGISTRATION,		2)
+		COMMAND("TOPIC",	topic,			1,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("UNKLINE",	unkline,		1,		CMD_NEEDS_REGISTRATION,		1)
+		COMMAND("USER",		user,			4,		0,							1)
+		default:
+			return (NULL);
+	}
+}
+
+/**
+ * @brief Same as findCommand for a command name as the client sent it, in
+ * 		  any case.
+ */
+const command_spec	*lookupCommand(str_view command)
+{
+	char	name[8];
+
+	if (command.size > sizeof(name))
+		return (NULL);
+	for (size_t i = 0; i < command.size; i++)
+		name[i] = std::toupper(static_cast<unsigned char>(command.data[i]));
+	return (findCommand(str_view(name, command.size)));
+}
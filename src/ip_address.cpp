@@ -0,0 +1,137 @@
+#include "IpAddress.hpp"
+#include <cstdlib>
+
+static const unsigned char	v4_mapped[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+
+bool	ip_address::isV4() const
+{
+	return (memcmp(bytes, v4_mapped, sizeof(v4_mapped)) == 0);
+}
+
+/* Bit index, from the most significant bit of the first byte */
+bool	ip_address::bit(unsigned index) const
+{
+	return ((bytes[index / 8] >> (7 - index % 8)) & 1);
+}
+
+bool	ip_address::operator==(ip_address const &other) const
+{
+	return (memcmp(bytes, other.bytes, sizeof(bytes)) == 0);
+}
+
+/* FNV-1a over the 16 bytes */
+size_t	ip_address_hash::operator()(ip_address const &ip) const
+{
+	size_t	hash = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < sizeof(ip.bytes); i++)
+		hash = (hash ^ ip.bytes[i]) * 1099511628211ULL;
+	return (hash);
+}
+
+/**
+ * @brief Clears the bits of ip past the first prefix_len ones.
+ */
+void	maskAddress(ip_address &ip, unsigned prefix_len)
+{
+	for (unsigned i = prefix_len; i < IP_ADDRESS_BITS; i++)
+		ip.bytes[i / 8] &= ~(1 << (7 - i % 8));
+}
+
+static void	setV4(ip_address &ip, struct in_addr const &addr)
+{
+	memcpy(ip.bytes, v4_mapped, sizeof(v4_mapped));
+	memcpy(ip.bytes + sizeof(v4_mapped), &addr, 4);
+}
+
+/**
+ * @brief Converts the address filled by accept() or getpeername().
+ *
+ * @return false for families other than AF_INET and AF_INET6
+ */
+bool	sockaddrToAddress(struct sockaddr const *addr, ip_address &ip)
+{
+	if (addr->sa_family == AF_INET)
+		setV4(ip, reinterpret_cast<sockaddr_in const *>(addr)->sin_addr);
+	else if (addr->sa_family == AF_INET6)
+		memcpy(ip.bytes, &reinterpret_cast<sockaddr_in6 const *>(addr)->sin6_addr, 16);
+	else
+		return (false);
+	return (true);
+}
+
+/**
+ * @brief accept() keeping the peer address, so that admitting the client
+ * 		  does not need another system call to look it up.
+ */
+int		acceptSocket(int listen_socket, ip_address &address)
+{
+	sockaddr_storage	client;
+	socklen_t			addr_size = sizeof(client);
+	int					client_sock = accept(listen_socket, (sockaddr *)&client, &addr_size);
+
+	if (client_sock != FAILURE && sockaddrToAddress((sockaddr *)&client, address) == false)
+		memset(address.bytes, 0, sizeof(address.bytes));
+	return (client_sock);
+}
+
+/**
+ * @brief Parses "a.b.c.d", "a.b.c.d/len", "x::y" or "x::y/len". The bits of
+ * 		  the address past the prefix are cleared.
+ *
+ * @param prefix_len Set in the 128-bit space (an IPv4 /24 gives 120)
+ * @return false if the address or the length is invalid
+ */
+bool	parseCidr(std::string const &cidr, ip_address &ip, unsigned &prefix_len)
+{
+	size_t			slash = cidr.find('/');
+	std::string		address = cidr.substr(0, slash);
+	unsigned		max_len;
+	struct in_addr	v4;
+
+	if (inet_pton(AF_INET, address.c_str(), &v4) == 1)
+	{
+		setV4(ip, v4);
+		max_len = 32;
+	}
+	else if (inet_pton(AF_INET6, address.c_str(), ip.bytes) == 1)
+		max_len = IP_ADDRESS_BITS;
+	else
+		return (false);
+
+	prefix_len = max_len;
+	if (slash != std::string::npos)
+	{
+		std::string	len = cidr.substr(slash + 1);
+		char		*end = NULL;
+
+		if (len.empty())
+			return (false);
+		prefix_len = strtoul(len.c_str(), &end, 10);
+		if (*end != '\0' || prefix_len > max_len)
+			return (false);
+	}
+	if (max_len == 32)
+		prefix_len += IPV4_MAPPED_PREFIX;
+	maskAddress(ip, prefix_len);
+	return (true);
+}
+
+std::string	addressToString(ip_address const &ip)
+{
+	char	str[INET6_ADDRSTRLEN];
+
+	if (ip.isV4())
+		inet_ntop(AF_INET, ip.bytes + sizeof(v4_mapped), str, sizeof(str));
+	else
+		inet_ntop(AF_INET6, ip.bytes, str, sizeof(str));
+	return (str);
+}
+
+std::string	cidrToString(ip_address const &ip, unsigned prefix_len)
+{
+	std::ostringstream	str;
+
+	str << addressToString(ip) << "/" << (ip.isV4() ? prefix_len - IPV4_MAPPED_PREFIX : prefix_len);
+	return (str.str());
+}
@@ -23,11 +23,13 @@ int main (int argc, char **argv)
 
 		char filename[39] = "srcs/config/ManageServOperators.config";
 		server.readFromConfigFile(filename);
+		server.readSettingsFile(SETTINGS_FILE);
 		
 		// The three following functions calls are just set up
 		server.setHints();
 		server.fillServinfo(argv[1]);
-		server.launchServer();
+		if (server.launchServer() == FAILURE)
+			return (FAILURE);
 		// Below, the main loop for server/client connection
 		try
 		{
@@ -0,0 +1,113 @@
+#include "Modes.hpp"
+
+/*
+ * Every mode letter the server knows, in the order they are rendered.
+ * Checking a mode on the message path is a single bit test on the mode_set;
+ * the letters only come back when a mode string has to be sent.
+ */
+static const mode_spec	channel_modes[] =
+{
+	{ 'b',	MODE_TYPE_A,	0 },
+	{ 'k',	MODE_TYPE_B,	CMODE_KEY },
+	{ 'o',	MODE_TYPE_B,	0 },
+	{ 'p',	MODE_TYPE_D,	CMODE_PRIVATE },
+	{ 's',	MODE_TYPE_D,	CMODE_SECRET },
+	{ 't',	MODE_TYPE_D,	CMODE_TOPIC },
+};
+
+static const mode_spec	user_modes[] =
+{
+	{ 'i',	MODE_TYPE_D,	UMODE_INVISIBLE },
+	{ 'o',	MODE_TYPE_D,	UMODE_OPERATOR },
+};
+
+static const mode_spec	*findMode(mode_spec const *table, size_t size, char letter)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		if (table[i].letter == letter)
+			return (&table[i]);
+	}
+	return (NULL);
+}
+
+static std::string	modeString(mode_spec const *table, size_t size, mode_set modes)
+{
+	std::string	str;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		if (table[i].bit != 0 && (modes & table[i].bit))
+			str += table[i].letter;
+	}
+	if (str.empty() == false)
+		str.insert(0, "+");
+	return (str);
+}
+
+static std::string	modeLetters(mode_spec const *table, size_t size, bool param_only)
+{
+	std::string	str;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		if (param_only == false || modeTakesParam(table[i], true))
+			str += table[i].letter;
+	}
+	return (str);
+}
+
+const mode_spec	*findChannelMode(char letter)
+{
+	return (findMode(channel_modes, sizeof(channel_modes) / sizeof(*channel_modes), letter));
+}
+
+const mode_spec	*findUserMode(char letter)
+{
+	return (findMode(user_modes, sizeof(user_modes) / sizeof(*user_modes), letter));
+}
+
+/**
+ * @brief Whether "+<letter>" (adding) or "-<letter>" consumes a parameter.
+ */
+bool			modeTakesParam(mode_spec const &spec, bool adding)
+{
+	if (spec.type == MODE_TYPE_A || spec.type == MODE_TYPE_B)
+		return (true);
+	if (spec.type == MODE_TYPE_C)
+		return (adding);
+	return (false);
+}
+
+/**
+ * @brief Renders the modes for RPL_CHANNELMODEIS, e.g. "+kt" (empty if none).
+ */
+std::string		channelModeString(mode_set modes)
+{
+	return (modeString(channel_modes, sizeof(channel_modes) / sizeof(*channel_modes), modes));
+}
+
+/**
+ * @brief Renders the modes for RPL_UMODEIS, e.g. "+i" (empty if none).
+ */
+std::string		userModeString(mode_set modes)
+{
+	return (modeString(user_modes, sizeof(user_modes) / sizeof(*user_modes), modes));
+}
+
+/**
+ * @brief Channel modes the server knows, for RPL_MYINFO: all of them, or
+ * 		  only those taking a parameter.
+ */
+std::string		channelModeLetters(bool param_only)
+{
+	return (modeLetters(channel_modes, sizeof(channel_modes) / sizeof(*channel_modes), param_only));
+}
+
+/**
+ * @brief User modes the server knows, for RPL_MYINFO.
+ */
+std::string		userModeLetters()
+{
+	return (modeLetters(user_modes, sizeof(user_modes) / sizeof(*user_modes), false));
+}
@@ -1,29 +1,143 @@
 #include "Irc.hpp"
 #include "Commands.hpp"
 
-int	parseCommand(std::string cmd_line, cmd_struct &cmd_infos)
+static const char	*skipSpaces(const char *p, const char *end)
 {
-	// COMMAND
-	std::string copy = cmd_line;
-	if (cmd_line[0] == ':')
-		copy.erase(0, copy.find_first_of(' '));
-	cmd_infos.name.insert(0, copy, 0, copy.find_first_of(' '));
-	
+	while (p < end && *p == ' ')
+		p++;
+	return (p);
+}
+
+static str_view	nextWord(const char *&p, const char *end)
+{
+	const char *begin = p;
+
+	while (p < end && *p != ' ')
+		p++;
+	return (str_view(begin, p - begin));
+}
+
+/**
+ * @brief Splits a line (without its "\r\n") into its components in a single
+ * 		  pass. Nothing is copied: every field of msg points into line.
+ *
+ * 	Grammar: [@<tags> ] [:<prefix> ] <command> [<param> ...] [:<trailing>]
+ * 	The trailing parameter (or the 15th one, which may hold spaces without a
+ * 	leading ':') is stored as the last entry of params.
+ *
+ * @return int FAILURE if the line holds no command, SUCCESS otherwise
+ */
+int	tokenizeMessage(str_view line, irc_message &msg)
+{
+	const char	*p = line.data;
+	const char	*end = line.data + line.size;
+
+	msg.tags = str_view();
+	msg.prefix = str_view();
+	msg.param_count = 0;
+	msg.has_trailing = false;
+
+	// TAGS
+	if (p < end && *p == '@')
+	{
+		p++;
+		msg.tags = nextWord(p, end);
+		p = skipSpaces(p, end);
+	}
 	// PREFIX
-	size_t prefix_length = cmd_line.find(cmd_infos.name, 0);
-	cmd_infos.prefix.assign(cmd_line, 0, prefix_length);
-	
-	// MESSAGE
-	size_t msg_beginning = cmd_line.find(cmd_infos.name, 0) + cmd_infos.name.length();
-	cmd_infos.message = cmd_line.substr(msg_beginning, std::string::npos);
-	cmd_infos.message.erase(cmd_infos.message.find("\r"), 1);
+	if (p < end && *p == ':')
+	{
+		p++;
+		msg.prefix = nextWord(p, end);
+		p = skipSpaces(p, end);
+	}
+	// COMMAND
+	msg.command = nextWord(p, end);
+	if (msg.command.empty())
+		return (FAILURE);
+	// PARAMS
+	while ((p = skipSpaces(p, end)) < end)
+	{
+		if (*p == ':' || msg.param_count == MSG_MAX_PARAMS - 1)
+		{
+			if (*p == ':')
+				p++;
+			msg.params[msg.param_count++] = str_view(p, end - p);
+			msg.has_trailing = true;
+			break ;
+		}
+		msg.params[msg.param_count++] = nextWord(p, end);
+	}
+	return (SUCCESS);
+}
+
+static void	packField(str_view line, str_view field, uint16_t *packed)
+{
+	packed[0] = (field.data == NULL ? 0 : field.data - line.data);
+	packed[1] = field.size;
+}
 
+/**
+ * @brief Stores msg, split out of line, as offsets: a quarter of the size,
+ * 		  and still right for a copy of line (see InputTimeline).
+ * 		  Lines are shorter than MSG_MAX_TAGGED_LEN, offsets fit in 16 bits.
+ */
+void	packMessage(str_view line, irc_message const &msg, packed_message &packed)
+{
+	packField(line, msg.tags, packed.fields[0]);
+	packField(line, msg.prefix, packed.fields[1]);
+	packField(line, msg.command, packed.fields[2]);
+	for (size_t i = 0; i < msg.param_count; i++)
+		packField(line, msg.params[i], packed.fields[3 + i]);
+	packed.param_count = msg.param_count;
+	packed.has_trailing = msg.has_trailing;
+}
+
+/**
+ * @brief Gives back the irc_message packMessage() stored, pointing into line.
+ */
+void	unpackMessage(str_view line, packed_message const &packed, irc_message &msg)
+{
+	msg.tags = str_view(line.data + packed.fields[0][0], packed.fields[0][1]);
+	msg.prefix = str_view(line.data + packed.fields[1][0], packed.fields[1][1]);
+	msg.command = str_view(line.data + packed.fields[2][0], packed.fields[2][1]);
+	for (size_t i = 0; i < packed.param_count; i++)
+		msg.params[i] = str_view(line.data + packed.fields[3 + i][0], packed.fields[3 + i][1]);
+	msg.param_count = packed.param_count;
+	msg.has_trailing = packed.has_trailing;
+}
+
+/**
+ * @brief Fills cmd_infos from a line: the tokens, then the rest (see
+ * 		  fillCommand).
+ */
+int	parseCommand(str_view cmd_line, cmd_struct &cmd_infos)
+{
+	if (tokenizeMessage(cmd_line, cmd_infos.tokens) == FAILURE)
+		return (FAILURE);
+	fillCommand(cmd_line, cmd_infos);
+	return (SUCCESS);
+}
+
+/**
+ * @brief Fills the upper-cased command name, the prefix, and in message
+ * 		  everything after the command name, for the handlers which still
+ * 		  read their arguments from it, out of tokens already split from
+ * 		  cmd_line (e.g. by the thread that framed it, see InputTimeline).
+ */
+void	fillCommand(str_view cmd_line, cmd_struct &cmd_infos)
+{
+	irc_message	&tokens = cmd_infos.tokens;
+	const char	*args = tokens.command.data + tokens.command.size;
+
+	cmd_infos.prefix.assign(tokens.prefix.data, tokens.prefix.size);
+	cmd_infos.name.assign(tokens.command.data, tokens.command.size);
+	cmd_infos.message.assign(args, cmd_line.data + cmd_line.size - args);
 	for (size_t i = 0; i < cmd_infos.name.size(); i++)
 		cmd_infos.name[i] = std::toupper(cmd_infos.name[i]);
-	
+
 	// DEBUG
 	// std::cout << "Command : " << RED << cmd_infos.name << RESET << std::endl;
 	// std::cout << "Prefix : " << BLUE << cmd_infos.prefix << RESET << std::endl;
 	// std::cout << "Message : " << GREEN << cmd_infos.message << RESET << std::endl;
-	return (SUCCESS);
-}
\ No newline at end of file
+}
@@ -1,20 +1,80 @@
 #include "Irc.hpp"
 #include "Server.hpp"
 #include "Commands.hpp"
+#include <algorithm>
 
 void	addToClientBuffer(Server *server, int const client_fd, std::string reply)
+{
+	addToClientBuffer(server, client_fd, makeSharedBuffer(reply));
+}
+
+/**
+ * @brief Queues an already serialized reply by reference. Broadcasts build
+ * 		  their line once with makeSharedBuffer() and hand the same buffer to
+ * 		  every recipient instead of copying it into each send queue.
+ * 		  A client whose queue goes past its hard limit gets nothing more
+ * 		  (see Server::sendqExceeded).
+ */
+void	addToClientBuffer(Server *server, int const client_fd, shared_buffer const &reply)
 {
 	Client &client = retrieveClient(server, client_fd);
 
-	client.setSendBuffer(reply);
+	bool	exceeded;
+
+	if (client.isSendqExceeded()) // about to be disconnected
+		return ;
+	{
+		std::lock_guard<std::mutex>	guard(client.getSendqLock()); // its shard may be writing it
+
+		client.setSendBuffer(reply);
+		exceeded = (client.getSendqSize() > client.getSendqHard());
+	}
+	if (ChannelWorker::current() != NULL) // the reactor and the slow clients are the core's
+		return (ChannelWorker::current()->deferWrite(client));
+	if (exceeded)
+		return (server->sendqExceeded(client));
+	server->updateWriteInterest(client);
+}
+
+/**
+ * @brief Queues reply once for each client sharing at least one channel with
+ * 		  client (not client itself), however many channels they share.
+ * 		  Only the client's own channels are visited, through its reverse list.
+ */
+void	addToCoMembersBuffer(Server *server, Client &client, shared_buffer const &reply)
+{
+	std::map<std::string, Channel>&		channels	= server->getChannels();
+	std::set<std::string>&				joined		= client.getJoinedChannels();
+	std::vector<int>					recipients;
+
+	for (std::set<std::string>::iterator name = joined.begin(); name != joined.end(); name++)
+	{
+		std::map<std::string, Channel>::iterator chan = channels.find(*name);
+		if (chan == channels.end())
+			continue ;
+		member_list &members = chan->second.getMembers();
+		for (member_list::iterator member = members.begin(); member != members.end(); member++)
+		{
+			if (member->first != client.getClientFd())
+				recipients.push_back(member->first);
+		}
+	}
+	std::sort(recipients.begin(), recipients.end());
+	recipients.erase(std::unique(recipients.begin(), recipients.end()), recipients.end());
+	for (size_t i = 0; i < recipients.size(); i++)
+		addToClientBuffer(server, recipients[i], reply);
 }
 
-void	sendServerRpl(int const client_fd, std::string client_buffer)
+shared_buffer	makeSharedBuffer(std::string const &reply)
+{
+	return (std::make_shared<const std::string>(reply));
+}
+
+void	logServerRpl(int const client_fd, std::string const &client_buffer)
 {
 	std::istringstream	buf(client_buffer);
 	std::string			reply;
-	
-	send(client_fd, client_buffer.c_str(), client_buffer.size(), 0);
+
 	while (getline(buf, reply))
 	{
 		std::cout << std::endl << "[Server] Message sent to client " \
@@ -24,41 +84,34 @@ void	sendServerRpl(int const client_fd, std::string client_buffer)
 
 Client&	retrieveClient(Server *server, int const client_fd)
 {
-	std::map<const int, Client>&		client_list = server->getClients();
-	std::map<const int, Client>::iterator it_client = client_list.find(client_fd);
-	
-	Client &client = it_client->second;
-	return (client);
+	return (*server->getClients().find(client_fd));
 }
 
 Client*	getClient(Server *server, int const client_fd)
 {
-	std::map<const int, Client>&		client_list = server->getClients();
-	std::map<const int, Client>::iterator it_client = client_list.find(client_fd);
-	
-	if (it_client == client_list.end())
-		return (NULL);
-	return (&it_client->second);
+	return (server->getClients().find(client_fd));
 }
 
-std::string	getListOfMembers(std::string client, Channel &channel)
+std::string	getListOfMembers(Server *server, Client &client, Channel &channel)
 {
-	std::map<std::string, Client>&			client_list	= channel.getClientList();
-	std::map<std::string, Client>::iterator	it;
-	std::string								nick;
-	std::string								members_list;
+	member_list&			members	= channel.getMembers();
+	member_list::iterator	it;
+	std::string				members_list;
+	bool					is_member = channel.doesClientExist(client.getClientFd());
 
-	for (it = client_list.begin(); it != client_list.end(); it++)
+	for (it = members.begin(); it != members.end(); it++)
 	{
-		nick.clear();
-		nick = it->second.getNickname();
-		if (it->second.getMode().find('i') != std::string::npos\
-			&& channel.doesClientExist(client) == false)
+		Client *member = server->getClients().find(it->second.handle);
+
+		if (member == NULL)
+			continue;
+		if (member->hasMode(UMODE_INVISIBLE)\
+			&& is_member == false)
 				continue;
 			
-		if (channel.isOperator(nick) == true)
+		if (it->second.flags & MEMBER_OPERATOR)
 			members_list += "@";
-		members_list += nick;
+		members_list += member->getNickname();
 		members_list += " ";
 	}
 	if (members_list.size() >= 1 && members_list[members_list.size() - 1] == ' ')
@@ -81,9 +134,9 @@ std::string	getSymbol(Channel &channel)
  {
  	std::string symbol;
  
- 	if (channel.getMode().find('s') != std::string::npos) {
+ 	if (channel.hasMode(CMODE_SECRET)) {
  		symbol += "@";
- 	} else if (channel.getMode().find('p') != std::string::npos) {
+ 	} else if (channel.hasMode(CMODE_PRIVATE)) {
  		symbol += "*";
  	} else {
  		symbol += "=";